@@ -10,7 +10,12 @@
 #define APPLICATION_HPP
 
 #include "System.hpp"
+#include "AudioRing.hpp"
+#include "RateControl.hpp"
 #include "Window/Window.hpp"
+#include "Audio/AudioSink.hpp"
+#include <atomic>
+#include <thread>
 
 //========//
 // Application
@@ -22,18 +27,37 @@ class Application
 {
     public:
 
-        Application(void) : mRunning(true) {}
-        ~Application(void)                 {if (mMainWindow) {delete mMainWindow;}}
+        enum
+        {
+            FRAME_PERIOD_NS    = 16639267,  // One NTSC frame, 1 / 60.0988 seconds.
+            SPIN_NS            = 1000000,   // Last stretch of a frame waited out by yielding, sleeps overshoot.
+            PIPELINE_MIN_CORES = 4,         // Cores needed to give drawing a thread of its own, besides emulation and presenting.
+            MAX_RENDER_THREADS = 4,         // Most threads a frame is drawn across, past that waking them costs more than it saves.
+            AUDIO_SAMPLE_RATE  = 48000,
+            AUDIO_RING_MS      = 100,       // Audio the ring can hold between emulation and the sink.
+            AUDIO_TARGET_MS    = 50,        // Audio kept in the ring, the latency traded for never running dry.
+            AUDIO_CHUNK        = 1024       // Samples moved from the apu to the ring at a time.
+        };
+
+        Application(void) : mMainWindow(nullptr), mAudioSink(nullptr), mRunning(true) {}
+        ~Application(void)                 {if (mMainWindow) {delete mMainWindow;} if (mAudioSink) {delete mAudioSink;}}
 
         void Start(const char * lFilename);
 
     protected:
 
         void Loop(void);
-
-        Window * mMainWindow;
-        System   mNes;
-        bool     mRunning;
+        void EmulationLoop(void);
+        void OpenAudio(void);
+        void PushAudio(void);
+
+        Window *          mMainWindow;
+        System            mNes;
+        AudioRing         mAudioRing;           // Samples on their way from the emulation thread to the sink's.
+        AudioSink *       mAudioSink;
+        RateControl       mRateControl;         // Keeps the ring near AUDIO_TARGET_MS as the sink's clock drifts.
+        std::atomic<bool> mRunning;
+        std::thread       mEmulationThread;     // Runs mNes, the main thread only presents frames.
 };
 
 #endif
@@ -0,0 +1,269 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// Apu2A03.hpp
+//
+// Contains classes to emulate the sound hardware of the 2A03.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef APU_2A03_HPP
+#define APU_2A03_HPP
+
+#include "Common.hpp"
+#include "BlipBuffer.hpp"
+#include "Resampler.hpp"
+
+class ExpansionAudio;
+
+//========//
+// Apu2A03
+//
+// The audio processing unit. Two pulse channels, a triangle, noise, the delta modulation
+// channel and the frame counter that clocks their envelopes, sweeps and length counters.
+//
+// Nothing here is clocked per cpu cycle. The apu keeps the cpu cycle it has run up to and
+// catches up whenever a register is touched, at the end of a frame, or when the system
+// reaches the next event it asked for (a frame counter step or a DMC fetch, which is where
+// IRQs come from). Catching up jumps from one channel timer tick to the next, and only a
+// change in the mixed output is handed to the blip buffer. A channel that can't make a
+// sound jumps straight over its ticks.
+//
+// The blip buffer makes samples at a fixed rate a little above what's audible, and at the
+// end of each frame the resampler takes the frame's worth to the output rate in one go.
+// A sound chip on the cartridge is run along with the channels and adds its changes to
+// the same blip buffer, see ExpansionAudio.
+//========//
+//
+class Apu2A03 : public Device
+{
+    public:
+
+        // Registers, as offsets from $4000.
+        enum ApuRegisters
+        {
+            PULSE_1_CONTROL     = 0x00,
+            PULSE_1_SWEEP       = 0x01,
+            PULSE_1_TIMER_LOW   = 0x02,
+            PULSE_1_TIMER_HIGH  = 0x03,
+            PULSE_2_CONTROL     = 0x04,
+            PULSE_2_SWEEP       = 0x05,
+            PULSE_2_TIMER_LOW   = 0x06,
+            PULSE_2_TIMER_HIGH  = 0x07,
+            TRIANGLE_CONTROL    = 0x08,
+            TRIANGLE_TIMER_LOW  = 0x0A,
+            TRIANGLE_TIMER_HIGH = 0x0B,
+            NOISE_CONTROL       = 0x0C,
+            NOISE_PERIOD        = 0x0E,
+            NOISE_LENGTH        = 0x0F,
+            DMC_CONTROL         = 0x10,
+            DMC_LOAD            = 0x11,
+            DMC_ADDRESS         = 0x12,
+            DMC_LENGTH          = 0x13,
+            STATUS              = 0x15,
+            FRAME_COUNTER       = 0x17
+        };
+
+        // STATUS, reading and writing.
+        enum StatusBits
+        {
+            PULSE_1_ON      = Bit(0),
+            PULSE_2_ON      = Bit(1),
+            TRIANGLE_ON     = Bit(2),
+            NOISE_ON        = Bit(3),
+            DMC_ON          = Bit(4),
+            FRAME_IRQ       = Bit(6),
+            DMC_IRQ         = Bit(7)
+        };
+
+        // FRAME_COUNTER.
+        enum FrameCounterBits
+        {
+            IRQ_INHIBIT     = Bit(6),
+            FIVE_STEP_MODE  = Bit(7)
+        };
+
+        enum
+        {
+            CPU_CLOCK_RATE       = 1789773,  // NTSC.
+            DEFAULT_SAMPLE_RATE  = 48000,
+            INTERNAL_SAMPLE_RATE = 64000,    // Rate the blip buffer makes samples at.
+            MAX_BUFFERED_MS      = 250,      // Audio kept around when nothing reads it.
+            DMC_STALL_CYCLES     = 4,        // Cpu cycles a DMC sample fetch takes off the cpu.
+            OUTPUT_SCALE         = 30000     // Full scale of the mixer, in samples.
+        };
+
+        Apu2A03(void);
+        virtual ~Apu2A03(void);
+
+        virtual DataType Read(AddressType lAddress) override;
+        virtual void     Write(AddressType lAddress, DataType lData)        override;
+
+        void             Reset(void);
+        void             Sync(void);
+        uint64_t         GetNextEvent(void)                 {return mNextEvent;}
+        void             EndFrame(void);
+        bool             SetSampleRate(int lSampleRate, Resampler::Quality lQuality = Resampler::QUALITY_NORMAL);
+        int              GetSampleRate(void)                {return mSampleRate;}
+        void             SetRateAdjust(double lAdjust)      {mResampler.SetRatioAdjust(lAdjust);}
+        void             SetExpansion(ExpansionAudio * lExpansion);
+        void             AddExpansionDelta(uint64_t lTime, int32_t lDelta);
+        int              GetSamplesAvailable(void)          {return mSampleCount;}
+        int              ReadSamples(int16_t * lOut, int lCount);
+
+    protected:
+
+        // Volume of the pulse and noise channels, either constant or decaying.
+        struct Envelope
+        {
+            bool    mStart;
+            bool    mLoop;          // Also halts the length counter.
+            bool    mConstant;
+            uint8_t mVolume;        // Constant volume, or the decay period.
+            uint8_t mDivider;
+            uint8_t mDecay;
+
+            void    Write(uint8_t lData);
+            void    Clock(void);
+            uint8_t GetVolume(void) {return mConstant ? mVolume : mDecay;}
+        };
+
+        struct Pulse
+        {
+            Envelope mEnvelope;
+            uint8_t  mDuty;
+            uint8_t  mStep;         // Position in the 8 step duty cycle.
+            uint16_t mTimer;        // Period, in apu cycles less 1.
+            uint8_t  mLength;
+            bool     mEnabled;
+            bool     mSweepEnabled;
+            bool     mSweepNegate;
+            bool     mSweepReload;
+            uint8_t  mSweepPeriod;
+            uint8_t  mSweepShift;
+            uint8_t  mSweepDivider;
+            uint8_t  mOnesComplement;   // Pulse 1 negates with one's complement, so its target is 1 lower.
+            uint64_t mNext;         // Cpu cycle of the next timer tick.
+
+            void     Write(uint8_t lRegister, uint8_t lData);
+            void     Clock(void);
+            void     ClockSweep(void);
+            uint16_t GetSweepTarget(void);
+            bool     IsSilent(void);
+            uint8_t  GetOutput(void);
+            uint32_t GetPeriod(void)    {return (mTimer + 1) * 2;}
+        };
+
+        struct Triangle
+        {
+            bool     mControl;      // Also halts the length counter.
+            uint8_t  mLinearLoad;
+            uint8_t  mLinear;
+            bool     mLinearReload;
+            uint8_t  mStep;         // Position in the 32 step sequence.
+            uint16_t mTimer;
+            uint8_t  mLength;
+            bool     mEnabled;
+            uint64_t mNext;
+
+            void     Write(uint8_t lRegister, uint8_t lData);
+            void     Clock(void);
+            void     ClockLinear(void);
+            bool     IsSilent(void)     {return mLength == 0 || mLinear == 0 || mTimer < 2;}
+            uint8_t  GetOutput(void);
+            uint32_t GetPeriod(void)    {return mTimer + 1;}
+        };
+
+        struct Noise
+        {
+            Envelope mEnvelope;
+            bool     mShortMode;    // Feedback from bit 6 instead of bit 1, for a metallic tone.
+            uint8_t  mPeriod;       // Index into the period table.
+            uint16_t mShift;        // 15 bit linear feedback shift register.
+            uint8_t  mLength;
+            bool     mEnabled;
+            uint64_t mNext;
+
+            void     Write(uint8_t lRegister, uint8_t lData);
+            void     Clock(void);
+            bool     IsSilent(void)     {return mLength == 0 || mEnvelope.GetVolume() == 0;}
+            uint8_t  GetOutput(void)    {return (mLength && !(mShift & 0x01)) ? mEnvelope.GetVolume() : 0;}
+            uint32_t GetPeriod(void);
+        };
+
+        struct Dmc
+        {
+            bool     mIrqEnabled;
+            bool     mLoop;
+            uint8_t  mRate;         // Index into the rate table.
+            uint8_t  mLevel;        // 7 bit output level.
+            uint16_t mSampleAddress;
+            uint16_t mSampleLength;
+            uint16_t mAddress;      // Next byte to fetch.
+            uint16_t mBytesLeft;
+            uint8_t  mBuffer;
+            bool     mBufferEmpty;
+            uint8_t  mShift;
+            uint8_t  mBitsLeft;
+            bool     mSilence;
+            uint64_t mNext;
+
+            void     Write(uint8_t lRegister, uint8_t lData);
+            bool     Clock(void);
+            void     Restart(void)      {mAddress = mSampleAddress; mBytesLeft = mSampleLength;}
+            bool     IsSilent(void)     {return mSilence && mBufferEmpty && mBytesLeft == 0;}
+            uint32_t GetPeriod(void);
+        };
+
+        void     RunUntil(uint64_t lTime);
+        void     RunChannels(uint64_t lStop);
+        void     ClockFrameCounter(void);
+        void     ClockQuarterFrame(void);
+        void     ClockHalfFrame(void);
+        void     FetchDmcSample(void);
+        void     UpdateOutput(uint64_t lTime);
+        void     UpdateIrq(void);
+        void     UpdateNextEvent(void);
+        uint64_t GetCpuCycle(void);
+
+        Pulse      mPulse[2];
+        Triangle   mTriangle;
+        Noise      mNoise;
+        Dmc        mDmc;
+
+        uint64_t   mTime;           // Cpu cycle everything has been run up to.
+        uint64_t   mNextEvent;      // Cpu cycle the system has to catch the apu up by.
+        uint64_t   mFrameCounterStart;  // Cpu cycle the frame counter sequence last started on.
+        uint8_t    mFrameStep;      // Next step of the frame counter sequence.
+        bool       mFiveStep;
+        bool       mIrqInhibit;
+        bool       mFrameIrq;
+        bool       mDmcIrq;
+
+        ExpansionAudio * mExpansion;    // Sound chip on the cartridge, if there is one.
+
+        BlipBuffer mOutput;
+        uint64_t   mFrameStart;     // Cpu cycle the blip buffer frame started on.
+        int32_t    mLastOutput;     // Mixed output as last handed to the blip buffer.
+        Resampler  mResampler;
+        int16_t *  mInternal;       // A frame of blip buffer output, on its way to the resampler.
+        int        mInternalSize;
+        int16_t *  mSamples;        // Output at the sample rate, waiting to be read.
+        int        mSampleCount;
+        int        mMaxSamples;
+        int        mSampleRate;
+
+        // The channels don't mix linearly. The pulses are looked up by their sum, the rest by a weighted sum.
+        // https://www.nesdev.org/wiki/APU_Mixer
+        int32_t    mPulseMix[31];
+        int32_t    mTndMix[203];
+
+        static const uint8_t  cLengths[32];
+        static const uint8_t  cDuties[4][8];
+        static const uint8_t  cTriangle[32];
+        static const uint16_t cNoisePeriods[16];
+        static const uint16_t cDmcRates[16];
+        static const uint32_t cFrameSteps[2][4];
+        static const uint32_t cFramePeriods[2];
+};
+
+#endif
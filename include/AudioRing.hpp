@@ -0,0 +1,63 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// AudioRing.hpp
+//
+// Lock free hand off of audio samples from one thread to another.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef AUDIO_RING_HPP
+#define AUDIO_RING_HPP
+
+#include "Common.hpp"
+#include <stddef.h>
+#include <atomic>
+
+//========//
+// AudioRing
+//
+// A ring of samples shared by one producer and one consumer. The producer only moves the
+// write position and the consumer only moves the read position, each publishing its own
+// with a release store, so neither side ever locks or waits on the other.
+//
+// Writing more than there's room for drops what doesn't fit and counts an overrun.
+// Reading more than has been written gets what there is and counts an underrun, the
+// consumer fills the gap however suits it.
+//========//
+//
+class AudioRing
+{
+    public:
+
+        enum
+        {
+            CACHE_LINE = 64     // Keeps the two positions from sharing a line between the threads.
+        };
+
+        AudioRing(void);
+        ~AudioRing(void);
+
+        bool     Resize(size_t lCapacity);
+        size_t   GetCapacity(void)          {return mMask ? mMask + 1 : 0;}
+        size_t   GetFill(void);
+
+        // Producer side.
+        size_t   Write(const int16_t * lSamples, size_t lCount);
+
+        // Consumer side.
+        size_t   Read(int16_t * lSamples, size_t lCount);
+
+        uint64_t GetOverrunCount(void)      {return mOverruns.load(std::memory_order_relaxed);}
+        uint64_t GetUnderrunCount(void)     {return mUnderruns.load(std::memory_order_relaxed);}
+
+    protected:
+
+        int16_t *                               mBuffer;
+        size_t                                  mMask;      // Capacity less 1, the capacity is a power of 2.
+        alignas(CACHE_LINE) std::atomic<size_t> mWrite;     // Only moved by the producer, never wraps back.
+        alignas(CACHE_LINE) std::atomic<size_t> mRead;      // Only moved by the consumer, never wraps back.
+        alignas(CACHE_LINE) std::atomic<uint64_t> mOverruns;
+        std::atomic<uint64_t>                   mUnderruns;
+};
+
+#endif
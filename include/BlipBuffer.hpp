@@ -0,0 +1,65 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// BlipBuffer.hpp
+//
+// Band limited synthesis of a signal made of steps.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef BLIP_BUFFER_HPP
+#define BLIP_BUFFER_HPP
+
+#include "Common.hpp"
+
+//========//
+// BlipBuffer
+//
+// Turns a signal that only ever jumps from one level to another into samples, without
+// evaluating it at every clock. Each jump is added as a delta at the clock it happens on,
+// spread over a few samples by a band limited step kernel, so nothing above the output's
+// Nyquist rate aliases back down. Reading integrates the deltas back into levels. Cost is
+// per jump instead of per clock, which for sound chips clocked in the MHz is most of it.
+//
+// Times are in clocks since the start of the current frame. EndFrame closes the frame and
+// makes its samples available to read.
+//========//
+//
+class BlipBuffer
+{
+    public:
+
+        enum
+        {
+            PHASE_BITS      = 5,
+            NUM_PHASES      = 1 << PHASE_BITS,  // Positions a step can land on between two samples.
+            HALF_WIDTH      = 8,                // Samples on each side of a step the kernel covers.
+            KERNEL_WIDTH    = HALF_WIDTH * 2,
+            DELTA_BITS      = 14,               // Fixed point of the kernel, one step adds up to 1 << DELTA_BITS.
+            BASS_SHIFT      = 9,                // High pass that takes out DC, about 20 Hz at 64 kHz.
+            TIME_BITS       = 32                // Fixed point of sample positions.
+        };
+
+        BlipBuffer(void);
+        ~BlipBuffer(void);
+
+        bool     SetRates(double lClockRate, double lSampleRate, int lMaxSamples);
+        void     Clear(void);
+        void     AddDelta(uint32_t lTime, int32_t lDelta);
+        void     EndFrame(uint32_t lTime);
+        int      GetSamplesAvailable(void)  {return mAvailable;}
+        int      ReadSamples(int16_t * lOut, int lCount);
+        void     RemoveSamples(int lCount);
+
+    protected:
+
+        int16_t   mKernel[NUM_PHASES][KERNEL_WIDTH];
+        uint64_t  mFactor;          // Samples per clock, TIME_BITS fixed point.
+        uint64_t  mOffset;          // Position of the start of the frame within the first sample not yet available.
+        int32_t * mBuffer;          // Deltas, the first mAvailable samples are done.
+        int       mSize;            // Samples in mBuffer, including room for the kernel to spill over.
+        int       mMaxSamples;
+        int       mAvailable;
+        int32_t   mIntegrator;      // Level at the start of mBuffer, DELTA_BITS fixed point.
+};
+
+#endif
@@ -11,6 +11,10 @@
 
 #include "Common.hpp"
 #include "Memory.hpp"
+#include "ChrTileCache.hpp"
+#include "Ppu2C02.hpp"
+#include "RomDatabase.hpp"
+#include <File/MappedFile.hpp>
 #include <Mappers/Mapper.hpp>
 
 //========//
@@ -23,6 +27,27 @@ class Cartridge : public Device
 {
     public:
 
+        // PRG pages as seen by the cpu, 4KB each over the whole address space. Only pages
+        // in the cartridge's address range ever get anything mapped.
+        enum PrgPages
+        {
+            PRG_PAGE_SIZE   = 0x1000,
+            PRG_PAGE_MASK   = PRG_PAGE_SIZE - 1,
+            PRG_PAGE_SHIFT  = 12,
+            NUM_PRG_PAGES   = 16,
+            UNMAPPED_PAGE   = Ppu2C02::UNMAPPED_PAGE
+        };
+
+        // Timing the cartridge was made for, as NES 2.0 gives it.
+        enum Timing
+        {
+            TIMING_NTSC     = 0,
+            TIMING_PAL      = 1,
+            TIMING_MULTIPLE = 2,    // Works on either.
+            TIMING_DENDY    = 3,
+            TIMING_MASK     = 0x03
+        };
+
         explicit Cartridge(const char * lFilename);
         virtual ~Cartridge(void);
 
@@ -30,7 +55,40 @@ class Cartridge : public Device
         virtual DataType Read(AddressType lAddress) override;
         virtual void     Write(AddressType lAddress, DataType lData)    override;
 
-        bool             IsPrgMirror(void) {return mPrgMirror;}
+        DataType         PpuRead(AddressType lAddress);
+        void             PpuWrite(AddressType lAddress, DataType lData);
+        const uint8_t *  GetTileRow(uint32_t lChrOffset, bool lFlip) {return mTileCache.GetRow(lChrOffset, lFlip);}
+        void             DecodeTiles(uint32_t lChrOffset, uint32_t lSize) {mTileCache.DecodeRange(lChrOffset, lSize);}
+
+        // Banks are laid out by the mapper, see Mapper.
+        void             MapPrgRom(uint8_t lPage, uint32_t lPrgOffset);
+        void             MapPrgRam(uint8_t lPage, uint32_t lRamOffset, bool lWritable);
+        void             PatchPrg(AddressType lAddress, DataType lData);
+        uint64_t         GetCpuCycles(void);
+        void             SetIrq(bool lAsserted);
+        bool             WatchesA12(void)           {return mMapper && mMapper->WatchesA12();}
+        void             ClockA12(void)             {mMapper->ClockA12();}
+        uint32_t         GetPrgRomSize(void)        {return mPrgMemory.GetSize();}
+        uint32_t         GetPrgRamSize(void)        {return mPrgRam.GetSize();}
+        uint32_t         GetChrSize(void)           {return mChrMemory.GetSize();}
+
+        // CHR pages as seen by the ppu, see Ppu2C02::PpuPages.
+        void             MapChrPage(uint8_t lPage, uint32_t lChrOffset);
+        uint8_t *        GetChrPageData(uint8_t lPage);
+        uint32_t         GetChrPageOffset(uint8_t lPage)   {return mChrPages[lPage & (NUM_CHR_PAGES - 1)];}
+
+        bool             IsChrRam(void)             {return mChrRam;}
+        Ppu2C02::Mirroring GetMirroring(void)       {return mMirroring;}
+        void             SetMirroring(Ppu2C02::Mirroring lMirroring);
+        ExpansionAudio * GetExpansionAudio(void)    {return mMapper ? mMapper->GetExpansionAudio() : nullptr;}
+        uint32_t         GetCrc(void)               {return mCrc;}
+        uint8_t          GetSubmapper(void)         {return mSubmapper;}
+        Timing           GetTiming(void)            {return mTiming;}
+        bool             HasBattery(void)           {return mBattery;}
+        void             EndFrame(void);
+        bool             UseDotRenderer(void)       {return mDotRenderer;}
+        void             SetDotRenderer(bool lDot)  {mDotRenderer = lDot;}
+        bool             AllowsDeferredRenderer(void);
 
     protected:
 
@@ -47,27 +105,72 @@ class Cartridge : public Device
             char       mUnused[5];  // Byte  11-15
         };
 
+        // The same 16 bytes as NES 2.0 uses them, https://www.nesdev.org/wiki/NES_2.0
+        struct Header20
+        {
+            char       mId[4];          // Bytes 0-3
+            uint8_t    mPrgBanks;       // Byte  4, low byte of the PRG ROM size.
+            uint8_t    mChrBanks;       // Byte  5, low byte of the CHR ROM size.
+            uint8_t    mFlags6;         // Byte  6
+            uint8_t    mFlags7;         // Byte  7
+            uint8_t    mMapper;         // Byte  8, mapper bits 8-11 and the submapper.
+            uint8_t    mRomSizeHigh;    // Byte  9, high nibbles of the PRG and CHR ROM sizes.
+            uint8_t    mPrgRamShift;    // Byte  10, PRG RAM and PRG NVRAM sizes as shifts of 64.
+            uint8_t    mChrRamShift;    // Byte  11, CHR RAM and CHR NVRAM sizes as shifts of 64.
+            uint8_t    mTiming;         // Byte  12
+            uint8_t    mSystemType;     // Byte  13, Vs. System or extended console type.
+            uint8_t    mMiscRoms;       // Byte  14
+            uint8_t    mExpansion;      // Byte  15, default expansion device.
+        };
+
+        // Size of each memory on the cartridge, in bytes.
+        struct Sizes
+        {
+            uint32_t   mPrgRom;
+            uint32_t   mChrRom;
+            uint32_t   mPrgRam;         // PRG RAM that's lost at power off.
+            uint32_t   mPrgNvram;       // PRG RAM that's kept, by a battery.
+            uint32_t   mChrRam;
+        };
+
         enum
         {
             DEFAULT_PRG_SIZE = 0x4000,
             DEFAULT_CHR_SIZE = 0x2000,
-            TRAINER_SIZE     = 512
+            PRG_RAM_UNIT     = 0x2000,      // Header PRG RAM size is in 8KB units, 0 meaning one anyway.
+            TRAINER_SIZE     = 512,
+            MAX_ROM_SIZE     = 0x10000000,  // 256MB, far past any real board.
+            NUM_CHR_PAGES    = Ppu2C02::NUM_PATTERN_PAGES
         };
 
         AddressType  mAddressStart;         // Start of cartridge address space.
         AddressType  mAddressEnd;           // End of cartridge address space.
-        Header       mHeader;               // Contains header informations provided by file.
-        uint8_t      mMapperId;             // Which mapper does the cartridge use.
+        union
+        {
+            Header   mHeader;               // Contains header informations provided by file.
+            Header20 mHeader20;             // The same, read as NES 2.0.
+        };
+        uint16_t     mMapperId;             // Which mapper does the cartridge use.
+        uint8_t      mSubmapper;            // Which variant of the mapper, NES 2.0 only.
+        Timing       mTiming;               // Timing the cartridge was made for.
+        uint32_t     mCrc;                  // CRC-32 of PRG ROM then CHR ROM, what the ROM database is keyed by.
         Mapper *     mMapper;               // The mapper.
         MemoryRam    mPrgMemory;            // Program ROM memory space or mapper registers.
+        MemoryRam    mPrgRam;               // Program RAM, mapped in by mappers that have it.
+        MappedFile   mSaveFile;             // Save file backing mPrgRam when there's a battery.
         MemoryRam    mChrMemory;            // Character ROM memory space or mapper registers.
-        uint8_t      mMirrorType;           // Mirroring mode, horizontal or vertical.
+        ChrTileCache mTileCache;            // Decoded copy of mChrMemory for the renderer.
+        uint32_t     mChrPages[NUM_CHR_PAGES];  // Offset in mChrMemory of each 1KB page of the pattern tables.
+        uint8_t *    mPrgRead[NUM_PRG_PAGES];   // Memory behind each 4KB page of the cpu's address space, nullptr is open bus.
+        uint8_t *    mPrgWrite[NUM_PRG_PAGES];  // Same, for writes. Only RAM is here, writes elsewhere go to the mapper.
+        Ppu2C02::Mirroring mMirroring;      // Name table mirroring, from the header until the mapper changes it.
         bool         mNes20Format;          // Is the provided file in NES 2.0 format.
-        bool         mPrgMirror;            // If the number of program banks is 1, the address space is 32k with the second half mirrored.
         bool         mChrRam;               // If the number of chracter banks is 0, the memory acts as a RAM instead.
+        bool         mBattery;              // PRG RAM is battery backed and kept in a save file.
+        bool         mSaveDirty;            // PRG RAM was written since the save file was last flushed.
         bool         mValidImage;           // Flag for determing if the file loaded is valid.
-
-    protected:
+        bool         mDotRenderer;          // Does this game need the dot accurate ppu renderer (mid-scanline effects).
+        bool         mLiveRenderer;         // Does this game need drawing as the frame runs (mid-frame bank switches).
 
         enum Flags6Bits
         {
@@ -102,6 +205,12 @@ class Cartridge : public Device
             PAL                   = 1
         };
 
+        enum Nes20MapperBits
+        {
+            MAPPER_HIGH           = 0x0F,   // Bits 8-11 of the mapper id.
+            SUBMAPPER             = 0xF0
+        };
+
         enum Flags10Bits
         {
             TV_SYSTEM_F10         = 0x03,
@@ -114,7 +223,14 @@ class Cartridge : public Device
             DUAL                  = 3
         };
 
-        uint8_t GetMirroring(void)       {return mHeader.mFlags6   & Flags6Bits::MIRRORING;}
+        bool    ParseHeader(Sizes & lSizes);
+        void    ApplyRomInfo(const RomInfo * lInfo, Sizes & lSizes);
+        void    OpenSaveFile(const char * lFilename, uint32_t lSize);
+
+        static uint64_t GetNes20RomSize(uint8_t lLow, uint8_t lHigh, uint32_t lBankSize);
+        static uint32_t GetNes20RamSize(uint8_t lShift) {return lShift ? (64U << lShift) : 0;}
+
+        uint8_t GetMirroringBit(void)    {return mHeader.mFlags6   & Flags6Bits::MIRRORING;}
         uint8_t GetBattery(void)         {return mHeader.mFlags6   & Flags6Bits::BATTERY;}
         uint8_t GetTrainer(void)         {return mHeader.mFlags6   & Flags6Bits::TRAINER;}
         uint8_t GetFourScreen(void)      {return mHeader.mFlags6   & Flags6Bits::FOUR_SCREEN_MODE;}
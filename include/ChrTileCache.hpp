@@ -0,0 +1,66 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// ChrTileCache.hpp
+//
+// Cache of pattern table tiles decoded into one byte per pixel.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CHR_TILE_CACHE_HPP
+#define CHR_TILE_CACHE_HPP
+
+#include "Common.hpp"
+#include "Memory.hpp"
+
+//========//
+// ChrTileCache
+//
+// Each 16-byte tile in CHR memory is decoded once into 8 rows of 8 pixels (0-3), both
+// as stored and horizontally flipped. Entries are keyed by the offset in CHR memory rather
+// than by ppu address, so a bank switch just makes the mapper hand out different offsets
+// and nothing needs to be thrown away. Writes to CHR RAM mark the tile as stale and it
+// gets decoded again the next time it's asked for.
+//========//
+//
+class ChrTileCache
+{
+    public:
+
+        enum
+        {
+            TILE_SIZE       = 16,   // Bytes per tile in CHR memory, 8 for each bitplane.
+            TILE_ROWS       = 8,
+            TILE_WIDTH      = 8,
+            PLANE_OFFSET    = 8,    // Offset of the high bitplane within a tile.
+            ROW_MASK        = 0x07,
+            TILE_SHIFT      = 4,
+
+            // Layout of one decoded tile, all the unflipped rows then all the flipped rows.
+            FLIPPED_OFFSET  = TILE_ROWS * TILE_WIDTH,
+            DECODED_SIZE    = FLIPPED_OFFSET * 2
+        };
+
+        explicit ChrTileCache(Memory & lChrMemory);
+        ~ChrTileCache(void);
+
+        void            Resize(uint32_t lChrSize);
+        void            Invalidate(uint32_t lChrOffset);
+        void            InvalidateAll(void);
+        const uint8_t * GetRow(uint32_t lChrOffset, bool lFlip);
+        void            DecodeRange(uint32_t lChrOffset, uint32_t lSize);
+
+        static const uint8_t * GetBlankRow(void)         {return cBlankRow;}
+
+    protected:
+
+        void            DecodeTile(uint32_t lTile);
+
+        Memory &        mChrMemory;     // CHR ROM or RAM the tiles are decoded from.
+        uint8_t *       mDecoded;       // DECODED_SIZE bytes for every tile.
+        bool *          mStale;         // Does the tile need decoding before use.
+        uint32_t        mNumTiles;
+
+        static const uint8_t cBlankRow[TILE_WIDTH];
+};
+
+#endif
@@ -29,6 +29,13 @@ class Cpu6502 : public Device
 
     public:
 
+        // Everything that can pull the IRQ line low. The line is asserted while any of them are.
+        enum IrqSources
+        {
+            IRQ_APU         = Bit(0),
+            IRQ_CARTRIDGE   = Bit(1)
+        };
+
         Cpu6502(void);
         virtual ~Cpu6502(void);
 
@@ -38,6 +45,9 @@ class Cpu6502 : public Device
         void             Reset();
         void             StepClock();
         uint8_t          GetCyclesLeft() {return mCyclesLeft;}
+        void             RequestNmi()    {mNmiPending = true;}
+        void             Stall(uint16_t lCycles) {mStallPending += lCycles;}
+        void             SetIrq(uint8_t lSource, bool lAsserted)  {mIrqLine = lAsserted ? (mIrqLine | lSource) : (mIrqLine & ~lSource);}
 
     protected:
 
@@ -163,6 +173,11 @@ class Cpu6502 : public Device
         uint8_t                              mCyclesLeft;           // Remaining clock cycles current instruction has.
         Registers                            mRegisters;            // All registers the cpu has.
         bool                                 mHalted;               // Is the cpu halted.
+        bool                                 mNmiPending;           // An NMI was signaled and will be serviced before the next instruction.
+        uint8_t                              mIrqLine;              // IrqSources asserting the IRQ line, serviced at each instruction boundary while interrupts are enabled.
+        uint16_t                             mStallPending;         // DMA cycles the current instruction started, taken once it's done.
+        uint16_t                             mStallCycles;          // DMA cycles left before the next instruction.
+        bool                                 mOddCycle;             // Parity of the current cycle, DMA can only start on an even one.
         const InterruptVector                mInterruptVectors[NUM_VECTORS];
         inline static constexpr AddressType  cStartOfStack = 0x0100;
         inline static constexpr uint16_t     cStackSize    = 0xFF + 1;
@@ -0,0 +1,44 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// Crc32.hpp
+//
+// CRC-32 checksums, as used to identify ROM images.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CRC32_HPP
+#define CRC32_HPP
+
+#include "Common.hpp"
+#include <stddef.h>
+
+//========//
+// Crc32
+//
+// Running CRC-32 (the zip/PNG polynomial, what ROM databases list). Data is added a block
+// at a time as it arrives, so it can be checksummed while it's read in. Eight bytes are
+// folded at a time with a table for each, which keeps it to a few table lookups per byte.
+//========//
+//
+class Crc32
+{
+    public:
+
+        enum
+        {
+            POLYNOMIAL      = 0xEDB88320,   // Reflected 0x04C11DB7.
+            NUM_TABLES      = 8,
+            TABLE_SIZE      = 256
+        };
+
+        Crc32(void) : mCrc(0xFFFFFFFF) {}
+
+        void     Update(const uint8_t * lData, size_t lSize);
+        uint32_t GetValue(void) {return ~mCrc;}
+
+    protected:
+
+        uint32_t mCrc;      // Running value, inverted.
+};
+
+#endif
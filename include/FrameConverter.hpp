@@ -0,0 +1,96 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// FrameConverter.hpp
+//
+// Output stage that turns the ppu's palette indexed frame into displayable pixels.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef FRAME_CONVERTER_HPP
+#define FRAME_CONVERTER_HPP
+
+#include "Common.hpp"
+#include "WorkerPool.hpp"
+#include <stddef.h>
+
+//========//
+// FrameConverter
+//
+// Converts a frame of 6-bit system palette colors into RGBA8888, BGRA8888 or RGB565.
+// There is one 64 entry table for each of the 8 combinations of the PPUMASK color
+// emphasis bits. Greyscale is applied by masking the color down to its brightness
+// column before the lookup, like the ppu does. FORMAT_NONE turns the stage off for
+// runs that only need the indexed frame. Bands of rows can be converted on a pool of
+// threads started once, so a frame costs a wake up rather than a thread spawn.
+//========//
+//
+class FrameConverter
+{
+    public:
+
+        enum PixelFormat
+        {
+            FORMAT_NONE = 0,    // No conversion at all.
+            FORMAT_RGBA8888,    // Bytes R, G, B, A.
+            FORMAT_BGRA8888,    // Bytes B, G, R, A.
+            FORMAT_RGB565       // 16-bit, red in the top 5 bits.
+        };
+
+        enum
+        {
+            NUM_COLORS          = 64,
+            NUM_EMPHASIS        = 8,
+            EMPHASIS_SHIFT      = 5,        // PPUMASK bits 5-7 are red, green and blue emphasis.
+            COLOR_MASK          = 0x3F,
+            GREYSCALE_MASK      = 0x30,     // Greyscale keeps only the brightness of the color.
+            EMPHASIS_DIM        = 209,      // Channels that aren't emphasized are scaled by this/256, about 0.816.
+            MAX_THREADS         = 8
+        };
+
+        FrameConverter(void);
+        ~FrameConverter(void) = default;
+
+        void        SetFormat(PixelFormat lFormat);
+        PixelFormat GetFormat(void)             {return mFormat;}
+        int         GetBytesPerPixel(void);
+        void        SetThreads(int lThreads);
+        int         GetThreads(void)            {return mPool.GetThreads();}
+
+        void        Convert(const uint8_t * lColors, const uint8_t * lLineMasks, int lWidth, int lHeight, void * lOut);
+
+    protected:
+
+        void        BuildTables(void);
+        void        ConvertRows(const uint8_t * lColors, const uint8_t * lLineMasks, int lWidth, int lFirst, int lLast, void * lOut);
+
+        PixelFormat mFormat;
+        uint32_t    mTables[NUM_EMPHASIS][NUM_COLORS];      // Output pixel of every color, per emphasis setting.
+
+        // A band of rows of the frame being converted, one per thread.
+        class ConvertBand : public Functor
+        {
+            public:
+                ConvertBand(void) : mConverter(nullptr), mFirst(0), mLast(0) {}
+                virtual void Execute(void) override
+                {
+                    mConverter->ConvertRows(mConverter->mColors, mConverter->mLineMasks, mConverter->mWidth, mFirst, mLast,
+                                            mConverter->mOut);
+                }
+
+                FrameConverter * mConverter;
+                int              mFirst;        // First row of the band.
+                int              mLast;         // One past the last row of the band.
+        };
+
+        WorkerPool      mPool;
+        ConvertBand     mBands[MAX_THREADS];
+        Functor *       mBandJobs[MAX_THREADS];
+        const uint8_t * mColors;                            // The frame being converted, for the bands.
+        const uint8_t * mLineMasks;
+        int             mWidth;
+        void *          mOut;
+
+        static const uint8_t cSystemPalette[NUM_COLORS][3];
+};
+
+#endif
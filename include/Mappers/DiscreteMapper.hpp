@@ -0,0 +1,181 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// DiscreteMapper.hpp
+//
+// Mappers for boards built from discrete logic, a single latch holding the bank numbers.
+// https://www.nesdev.org/wiki/UxROM            id 002
+// https://www.nesdev.org/wiki/INES_Mapper_003  id 003
+// https://www.nesdev.org/wiki/AxROM            id 007
+// https://www.nesdev.org/wiki/Color_Dreams     id 011
+// https://www.nesdev.org/wiki/GxROM            id 066
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DISCRETE_MAPPER_HPP
+#define DISCRETE_MAPPER_HPP
+
+#include "Mapper.hpp"
+#include "Cartridge.hpp"
+
+//========//
+// DiscreteMapper
+//
+// Class for boards whose only register is a latch written anywhere in $8000-$FFFF. They
+// differ only in which bits of it pick which bank, so each one is a Board describing its
+// latch, and the template turns that into a write handler with nothing left to decide at
+// run time.
+//
+// A Board has these constants:
+//   PRG_SIZE       Size of the switchable PRG bank at $8000. 16KB fixes the last bank at $C000.
+//   PRG_MASK       Latch bits picking the PRG bank, 0 if it doesn't switch.
+//   PRG_SHIFT      How far down to shift them.
+//   CHR_MASK       Latch bits picking the 8KB CHR bank, 0 if it doesn't switch.
+//   CHR_SHIFT      How far down to shift them.
+//   MIRROR_SELECT  Latch bit picking the single screen name table, 0 to keep the header's mirroring.
+//   BUS_CONFLICTS  1 if the ROM drives the bus as well, so a write only gets the bits both agree on.
+//========//
+//
+template <typename Board>
+class DiscreteMapper : public Mapper
+{
+    public:
+        enum
+        {
+            PRG_ROM_START           = 0x8000,
+            PRG_ROM_HIGH_START      = 0xC000,
+            CHR_START               = 0x0000
+        };
+
+        explicit DiscreteMapper(Cartridge * lCartridge) : Mapper(lCartridge) {}
+        virtual ~DiscreteMapper(void) = default;
+
+        //--------//
+        // Reset
+        //
+        // Lays out the banks as if the latch held 0, and fixes the last PRG bank at $C000
+        // on boards that switch less than 32KB.
+        //--------//
+        //
+        virtual void Reset(void) override
+        {
+            if constexpr (Board::PRG_SIZE < 0x8000)
+            {
+                SetPrg16k(PRG_ROM_HIGH_START, -1);
+            }
+            SetPrgBank(PRG_ROM_START, Board::PRG_SIZE, 0);
+            SetChr8k(CHR_START, 0);
+            Latch(0);
+        }
+
+        //--------//
+        // WriteRegister
+        //
+        // Writes the latch.
+        //
+        // param[in]   lAddress    Address written, $8000-$FFFF are the latch.
+        // param[in]   lData       The data written.
+        //--------//
+        //
+        virtual void WriteRegister(AddressType lAddress, DataType lData) override
+        {
+            if (lAddress < PRG_ROM_START)
+            {
+                return;
+            }
+            if constexpr (Board::BUS_CONFLICTS)
+            {
+                lData &= mCartridge->Read(lAddress);
+            }
+            Latch(lData);
+        }
+
+    protected:
+
+        //--------//
+        // Latch
+        //
+        // Lays out whatever banks the board switches from the latched value.
+        //
+        // param[in]   lData       The value latched.
+        //--------//
+        //
+        void Latch(DataType lData)
+        {
+            if constexpr (Board::PRG_MASK != 0)
+            {
+                SetPrgBank(PRG_ROM_START, Board::PRG_SIZE, (lData & Board::PRG_MASK) >> Board::PRG_SHIFT);
+            }
+            if constexpr (Board::CHR_MASK != 0)
+            {
+                SetChr8k(CHR_START, (lData & Board::CHR_MASK) >> Board::CHR_SHIFT);
+            }
+            if constexpr (Board::MIRROR_SELECT != 0)
+            {
+                mCartridge->SetMirroring((lData & Board::MIRROR_SELECT) ? Ppu2C02::MIRROR_SINGLE_HIGH : Ppu2C02::MIRROR_SINGLE_LOW);
+            }
+        }
+};
+
+//========//
+// Boards
+//
+// The latch layout of each discrete board.
+//========//
+//
+struct UxRomBoard
+{
+    enum
+    {
+        PRG_SIZE = 0x4000, PRG_MASK = 0x0F, PRG_SHIFT = 0,
+        CHR_MASK = 0x00,   CHR_SHIFT = 0,
+        MIRROR_SELECT = 0, BUS_CONFLICTS = 1
+    };
+};
+
+struct CnRomBoard
+{
+    enum
+    {
+        PRG_SIZE = 0x8000, PRG_MASK = 0x00, PRG_SHIFT = 0,
+        CHR_MASK = 0x03,   CHR_SHIFT = 0,
+        MIRROR_SELECT = 0, BUS_CONFLICTS = 1
+    };
+};
+
+struct AxRomBoard
+{
+    enum
+    {
+        PRG_SIZE = 0x8000, PRG_MASK = 0x07, PRG_SHIFT = 0,
+        CHR_MASK = 0x00,   CHR_SHIFT = 0,
+        MIRROR_SELECT = Bit(4), BUS_CONFLICTS = 0  // AOROM has none, and games that don't avoid them expect that.
+    };
+};
+
+struct ColorDreamsBoard
+{
+    enum
+    {
+        PRG_SIZE = 0x8000, PRG_MASK = 0x03, PRG_SHIFT = 0,
+        CHR_MASK = 0xF0,   CHR_SHIFT = 4,
+        MIRROR_SELECT = 0, BUS_CONFLICTS = 1
+    };
+};
+
+struct GxRomBoard
+{
+    enum
+    {
+        PRG_SIZE = 0x8000, PRG_MASK = 0x30, PRG_SHIFT = 4,
+        CHR_MASK = 0x03,   CHR_SHIFT = 0,
+        MIRROR_SELECT = 0, BUS_CONFLICTS = 1
+    };
+};
+
+using Mapper002 = DiscreteMapper<UxRomBoard>;
+using Mapper003 = DiscreteMapper<CnRomBoard>;
+using Mapper007 = DiscreteMapper<AxRomBoard>;
+using Mapper011 = DiscreteMapper<ColorDreamsBoard>;
+using Mapper066 = DiscreteMapper<GxRomBoard>;
+
+#endif
@@ -0,0 +1,56 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// ExpansionAudio.hpp
+//
+// Base class for sound chips on the cartridge.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef EXPANSION_AUDIO_HPP
+#define EXPANSION_AUDIO_HPP
+
+#include "Common.hpp"
+
+class Apu2A03;
+
+//========//
+// ExpansionAudio
+//
+// A sound chip on the cartridge, like the VRC6, VRC7, FDS, MMC5, N163 or Sunsoft 5B. A
+// mapper with one hands it out from Mapper::GetExpansionAudio, and the apu runs it along
+// with its own channels whenever it catches up. Changes in the chip's output go straight
+// into the apu's blip buffer, so however many chips there are, there's only ever one
+// buffer to mix down and resample.
+//
+// Like the apu, a chip isn't clocked per cpu cycle. RunUntil is given a cpu cycle and
+// works out everything from the last one it got, handing each change in its output to
+// SetOutput. Before a register write changes what the chip is doing, the mapper calls
+// Sync so the output up to that point is made with the old settings.
+//
+// Output is in the same units as the apu's mix, Apu2A03::OUTPUT_SCALE being full scale
+// for the apu alone, so each chip sets its own level relative to the apu.
+//========//
+//
+class ExpansionAudio
+{
+    public:
+
+        ExpansionAudio(void) : mApu(nullptr), mTime(0), mLastOutput(0) {}
+        virtual ~ExpansionAudio(void) = default;
+
+        void         Connect(Apu2A03 * lApu)    {mApu = lApu;}
+        int32_t      GetOutput(void)            {return mLastOutput;}
+        virtual void Reset(uint64_t lTime);
+        virtual void RunUntil(uint64_t lTime) = 0;
+
+    protected:
+
+        void         Sync(void);
+        void         SetOutput(uint64_t lTime, int32_t lOutput);
+
+        Apu2A03 *    mApu;
+        uint64_t     mTime;         // Cpu cycle the chip has been run up to.
+        int32_t      mLastOutput;   // Output as last handed to the apu.
+};
+
+#endif
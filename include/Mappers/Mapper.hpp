@@ -11,13 +11,24 @@
 
 #include "Common.hpp"
 #include "Memory.hpp"
+#include "ExpansionAudio.hpp"
 
 class Cartridge;
 
 //========//
 // Mapper
 //
-// Base class for every mapper.
+// Base class for every mapper. A mapper doesn't translate addresses. It lays out its banks
+// in the cartridge's page tables, 4KB pages for the cpu and 1KB pages for the ppu, and
+// lays them out again whenever a register write switches them. Reads never reach mapper
+// code, only writes to the cartridge's address range that don't land in PRG RAM do.
+//
+// The SetPrg and SetChr helpers take a bank number in units of the size switched, and
+// wrap it around the memory there is, so a negative bank counts back from the last one.
+// A mapper with a sound chip on board also overrides GetExpansionAudio, the rest leave
+// the apu with nothing extra to run. Likewise a mapper counting scanlines by PPU A12
+// overrides WatchesA12 and gets ClockA12 once a line, at the dot the ppu predicts A12
+// rises on. The rest leave the ppu with nothing to predict.
 //========//
 //
 class Mapper
@@ -27,15 +38,34 @@ class Mapper
         explicit Mapper(Cartridge * lCartridge) : mCartridge(lCartridge) {}
         virtual ~Mapper(void) = default;
 
-        virtual bool MapRead(AddressType lAddress, AddressType * lMappedAddress, DataType * lData) = 0;
-        virtual bool MapWrite(AddressType lAddress, AddressType * lMappedAddress, DataType lData)  = 0;
+        virtual void             Reset(void) = 0;
+        virtual void             WriteRegister(AddressType lAddress, DataType lData)    {(void)lAddress; (void)lData;}
+        virtual ExpansionAudio * GetExpansionAudio(void)                                {return nullptr;}
+        virtual bool             WatchesA12(void)                                       {return false;}
+        virtual void             ClockA12(void)                                         {}
 
     protected:
 
+        void SetPrg4k(AddressType lAddress, int lBank)   {SetPrgBank(lAddress, 0x1000, lBank);}
+        void SetPrg8k(AddressType lAddress, int lBank)   {SetPrgBank(lAddress, 0x2000, lBank);}
+        void SetPrg16k(AddressType lAddress, int lBank)  {SetPrgBank(lAddress, 0x4000, lBank);}
+        void SetPrg32k(AddressType lAddress, int lBank)  {SetPrgBank(lAddress, 0x8000, lBank);}
+        void SetPrgRam8k(AddressType lAddress, int lBank, bool lWritable = true);
+        void SetPrgOpenBus(AddressType lAddress, uint32_t lSize);
+        void SetChr1k(AddressType lAddress, int lBank)   {SetChrBank(lAddress, 0x0400, lBank);}
+        void SetChr2k(AddressType lAddress, int lBank)   {SetChrBank(lAddress, 0x0800, lBank);}
+        void SetChr4k(AddressType lAddress, int lBank)   {SetChrBank(lAddress, 0x1000, lBank);}
+        void SetChr8k(AddressType lAddress, int lBank)   {SetChrBank(lAddress, 0x2000, lBank);}
+
+        void SetPrgBank(AddressType lAddress, uint32_t lSize, int lBank);
+        void SetChrBank(AddressType lAddress, uint32_t lSize, int lBank);
+
+        static uint32_t GetBankOffset(uint32_t lMemorySize, uint32_t lSize, int lBank);
+
         Cartridge *  mCartridge;
 };
 
 // Global functions.
-extern Mapper * MapperFactory(uint8_t lMapperId, Cartridge * lCartridge);
+extern Mapper * MapperFactory(uint16_t lMapperId, Cartridge * lCartridge);
 
 #endif
@@ -0,0 +1,94 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// Mapper_001.hpp
+//
+// Mapper for id 001, https://www.nesdev.org/wiki/MMC1
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MAPPER_001_HPP
+#define MAPPER_001_HPP
+
+#include "Mapper.hpp"
+
+//========//
+// Mapper001
+//
+// Class for mapper 001, the MMC1. Registers are loaded a bit at a time through a 5 bit
+// shift register, any write to $8000-$FFFF shifts in bit 0, and the fifth write copies
+// the result to the register picked by address bits 13-14. Banks are only laid out
+// again when that happens, which keeps the four writes before it cheap.
+//
+// PRG ROM past 256KB (SUROM, SXROM) is picked by bit 4 of the CHR bank registers. PRG
+// RAM past 8KB is picked by bit 3 when there's 16KB (SOROM), or by bits 2-3 when there's
+// 32KB (SXROM).
+//========//
+//
+class Mapper001 : public Mapper
+{
+    public:
+        enum
+        {
+            PRG_RAM_START           = 0x6000,
+            PRG_ROM_START           = 0x8000,
+            PRG_ROM_HIGH_START      = 0xC000,
+            CHR_START               = 0x0000,
+            CHR_HIGH_START          = 0x1000,
+
+            SHIFT_RESET             = Bit(7),   // Written with any value, empties the shift register.
+            SHIFT_LOADED            = Bit(4),   // Starting marker, once it shifts out the register is full.
+            REGISTER_SHIFT          = 13,       // Address bits picking the register.
+            REGISTER_MASK           = 0x03,
+
+            PRG_OUTER_SIZE          = 0x40000,  // 256KB, the most the PRG bank register reaches alone.
+            PRG_OUTER_BANK          = Bit(4),   // CHR bank bit picking the 256KB half of larger PRG ROM.
+            PRG_RAM_16K             = 0x4000,   // SOROM, CHR bank bit 3 picks the 8KB bank.
+            PRG_RAM_16K_SHIFT       = 3,
+            PRG_RAM_16K_MASK        = 0x01,
+            PRG_RAM_32K             = 0x8000,   // SXROM, CHR bank bits 2-3 pick the 8KB bank.
+            PRG_RAM_32K_SHIFT       = 2,
+            PRG_RAM_32K_MASK        = 0x03
+        };
+
+        enum Registers
+        {
+            CONTROL                 = 0,
+            CHR_BANK_0              = 1,
+            CHR_BANK_1              = 2,
+            PRG_BANK                = 3
+        };
+
+        enum ControlBits
+        {
+            MIRRORING               = BitMask(2),
+            PRG_MODE                = BitMask(2, 2),
+            CHR_4K_MODE             = Bit(4),
+
+            // PRG modes.
+            PRG_32K                 = 0x00,     // 0 and 1 both switch 32KB at $8000.
+            PRG_FIX_FIRST           = 0x08,     // First bank fixed at $8000, switch 16KB at $C000.
+            PRG_FIX_LAST            = 0x0C      // Last bank fixed at $C000, switch 16KB at $8000.
+        };
+
+        enum PrgBankBits
+        {
+            PRG_BANK_MASK           = 0x0F,
+            PRG_RAM_DISABLE         = Bit(4)
+        };
+
+        explicit Mapper001(Cartridge * lCartridge);
+        virtual ~Mapper001(void) = default;
+
+        virtual void Reset(void)                                            override;
+        virtual void WriteRegister(AddressType lAddress, DataType lData)    override;
+
+    protected:
+
+        void     UpdateBanks(void);
+
+        uint8_t  mShift;                // Bits loaded so far, under the SHIFT_LOADED marker.
+        uint8_t  mRegisters[4];
+        uint64_t mLastWriteCycle;       // The MMC1 ignores a write on the cycle right after another.
+};
+
+#endif
@@ -0,0 +1,92 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// Mapper_004.hpp
+//
+// Mapper for id 004, https://www.nesdev.org/wiki/MMC3
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MAPPER_004_HPP
+#define MAPPER_004_HPP
+
+#include "Mapper.hpp"
+
+//========//
+// Mapper004
+//
+// Class for mapper 004, the MMC3. Eight bank registers pick two switchable 8KB PRG banks
+// and six CHR banks, two of 2KB and four of 1KB, with mode bits to swap which halves of
+// each are switchable. Banks are only laid out again when a register changes them.
+//
+// The scanline counter is clocked by PPU A12 rising, which the ppu predicts from the
+// pattern tables in PPUCTRL rather than the mapper watching every fetch. When it's
+// clocked at zero, or after a reload, it's loaded from the latch, otherwise it counts
+// down. Reaching zero with IRQs enabled asserts the IRQ until it's acknowledged.
+//========//
+//
+class Mapper004 : public Mapper
+{
+    public:
+        enum
+        {
+            PRG_RAM_START           = 0x6000,
+            PRG_ROM_START           = 0x8000,
+            PRG_ROM_SECOND          = 0xA000,
+            PRG_ROM_THIRD           = 0xC000,
+            PRG_ROM_LAST            = 0xE000,
+            CHR_HALF_SIZE           = 0x1000,
+
+            REGISTER_PAIR_MASK      = 0xE001,   // Registers are decoded by A15-A13 and A0.
+            NUM_BANK_REGISTERS      = 8
+        };
+
+        enum Registers
+        {
+            BANK_SELECT             = 0x8000,
+            BANK_DATA               = 0x8001,
+            MIRRORING               = 0xA000,
+            PRG_RAM_PROTECT         = 0xA001,
+            IRQ_LATCH               = 0xC000,
+            IRQ_RELOAD              = 0xC001,
+            IRQ_DISABLE             = 0xE000,
+            IRQ_ENABLE              = 0xE001
+        };
+
+        enum BankSelectBits
+        {
+            BANK_REGISTER           = BitMask(3),
+            PRG_SWAP                = Bit(6),   // 0: $8000 switchable, $C000 second last. 1: the other way around.
+            CHR_INVERT              = Bit(7)    // 0: 2KB banks at $0000. 1: 2KB banks at $1000.
+        };
+
+        enum RamProtectBits
+        {
+            RAM_WRITE_PROTECT       = Bit(6),
+            RAM_ENABLE              = Bit(7)
+        };
+
+        explicit Mapper004(Cartridge * lCartridge);
+        virtual ~Mapper004(void) = default;
+
+        virtual void Reset(void)                                            override;
+        virtual void WriteRegister(AddressType lAddress, DataType lData)    override;
+        virtual bool WatchesA12(void)                                       override {return true;}
+        virtual void ClockA12(void)                                         override;
+
+    protected:
+
+        void     UpdatePrgBanks(void);
+        void     UpdateChrBanks(void);
+        void     UpdatePrgRam(void);
+
+        uint8_t  mBankSelect;
+        uint8_t  mBanks[NUM_BANK_REGISTERS];
+        uint8_t  mRamProtect;
+        uint8_t  mIrqLatch;
+        uint8_t  mIrqCounter;
+        bool     mIrqReload;
+        bool     mIrqEnabled;
+        bool     mFourScreen;               // Four screen boards have no mirroring control.
+};
+
+#endif
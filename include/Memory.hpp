@@ -25,21 +25,21 @@ class Memory
     public:
 
         Memory(void)                       : mSize(0) {}
-        explicit Memory(AddressType lSize) : mSize(lSize) {}
+        explicit Memory(uint32_t lSize)    : mSize(lSize) {}
         virtual ~Memory(void) {}
 
         virtual DataType Read(AddressType lAddress)                     = 0;
         virtual void     Write(AddressType lAddress, DataType lData)    = 0;
-        virtual void     Resize(AddressType lSize)                      = 0;
+        virtual void     Resize(uint32_t lSize)                         = 0;
         virtual int      LoadMemoryFromFile(File * lFile, size_t lSize) = 0;
 
-        AddressType      GetSize(void) {return mSize;}
+        uint32_t         GetSize(void) {return mSize;}
         
     protected:
 
         int              LoadMemoryFromFile(File * lFile, size_t lSize, uint8_t * mMemory);
 
-        AddressType mSize;
+        uint32_t    mSize;      // Cartridge memory can be bigger than the address space.
 };
 
 //========//
@@ -52,18 +52,23 @@ class MemoryRom : public Memory
 {
     public:
 
-        MemoryRom(void) : Memory(), mMemory(nullptr) {}
-        explicit MemoryRom(AddressType lSize) : Memory(lSize), mMemory(nullptr) {Resize(lSize);}
+        MemoryRom(void) : Memory(), mMemory(nullptr), mOwned(true) {}
+        explicit MemoryRom(uint32_t lSize) : Memory(lSize), mMemory(nullptr), mOwned(true) {Resize(lSize);}
         virtual ~MemoryRom(void);
 
         virtual DataType Read(AddressType lAddress)                     override;
         virtual void     Write(AddressType lAddress, DataType lData)    override;
-        virtual void     Resize(AddressType lSize)                      override;
+        virtual void     Resize(uint32_t lSize)                         override;
         virtual int      LoadMemoryFromFile(File * lFile, size_t lSize) override;
+        uint8_t *        GetBuffer(void) {return mMemory;}
+        void             SetBuffer(uint8_t * lMemory, uint32_t lSize);
 
     protected:
 
+        void             Free(void);
+
         uint8_t * mMemory;
+        bool      mOwned;       // False when mMemory belongs to someone else, see SetBuffer.
 };
 
 //========//
@@ -74,10 +79,42 @@ class MemoryRom : public Memory
 //
 inline MemoryRom::~MemoryRom(void)
 {
-    if (mMemory)
+    Free();
+}
+
+//--------//
+// Free
+//
+// Lets go of the memory, deleting it if it's ours.
+//--------//
+//
+inline void MemoryRom::Free(void)
+{
+    if (mMemory && mOwned)
     {
         delete [] mMemory;
     }
+    mMemory = nullptr;
+    mOwned  = true;
+    mSize   = 0;
+}
+
+//--------//
+// SetBuffer
+//
+// Uses memory that belongs to someone else, such as a mapped file, in place of its own.
+// The memory has to outlive this, or be replaced first.
+//
+// param[in]    lMemory     Memory to use.
+// param[in]    lSize       Size of it.
+//--------//
+//
+inline void MemoryRom::SetBuffer(uint8_t * lMemory, uint32_t lSize)
+{
+    Free();
+    mMemory = lMemory;
+    mOwned  = false;
+    mSize   = lMemory ? lSize : 0;
 }
 
 //--------//
@@ -88,14 +125,10 @@ inline MemoryRom::~MemoryRom(void)
 // param[in]    lSize   Size of memory. 
 //--------//
 //
-inline void MemoryRom::Resize(AddressType lSize)
+inline void MemoryRom::Resize(uint32_t lSize)
 {
     // Clean up old memory
-    if (mMemory)
-    {
-        delete [] mMemory;
-        mMemory = nullptr;
-    }
+    Free();
 
     // Nothing else to do if size is 0.
     if (lSize == 0)
@@ -166,7 +199,7 @@ class MemoryRam : public MemoryRom
     public:
 
         MemoryRam(void) : MemoryRom() {}
-        explicit MemoryRam(AddressType lSize) : MemoryRom(lSize) {}
+        explicit MemoryRam(uint32_t lSize) : MemoryRom(lSize) {}
         virtual ~MemoryRam(void) = default;
 
         virtual void Write(AddressType lAddress, DataType lData) override;
@@ -0,0 +1,77 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// PixelKernels.hpp
+//
+// Per-pixel inner loops of the scanline renderer and the output stage, with SIMD versions
+// picked at runtime.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef PIXEL_KERNELS_HPP
+#define PIXEL_KERNELS_HPP
+
+#include "Common.hpp"
+
+//========//
+// PixelKernels
+//
+// Holds the kernels the renderer and output stage run for every pixel. Each has a scalar
+// version that works everywhere and, on x86, SSE2 and AVX2 versions. The first call to Get
+// picks the best set the cpu supports.
+//========//
+//
+class PixelKernels
+{
+    public:
+
+        enum Level
+        {
+            SCALAR = 0,
+            SSE2,
+            AVX2,       // Also needs BMI2 for pdep.
+
+            NUM_LEVELS
+        };
+
+        // Interleaves the two bitplane bytes of a tile row into 8 pixels (0-3), leftmost first,
+        // and into the same 8 pixels in reverse for a horizontally flipped row.
+        typedef void (*DecodeRowFunction)(uint8_t lLow, uint8_t lHigh, uint8_t * lPixels, uint8_t * lFlipped);
+
+        // Combines background pixels (0-3) with their palette (0-3) into a palette RAM index.
+        // Transparent pixels stay 0 no matter which palette they're in.
+        typedef void (*MergeAttributesFunction)(const uint8_t * lPixels, const uint8_t * lPalettes, uint8_t * lIndices, int lCount);
+
+        // Picks the sprite or background palette RAM index of each pixel. Sprite indices are 0 when
+        // transparent, lBehind is 0xFF for sprites with the background priority bit set, else 0.
+        typedef void (*ResolvePriorityFunction)(const uint8_t * lBackground, const uint8_t * lSprite, const uint8_t * lBehind,
+                                                uint8_t * lIndices, int lCount);
+
+        // Turns system palette colors into output pixels through a 64 entry table. Colors are
+        // masked by lColorMask first, which is how greyscale drops the hue.
+        typedef void (*LookupColors32Function)(const uint8_t * lColors, uint8_t lColorMask, const uint32_t * lTable, uint32_t * lOut, int lCount);
+        typedef void (*LookupColors16Function)(const uint8_t * lColors, uint8_t lColorMask, const uint32_t * lTable, uint16_t * lOut, int lCount);
+
+        struct Table
+        {
+            DecodeRowFunction       mDecodeRow;
+            MergeAttributesFunction mMergeAttributes;
+            ResolvePriorityFunction mResolvePriority;
+            LookupColors32Function  mLookupColors32;
+            LookupColors16Function  mLookupColors16;
+        };
+
+        static const Table & Get(void);
+        static const Table * GetLevel(Level lLevel);
+        static Level         GetBestLevel(void);
+        static const char *  GetLevelName(Level lLevel);
+
+#ifdef TEST_PPU
+        static bool          SelfTest(void);
+#endif
+
+    protected:
+
+        static const Table * cActive;
+};
+
+#endif
@@ -10,6 +10,10 @@
 #define PPU_2C02_HPP
 
 #include "Common.hpp"
+#include "Memory.hpp"
+#include "WorkerPool.hpp"
+
+class Cartridge;
 
 //========//
 // PpuRegister
@@ -43,12 +47,109 @@ class Ppu2C02 : public Device
 {
     public:
 
+        enum Screen
+        {
+            SCREEN_WIDTH            = 256,
+            SCREEN_HEIGHT           = 240,
+            DOTS_PER_SCANLINE       = 341,
+            SCANLINES_PER_FRAME     = 262,
+            POST_RENDER_SCANLINE    = 240,
+            VBLANK_SCANLINE         = 241,
+            PRE_RENDER_SCANLINE     = 261,
+
+            // Dots where PPU A12 rises once a line, for cartridges that count scanlines by it. Sprite
+            // patterns from $1000 start being fetched at 260, background patterns for the next line at 324.
+            A12_SPRITE_DOT          = 260,
+            A12_BACKGROUND_DOT      = 324
+        };
+
+        // How the ppu turns memory into pixels. Both renderers keep the exact same timing for
+        // vblank, NMI and the status flags, they only differ in when the pixels get produced.
+        enum RenderMode
+        {
+            SCANLINE_RENDERER = 0,  // Draws a whole scanline at once. Fast, but misses mid-scanline effects.
+            DOT_RENDERER,           // Runs the shift registers one dot at a time, like the hardware.
+            DEFERRED_RENDERER,      // Only runs the timing while the frame plays out, then draws it all at the start of
+                                    //      vblank by replaying the register log. Same pixels as the scanline renderer.
+            PIPELINED_RENDERER      // The deferred renderer on a thread of its own, drawing each frame while the cpu runs
+                                    //      the next one. Frames come out one frame late.
+        };
+        // Either renderer can also be put in timing only mode (SetTimingOnly) for frames nobody will see, like
+        // fast forward or run ahead. The frame buffer is left alone, only what the cpu can observe is worked out.
+
+        // How the 4 logical name tables map onto physical memory. Set by the cartridge, and can be changed
+        // by its mapper at any time.
+        enum Mirroring
+        {
+            MIRROR_HORIZONTAL = 0,      // $2000 = $2400 and $2800 = $2C00, for vertical scrolling.
+            MIRROR_VERTICAL,            // $2000 = $2800 and $2400 = $2C00, for horizontal scrolling.
+            MIRROR_SINGLE_LOW,          // All four use the first physical table.
+            MIRROR_SINGLE_HIGH,         // All four use the second physical table.
+            MIRROR_FOUR_SCREEN          // Every table is separate, the extra 2KB lives on the cartridge.
+        };
+
+        // 1KB pages of the ppu address space, public so the cartridge can map CHR into them.
+        enum PpuPages
+        {
+            PPU_PAGE_SIZE       = 1024,
+            PPU_PAGE_MASK       = PPU_PAGE_SIZE - 1,
+            PPU_PAGE_SHIFT      = 10,
+            NUM_PPU_PAGES       = 16,
+            NUM_PATTERN_PAGES   = 8,
+            UNMAPPED_PAGE       = 0x80000000        // CHR offset of a pattern page with nothing behind it, past any real CHR size.
+        };
+
+        // PPUMASK, public so the output stage can apply greyscale and emphasis.
+        enum PpuMaskBits
+        {
+            GREYSCALE       = Bit(0),   // Greyscale (0: normal color, 1: produce a greyscale display).
+            LEFT_BCKGRND    = Bit(1),   // 1: Show background in leftmost 8 pixels of screen, 0: Hide.
+            LEFT_SPRITES    = Bit(2),   // 1: Show sprites in leftmost 8 pixels of screen, 0: Hide.
+            SHOW_BCKGND     = Bit(3),   // Show background.
+            SHOW_SPRITES    = Bit(4),   // Show sprites.
+            RED             = Bit(5),   // Emphasize red (green on PAL/Dendy).
+            GREEN           = Bit(6),   // Emphasize green (red on PAL/Dendy).
+            BLUE            = Bit(7)    // Emphasize blue.
+        };
+
+        enum
+        {
+            OAM_SIZE        = 256       // Bytes of OAM, 4 for each of the 64 sprites. An OAM DMA copies exactly this much.
+        };
+
         Ppu2C02(void);
         virtual ~Ppu2C02(void);
 
         virtual DataType Read(AddressType lAddress) override;
         virtual void     Write(AddressType lAddress, DataType lData)        override;
 
+        DataType         CpuRead(AddressType lAddress);
+        void             CpuWrite(AddressType lAddress, DataType lData);
+        void             OamDma(const uint8_t * lData);
+
+        void             Reset(void);
+        void             Clock(void);
+        void             ConnectCartridge(Cartridge * lCartridge);
+        void             SetMirroring(Mirroring lMirroring);
+        void             SetPatternPage(uint8_t lPage, uint8_t * lData, uint32_t lChrOffset);
+        void             SetRenderMode(RenderMode lMode);
+        RenderMode       GetRenderMode(void)                      {return mRenderMode;}
+        void             SetTimingOnly(bool lTimingOnly)          {mTimingOnly = lTimingOnly;}
+        void             SetRenderThreads(int lThreads);
+        int              GetRenderThreads(void)                   {return mRenderPool.GetThreads();}
+        bool             IsTimingOnly(void)                       {return mTimingOnly;}
+
+        int16_t          GetScanline(void)                        {return mScanline;}
+        int16_t          GetDot(void)                             {return mDot;}
+        bool             IsFrameComplete(void)                    {return mFrameComplete;}
+        void             ClearFrameComplete(void)                 {mFrameComplete = false;}
+        bool             PollNmi(void);
+        const uint8_t *  GetFrameBuffer(void)                     {return &mFrameBuffer[0][0];}
+        const uint8_t *  GetLineMasks(void)                       {return mLineMask;}
+        uint16_t         GetLoggedWriteCount(void)                {return mWriteCount;}
+        bool             IsFrameReused(void)                      {return mFrameReused;}
+        uint64_t         GetFrameHash(void);
+
     protected:
 
         //
@@ -94,18 +195,6 @@ class Ppu2C02 : public Device
             NMI             = Bit(7)        // Generate NMI at start of vertical blanking interval (0: off; 1: on).
         };
 
-        enum PpuMaskBits
-        {
-            GREYSCALE       = Bit(0),   // Greyscale (0: normal color, 1: produce a greyscale display).
-            LEFT_BCKGRND    = Bit(1),   // 1: Show background in leftmost 8 pixels of screen, 0: Hide.
-            LEFT_SPRITES    = Bit(2),   // 1: Show sprites in leftmost 8 pixels of screen, 0: Hide.
-            SHOW_BCKGND     = Bit(3),   // Show background.
-            SHOW_SPRITES    = Bit(4),   // Show sprites.
-            RED             = Bit(5),   // Emphasize red (green on PAL/Dendy).
-            GREEN           = Bit(6),   // Emphasize green (red on PAL/Dendy).
-            BLUE            = Bit(7)    // Emphasize blue.
-        };
-
         enum PpuStatusBits
         {
             OPEN_BUS        = BitMask(5),   // PPU open bus. Returns stale PPU bus contents.
@@ -119,35 +208,62 @@ class Ppu2C02 : public Device
                                             //      post-render line); cleared after reading $2002 and at dot 1 of the pre-render line.
         };
 
-        PpuRegister<uint8_t> mRegisters[NUM_REGISTERS]; 
-        PpuRegister<uint8_t> mInternalRegisters[NUM_INTERNAL_REGISTERS];
+        // Layout of V and T while rendering, yyy NN YYYYY XXXXX.
+        // https://www.nesdev.org/wiki/PPU_scrolling#PPU_internal_registers
+        enum ScrollBits
+        {
+            COARSE_X        = BitMask(5),       // Tile column within the nametable.
+            COARSE_Y        = BitMask(5,5),     // Tile row within the nametable.
+            NAMETABLE_X     = Bit(10),          // Horizontal nametable select.
+            NAMETABLE_Y     = Bit(11),          // Vertical nametable select.
+            NAMETABLE_SEL   = BitMask(2,10),    // Both nametable select bits.
+            FINE_Y          = BitMask(3,12),    // Pixel row within the tile.
+            HORIZONTAL_BITS = COARSE_X | NAMETABLE_X,
+            VERTICAL_BITS   = COARSE_Y | NAMETABLE_Y | FINE_Y,
+            VRAM_ADDR_MASK  = BitMask(14)
+        };
+
+        PpuRegister<uint8_t>  mRegisters[NUM_REGISTERS]; 
+        PpuRegister<uint16_t> mInternalRegisters[NUM_INTERNAL_REGISTERS];
 
         // Name tables are used to layout the background frame. It's dynamic, meaning it could change every frame.
         // The system only has room for 2 physical name tables (VRAM) that are each 1KB in size, however the NES supports
-        // 4 logical name tables in total. The 3rd and 4th tables would be located on the cartridge. The index in mNameTable
-        // selects either the 1st or 2nd nametable. Each nametable subdivides their memory into "tiles", representing an 8x8 group
-        // of pixels. The address read from a specific mNameTable is used to index into a pattern table where the actual tiles are stored.
+        // 4 logical name tables in total. The 3rd and 4th tables would be located on the cartridge, they're kept here in mVram
+        // as well for four screen carts. mNameTableSlots points each logical table at its physical one based on the mirroring.
+        // Each nametable subdivides their memory into "tiles", representing an 8x8 group
+        // of pixels. The address read from a name table is used to index into a pattern table where the actual tiles are stored.
         // A name table is made of 32x30 tiles for 960 bytes. The remaning 64 bytes are used for the attribute table. This table is how we know which
         // palette (group of 4 colors) to use for a tile. To further complicate things, the screen is also subdived into "blocks", or a 2x2 grid of tiles.
         // The coordinates of the block (from top left of screen down to bottom right) is the index into the attribute table. Each byte represents a block
         // where every 2-bits in that byte is which palette that block is using.
         enum Nametable
         {
-            NUM_NAME_TABLES = 2,
-            NAME_TABLE_SIZE = 1024
+            NUM_NAME_TABLES     = 4,
+            NAME_TABLE_SIZE     = 1024,
+            NAME_TABLE_MASK     = NAME_TABLE_SIZE - 1
         };
-        MemoryRam mNameTable[NUM_NAME_TABLES];
+        uint8_t   mVram[NUM_NAME_TABLES][NAME_TABLE_SIZE];
+        uint8_t * mNameTableSlots[NUM_NAME_TABLES];
 
         // Pattern tables contain the shape of tiles that make up backgrounds and sprites. The two pattern tables are used together
         // to index into a palette for a specific color, and are typically referred as "left" (first pattern table) and "right"
         // (second pattern table). Each tile takes up 16-bytes, 8 from the left and 8 right pattern tables. A pattern table is static memory.
         // Each bit is added from the two tables to index (0-3) into a specific palette, which is known from the attribute table.
+        // They live in CHR memory on the cartridge, the mapper decides which bank shows up in each 1KB page.
         enum PatternTable
         {
             NUM_PATTERN_TABLES = 2,
             PATTERN_TABLE_SIZE = 4096
         };
-        MemoryRom mPatternTable[NUM_PATTERN_TABLES];
+
+        // The whole $0000-$3FFF ppu address space is split into 1KB pages, each pointing straight at the memory behind it.
+        // Pages 0-7 are the pattern tables in CHR memory, set by the cartridge whenever its mapper switches banks. Pages 8-11
+        // are the name table slots and 12-15 mirror them. Palette RAM at the end of page 15 is handled before the page lookup.
+        // The CHR offset of each pattern page is kept too so the renderer can find the page's tiles in the tile cache.
+        uint8_t * mPages[NUM_PPU_PAGES];
+        uint32_t  mChrPageOffset[NUM_PATTERN_PAGES];
+
+        static uint8_t cEmptyPage[PPU_PAGE_SIZE];   // Reads back 0 for pattern pages with nothing behind them.
 
         // Internal memory inside the PPU containing 64 sprites (4 bytes to describe information about each sprite).
         struct ObjectAttributeMemory
@@ -184,6 +300,237 @@ class Ppu2C02 : public Device
         // this memory is cleared, and a linear search of the primary OAM is performed to find sprites within Y range of next scanline (the sprite evaluation phase https://www.nesdev.org/wiki/PPU_sprite_evaluation),
         // and copied to this memory. These are sprites to be rendered in the next scanline.
         ObjectAttributeMemory mSecondaryOam[ObjectAttributeMemory::NUM_SECONDARY_SPRITES];
+
+        // Palette RAM, 32 entries of 6-bit colors. $3F10/$3F14/$3F18/$3F1C are mirrors of $3F00/$3F04/$3F08/$3F0C.
+        enum Palette
+        {
+            PALETTE_START   = 0x3F00,
+            PALETTE_SIZE    = 32,
+            PALETTE_MASK    = PALETTE_SIZE - 1,
+            COLOR_MASK      = BitMask(6)
+        };
+        uint8_t mPalette[PALETTE_SIZE];
+
+        static const uint8_t cPaletteIndex[PALETTE_SIZE];   // Index into mPalette of every palette address, mirrors resolved.
+
+        enum PpuMemoryMap
+        {
+            PATTERN_TABLE_END   = 0x1FFF,
+            NAME_TABLE_START    = 0x2000,
+            NAME_TABLE_END      = 0x3EFF,
+            ATTRIBUTE_OFFSET    = 0x03C0,
+            PPU_ADDRESS_MASK    = 0x3FFF
+        };
+
+        //
+        // FETCH PRIMITIVES
+        //
+        // Shared by both renderers so they are guaranteed to see memory the same way.
+        //
+
+        // One row of a sprite ready to be drawn, already flipped and pulled from the pattern table.
+        // The dot renderer shifts out the bitplanes, the scanline renderer uses the decoded pixels.
+        struct SpriteRow
+        {
+            uint8_t         mLow;           // Low bitplane, leftmost pixel in bit 7.
+            uint8_t         mHigh;          // High bitplane, leftmost pixel in bit 7.
+            const uint8_t * mPixels;        // Decoded pixels (0-3) from the CHR tile cache, leftmost first.
+            uint8_t         mAttribute;     // Attribute byte of the sprite.
+            uint8_t         mXPos;          // Left edge of the sprite.
+        };
+
+        DataType FetchNametableByte(uint16_t lVramAddress);
+        DataType FetchAttributeBits(uint16_t lVramAddress);
+        void     FetchPatternRow(AddressType lTableBase, uint8_t lTile, uint8_t lRow, uint8_t * lLow, uint8_t * lHigh);
+        const uint8_t * FetchTileRow(AddressType lTableBase, uint8_t lTile, uint8_t lRow, bool lFlip);
+        void     EvaluateSprites(int lScanline);
+        void     FetchSpriteRows(int lScanline);
+        void     FetchSpriteRows(int lScanline, const ObjectAttributeMemory * lSprites, uint8_t lCount, uint8_t lControl, bool lDecoded,
+                                 SpriteRow * lRows);
+        uint8_t  ComposePixel(int lX, uint8_t lBgPixel, uint8_t lBgPalette, uint8_t lSpritePixel, uint8_t lSpriteAttribute, bool lSpriteZero);
+
+        void     IncrementScrollX(void);
+        void     IncrementScrollY(void);
+        static uint16_t IncrementScrollY(uint16_t lV);
+        void     TransferAddressX(void);
+        void     TransferAddressY(void);
+        bool     IsRenderingEnabled(void) {return (mRegisters[PPUMASK].Read() & (SHOW_BCKGND | SHOW_SPRITES)) != 0;}
+
+        //
+        // RENDERERS
+        //
+
+        // What a scanline is drawn from. Taken from the registers for the live renderers, rebuilt
+        // from the register log when a frame is drawn after the fact.
+        struct LineState
+        {
+            uint16_t mV;
+            uint16_t mT;
+            uint8_t  mX;
+            uint8_t  mControl;      // PPUCTRL.
+            uint8_t  mMask;         // PPUMASK.
+        };
+
+        void     RenderScanline(void);
+        void     RenderLine(int lScanline, const LineState & lState, uint8_t * lOut, int16_t * lSpriteZeroHitDot);
+        uint8_t  GatherSprites(int lScanline, uint8_t lControl, SpriteRow * lRows, bool * lSpriteZero);
+        void     BuildLineStates(void);
+        void     RenderFrame(void);
+        void     RenderLines(int lFirst, int lLast);
+        void     FinishFrame(void);
+        bool     SameLineStates(void);
+        void     TimeScanline(void);
+        void     ClockDotRenderer(void);
+        void     LoadBackgroundShifters(void);
+        void     UpdateShifters(void);
+        void     UpdateA12RiseDot(void);
+
+        Cartridge * mCartridge;
+        RenderMode  mRenderMode;
+        bool        mTimingOnly;            // Skip the pixels, only keep the status flags and scroll timing. Meant to be switched between frames.
+        int16_t     mScanline;              // Current scanline, 0-239 visible, 240 post-render, 241-260 vblank, 261 pre-render.
+        int16_t     mDot;                   // Current dot (cycle) within the scanline, 0-340.
+        bool        mOddFrame;              // Odd frames skip the last dot of the pre-render line when rendering.
+        bool        mFrameComplete;         // Set when the last dot of the frame has been produced.
+        bool        mNmiOccurred;           // NMI edge waiting to be picked up by the system.
+        uint8_t     mDataBuffer;            // PPUDATA reads are delayed by one read, except for palette.
+        uint8_t     mOpenBus;               // Last value written to any ppu register, returned on write only registers.
+        int16_t     mSpriteZeroHitDot;      // Dot where the scanline renderer found a sprite 0 hit, -1 if none.
+        bool        mWatchA12;              // The cartridge counts scanlines by A12 rising.
+        int16_t     mA12RiseDot;            // Dot A12 rises on this line, -1 if it doesn't or no one is watching.
+
+        // Sprite evaluation results of every scanline, so evaluating a line is a lookup instead of a
+        // search through all of OAM. Only sprite Y positions and the sprite size decide which bucket a
+        // sprite lands in, so the index is rebuilt lazily when one of those changes.
+        enum SpriteIndex
+        {
+            NUM_INDEXED_SCANLINES = 256
+        };
+        struct SpriteBucket
+        {
+            uint8_t mCount;         // Sprites in range of the scanline, up to 8.
+            bool    mOverflow;      // Was a 9th sprite in range.
+            uint8_t mSprites[ObjectAttributeMemory::NUM_SECONDARY_SPRITES];   // OAM indices, lowest first.
+        };
+        SpriteBucket mSpriteBuckets[NUM_INDEXED_SCANLINES];
+        bool         mSpriteIndexDirty;
+
+        void     BuildSpriteIndex(void);
+
+        // Sprites found by sprite evaluation for the line being drawn.
+        uint8_t     mSpriteCount;
+        bool        mSpriteZeroOnLine;      // Is sprite 0 in the secondary OAM.
+        SpriteRow   mSpriteRows[ObjectAttributeMemory::NUM_SECONDARY_SPRITES];
+
+        // Dot renderer latches and shift registers. https://www.nesdev.org/wiki/PPU_rendering
+        uint8_t     mNextTileId;
+        uint8_t     mNextTileAttribute;
+        uint8_t     mNextTileLow;
+        uint8_t     mNextTileHigh;
+        uint16_t    mBgShifterPatternLow;
+        uint16_t    mBgShifterPatternHigh;
+        uint16_t    mBgShifterAttributeLow;
+        uint16_t    mBgShifterAttributeHigh;
+        uint8_t     mSpriteShifterLow[ObjectAttributeMemory::NUM_SECONDARY_SPRITES];
+        uint8_t     mSpriteShifterHigh[ObjectAttributeMemory::NUM_SECONDARY_SPRITES];
+        uint8_t     mSpriteCounter[ObjectAttributeMemory::NUM_SECONDARY_SPRITES];
+
+        // Each pixel is a 6-bit index into the system palette. Greyscale and color emphasis are left
+        // to the output stage, which gets the PPUMASK each line started with.
+        uint8_t     mFrameBuffer[SCREEN_HEIGHT][SCREEN_WIDTH];
+        uint8_t     mLineMask[SCREEN_HEIGHT];
+
+        //
+        // REGISTER LOG
+        //
+        // Every write to PPUCTRL, PPUMASK, PPUSCROLL and PPUADDR from the start of scanline 0 until vblank,
+        // stamped with the dot it landed before. Along with the registers the frame started with, that's
+        // enough to work out the scroll and control of every scanline after the frame is over. Writes to
+        // PPUDATA while rendering, palette changes and CHR bank switches partway through the frame are not
+        // in the log, the deferred renderer draws those with what's there at the end of the frame.
+        //
+
+        enum RegisterLog
+        {
+            MAX_LOGGED_WRITES = 8192    // More than the cpu has time to write during the visible scanlines.
+        };
+        struct LoggedWrite
+        {
+            int16_t mScanline;
+            int16_t mDot;
+            uint8_t mRegister;
+            uint8_t mData;
+            uint8_t mLatch;             // W when the write happened, so PPUSTATUS reads don't have to be logged.
+        };
+
+        void     LogWrite(uint8_t lRegister, uint8_t lData);
+        uint16_t ReplayWrites(LineState & lState, uint16_t lNext, int lScanline, int lDot);
+
+        LineState   mFrameStart;        // Registers as scanline 0 started.
+        LoggedWrite mWriteLog[MAX_LOGGED_WRITES];
+        uint16_t    mWriteCount;
+        bool        mLogging;           // Between the start of scanline 0 and vblank.
+
+        // The deferred renderer works out the state of every scanline from the log first, then the
+        // scanlines don't depend on each other and bands of them can be drawn on separate threads.
+        class RenderBand : public Functor
+        {
+            public:
+                RenderBand(void) : mPpu(nullptr), mFirst(0), mLast(0) {}
+                virtual void Execute(void) override {mPpu->RenderLines(mFirst, mLast);}
+
+                Ppu2C02 * mPpu;
+                int       mFirst;       // First scanline of the band.
+                int       mLast;        // One past the last scanline of the band.
+        };
+
+        LineState   mLineStates[SCREEN_HEIGHT];
+        WorkerPool  mRenderPool;
+        RenderBand  mBands[WorkerPool::MAX_THREADS];
+        Functor *   mBandJobs[WorkerPool::MAX_THREADS];
+
+        //
+        // STATIC SCREENS
+        //
+        // A frame drawn from the same memory with the same scanline states as the last one comes out
+        // the same, so it doesn't have to be drawn or handed on again. Writes that actually change the
+        // name tables, palette, OAM or CHR, bank and mirroring changes, and PPUDATA accesses while
+        // rendering mark the frame dirty. The scanline states are compared at vblank.
+        //
+
+        LineState   mLastLineStates[SCREEN_HEIGHT];    // Scanline states of the last frame drawn.
+        bool        mFrameDirty;        // Memory the frame is drawn from changed since the last frame drawn.
+        bool        mFrameDrawn;        // There is a last frame drawn to compare against.
+        bool        mFrameReused;       // The frame that just finished is the same as the last one.
+
+        //
+        // PIPELINE
+        //
+        // The pipelined renderer draws on a second ppu that never runs, it only holds a copy of what a frame is
+        // drawn from. At vblank it's handed the name tables, palette, OAM and scanline states of the frame that just
+        // finished, and draws them on its own thread while this one carries on with the timing of the next frame.
+        // CHR isn't copied. ROM never changes, and a write to CHR RAM waits for the drawing to finish first.
+        //
+
+        class RenderJob : public Functor
+        {
+            public:
+                RenderJob(void) : mPpu(nullptr) {}
+                virtual void Execute(void) override {mPpu->RenderFrame();}
+
+                Ppu2C02 * mPpu;
+        };
+
+        bool     PipelineFrame(bool lReused);
+        void     CopyFrameTo(Ppu2C02 * lPpu);
+        void     StopPipeline(void);
+
+        Mirroring   mMirroring;
+        Ppu2C02 *   mPipelinePpu;       // Draws the frames, only there while pipelined.
+        WorkerPool  mPipeline;          // The one thread drawing on mPipelinePpu.
+        RenderJob   mPipelineJob;
+        Functor *   mPipelineJobs[1];
+        bool        mPipelineReused;    // Is the frame being drawn the same as the one before it.
 };
 
 #endif
@@ -0,0 +1,50 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// RateControl.hpp
+//
+// Keeps emulated audio in step with a sound device running on its own clock.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RATE_CONTROL_HPP
+#define RATE_CONTROL_HPP
+
+#include "Common.hpp"
+#include <stddef.h>
+
+//========//
+// RateControl
+//
+// Emulation is paced by the system clock and the sound device by its own crystal, so
+// the two never quite agree and the audio ring slowly fills up or runs dry. Once a frame
+// this looks at how full the ring is and nudges the resampler's output rate, a little
+// faster when the ring is below target and a little slower above it. The nudge is at
+// most cMaxAdjust either way, which no one can hear as a change in pitch.
+//
+// The fill is averaged over a few frames first, so the jitter of when each side runs
+// doesn't turn into wobble in the rate.
+//========//
+//
+class RateControl
+{
+    public:
+
+        static constexpr double cMaxAdjust = 0.005;     // Most the rate is nudged, as a fraction.
+        static constexpr double cSmoothing = 0.05;      // Weight of each new fill in the average.
+
+        RateControl(void);
+
+        void     SetTarget(size_t lTarget);
+        size_t   GetTarget(void)        {return mTarget;}
+        double   Update(size_t lFill);
+        double   GetAdjust(void)        {return mAdjust;}
+        double   GetAverageFill(void)   {return mAverage;}
+
+    protected:
+
+        size_t   mTarget;       // Fill the ring is kept near, in samples.
+        double   mAverage;      // Smoothed fill, in samples.
+        double   mAdjust;       // Factor on the output rate.
+};
+
+#endif
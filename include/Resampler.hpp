@@ -0,0 +1,96 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// Resampler.hpp
+//
+// Polyphase FIR sample rate conversion for the audio output.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RESAMPLER_HPP
+#define RESAMPLER_HPP
+
+#include "Common.hpp"
+#include "PixelKernels.hpp"
+
+//========//
+// Resampler
+//
+// Converts mono samples from one rate to another at any ratio. Every output sample is one
+// dot product of the input around it with a Kaiser windowed sinc, picked out of a table of
+// NUM_PHASES shifted copies by where the sample lands between two inputs. The dot product
+// has SSE2 and AVX2 versions, picked the same way as the pixel kernels.
+//
+// The filter passes everything below 20 kHz (or a bit less at low output rates) and stops
+// anything that would alias back down into it. Quality trades the filter's length, and so
+// its cost, against how well it does that.
+//
+// The ratio can be nudged by a small factor while running, which is how the output is kept
+// in step with a sound device whose clock doesn't quite match the emulated one.
+//========//
+//
+class Resampler
+{
+    public:
+
+        enum Quality
+        {
+            QUALITY_FAST = 0,   // 16 taps, about 50 dB of stopband.
+            QUALITY_NORMAL,     // 32 taps, about 70 dB.
+            QUALITY_HIGH,       // 64 taps, about 90 dB.
+
+            NUM_QUALITIES
+        };
+
+        enum
+        {
+            PHASE_BITS      = 9,
+            NUM_PHASES      = 1 << PHASE_BITS,  // Positions an output sample can land on between two inputs.
+            TIME_BITS       = 32,               // Fixed point of input positions.
+            MAX_TAPS        = 64,
+            BATCH_SIZE      = 4096,             // Input samples converted to float at a time.
+            PASSBAND_HZ     = 20000
+        };
+
+        // Most the ratio can be nudged either way.
+        static constexpr double cMaxRatioAdjust = 0.01;
+
+        Resampler(void);
+        ~Resampler(void);
+
+        bool     SetRates(double lInputRate, double lOutputRate, Quality lQuality = QUALITY_NORMAL);
+        void     SetRatioAdjust(double lAdjust);
+        double   GetRatioAdjust(void)  {return mAdjust;}
+        Quality  GetQuality(void)      {return mQuality;}
+        double   GetPassband(void)     {return mPassband;}
+        void     Clear(void);
+        int      GetMaxOutput(int lInputCount);
+        int      Process(const int16_t * lIn, int lInputCount, int16_t * lOut, int lOutputMax);
+
+        static int GetTaps(Quality lQuality);
+
+#ifdef TEST_APU
+        static bool SelfTest(void);
+#endif
+
+    protected:
+
+        // Sum of lCount products, lCount a multiple of 16.
+        typedef float (*DotFunction)(const float * lSamples, const float * lCoefficients, int lCount);
+
+        static DotFunction GetDot(PixelKernels::Level lLevel);
+        void               UpdateStep(void);
+
+        float *     mCoefficients;  // NUM_PHASES + 1 rows of mTaps, the extra one so rounding up a phase stays in the table.
+        float *     mHistory;       // Input not yet used up, as floats.
+        int         mHistoryCount;
+        int         mTaps;
+        uint64_t    mPosition;      // Input position of the next output, relative to mHistory, TIME_BITS fixed point.
+        uint64_t    mStep;          // Input samples per output sample, TIME_BITS fixed point.
+        double      mRatio;         // Input samples per output sample, before the adjustment.
+        double      mAdjust;
+        double      mPassband;      // Hz below which the response is flat.
+        Quality     mQuality;
+        DotFunction mDot;
+};
+
+#endif
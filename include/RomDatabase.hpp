@@ -0,0 +1,58 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// RomDatabase.hpp
+//
+// Known ROM images, to correct what their headers get wrong.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ROM_DATABASE_HPP
+#define ROM_DATABASE_HPP
+
+#include "Common.hpp"
+
+//========//
+// RomInfo
+//
+// What's known about one ROM image, looked up by the CRC-32 of its PRG ROM followed by
+// its CHR ROM, without the header. That's the same CRC the common NES databases list, so
+// entries can be copied over from them.
+//========//
+//
+struct RomInfo
+{
+    enum Flags
+    {
+        DOT_RENDERER    = Bit(0),   // Needs the dot accurate ppu renderer, for mid-scanline effects.
+        BATTERY         = Bit(1),   // PRG RAM is battery backed.
+        LIVE_RENDERER   = Bit(2)    // Switches CHR banks, mirroring or palette mid-frame, so it has to be drawn as the
+                                    //      frame runs. The deferred renderers only replay the ppu registers.
+    };
+
+    enum
+    {
+        MIRROR_HEADER   = 0xFF      // Mirroring from the header is right, or the mapper sets it.
+    };
+
+    uint32_t mCrc;          // CRC-32 of PRG ROM then CHR ROM.
+    uint8_t  mMapperId;     // Mapper the board really uses.
+    uint8_t  mMirroring;    // A Ppu2C02::Mirroring, or MIRROR_HEADER.
+    uint8_t  mPrgRamBanks;  // PRG RAM in 8KB units.
+    uint8_t  mFlags;        // Flags above.
+};
+
+//========//
+// RomDatabase
+//
+// The known images, built into the program in a table sorted by CRC so finding one is
+// a binary search.
+//========//
+//
+class RomDatabase
+{
+    public:
+
+        static const RomInfo * Find(uint32_t lCrc);
+};
+
+#endif
@@ -13,6 +13,9 @@
 #include "Cpu6502.hpp"
 #include "Cartridge.hpp"
 #include "Ppu2C02.hpp"
+#include "Apu2A03.hpp"
+#include "FrameConverter.hpp"
+#include "TripleBuffer.hpp"
 
 //========//
 // System
@@ -35,6 +38,9 @@ class System
             PPU_REGISTER_RANGE      = 0x3FFF,
 
             APU_IO_REGISTER_START   = 0x4000,
+            OAM_DMA                 = 0x4014,
+            APU_STATUS              = 0x4015,
+            CONTROLLER_2            = 0x4017,   // Also the apu frame counter when written.
             APU_IO_REGISTER_SIZE    = 0x0018,
             APU_IO_FUNC_START       = 0x4018,
             APU_IO_FUNC_SIZE        = 0x0008,
@@ -44,18 +50,49 @@ class System
             CARTRIDGE_RANGE         = 0xFFFF,
         };
 
+        enum
+        {
+            CPU_CLOCK_DIVIDER       = 3,    // The ppu runs 3 dots for every cpu cycle.
+            OAM_DMA_CYCLES          = 513,  // Cpu cycles an OAM DMA takes, one more if it starts on an odd cycle.
+            PPU_TEST_WARMUP_FRAMES  = 10,   // Frames the ppu test lets the rom boot before comparing renderers.
+            PPU_TEST_FRAMES         = 60,   // Number of frames each renderer runs during the ppu test.
+            PPU_TEST_SPLIT_DOT      = 280,  // Dot in the horizontal blank the ppu test writes its splits on.
+            PPU_TEST_SCROLL_LINE    = 64,   // Line the ppu test changes the horizontal scroll on.
+            PPU_TEST_ADDRESS_LINE   = 128,  // Line the ppu test jumps to another name table on.
+            PPU_TEST_SPLIT_WRITES   = 4,    // Register writes the ppu test makes for its splits each frame.
+            PPU_TEST_THREADS        = 4,    // Threads the ppu test splits frames across.
+            APU_TEST_FRAME_IRQ      = 29829,    // Cpu cycles from a 4 step $4017 write to the frame IRQ.
+            APU_TEST_LENGTH_SILENT  = 149149,   // Cpu cycles from a $4017 write to the 10th half frame.
+            APU_TEST_TIMEOUT        = 200000,   // Cpu cycles the apu test waits for anything.
+            APU_TEST_WAV_FRAMES     = 30,       // Frames of audio the apu test records to a wav file.
+            APU_TEST_CHUNK          = 2048,     // Samples the apu test moves at a time.
+            APU_TEST_RING_SIZE      = 1024,     // Ring the apu test overruns and underruns, less than a chunk.
+            APU_TEST_WAIT_PERIODS   = 100       // Sink periods the apu test waits for the ring to run dry.
+        };
+
         System(void);
         ~System(void);
 
         bool     Clock(void);
+        void     RunFrame(bool lRender = true);
+        void     Reset(void);
         DataType Read(AddressType lAddress);
         void     Write(AddressType lAddress, DataType lData);
 
+        void           SetOutputFormat(FrameConverter::PixelFormat lFormat, int lThreads = 1);
+        TripleBuffer & GetOutputFrames(void) {return mOutputFrames;}
+        uint64_t       GetReusedFrameCount(void) {return mReusedFrames;}
+        uint64_t       GetCpuCycles(void) {return mCpuCycles;}
+
         void     InsertCartridge(Cartridge * lCartridge);
         void     RemoveCartridge(void);
         void     LoadMemory(char * lProgram, AddressType lSize, AddressType lOffset);
+        void     OamDma(DataType lPage);
 
         bool     CpuTest(void);
+        bool     PpuTest(void);
+        bool     ApuTest(void);
+        bool     MapperTest(void);
 
         // If some devices are not connected, this variable
         // simulates "open bus behavior". Where a read of
@@ -66,14 +103,23 @@ class System
 
         Cpu6502   mCpu;
         Ppu2C02   mPpu;
+        Apu2A03   mApu;
         MemoryRam mRam;
 
     private:
 
+#ifdef TEST_PPU
+        void     RunSplitFrame(void);
+#endif
         void     DumpMemoryAsHex(const char * lFilename);
         void     DumpMemoryAsRaw(const char * lFilename);
 
-        Cartridge * mCartridge;
+        Cartridge *    mCartridge;
+        uint8_t        mClockCounter;  // Dots since the last cpu cycle.
+        uint64_t       mCpuCycles;     // Cpu cycles since power on, the apu's time base.
+        FrameConverter mConverter;     // Turns finished frames into displayable pixels.
+        TripleBuffer   mOutputFrames;  // Converted frames handed to the presentation thread, empty while the output stage is off.
+        uint64_t       mReusedFrames;  // Frames the ppu found unchanged, so they were never converted or published.
 };
 
 #ifdef TEST_CPU
@@ -0,0 +1,68 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// TripleBuffer.hpp
+//
+// Lock free hand off of finished frames from one thread to another.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef TRIPLE_BUFFER_HPP
+#define TRIPLE_BUFFER_HPP
+
+#include "Common.hpp"
+#include <stddef.h>
+#include <atomic>
+
+//========//
+// TripleBuffer
+//
+// Three frame buffers shared by one producer and one consumer. The producer always owns
+// the back buffer and the consumer the front buffer, the third sits in the middle. Publishing
+// swaps the back buffer with the middle one and marks it fresh. Acquiring swaps the front
+// buffer with the middle one only if it's fresh. Both swaps are a single atomic exchange, so
+// neither side ever locks or waits on the other. A frame published over a fresh one was never
+// seen and counts as dropped, acquiring with nothing fresh shows the last frame again and
+// counts as repeated.
+//========//
+//
+class TripleBuffer
+{
+    public:
+
+        enum
+        {
+            NUM_BUFFERS = 3,
+            INDEX_MASK  = BitMask(2),   // Which buffer is in the middle.
+            FRESH       = Bit(2)        // The middle buffer holds a frame the consumer hasn't seen.
+        };
+
+        TripleBuffer(void);
+        ~TripleBuffer(void);
+
+        bool         Resize(size_t lSize);
+        size_t       GetSize(void)            {return mSize;}
+
+        // Producer side.
+        void *       GetBackBuffer(void)      {return mBuffers[mBack];}
+        void         Publish(void);
+
+        // Consumer side.
+        const void * Acquire(bool * lNewFrame = nullptr);
+
+        uint64_t     GetPublishedCount(void)  {return mPublished.load(std::memory_order_relaxed);}
+        uint64_t     GetDroppedCount(void)    {return mDropped.load(std::memory_order_relaxed);}
+        uint64_t     GetRepeatedCount(void)   {return mRepeated.load(std::memory_order_relaxed);}
+
+    protected:
+
+        uint8_t *             mBuffers[NUM_BUFFERS];
+        size_t                mSize;
+        uint8_t               mBack;        // Only touched by the producer.
+        uint8_t               mFront;       // Only touched by the consumer.
+        std::atomic<uint8_t>  mMiddle;      // Index of the middle buffer plus the FRESH flag.
+        std::atomic<uint64_t> mPublished;
+        std::atomic<uint64_t> mDropped;
+        std::atomic<uint64_t> mRepeated;
+};
+
+#endif
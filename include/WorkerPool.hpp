@@ -0,0 +1,64 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// WorkerPool.hpp
+//
+// Long running threads that split up a batch of jobs.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef WORKER_POOL_HPP
+#define WORKER_POOL_HPP
+
+#include "Common.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+//========//
+// WorkerPool
+//
+// A fixed set of threads that sleep until handed a batch of jobs. The thread handing
+// over the batch works through it too, and only returns once every job is done. Threads
+// are started once up front, so a batch costs a wake up instead of a thread spawn, which
+// matters when there is a batch every frame. A batch can also be started without the
+// caller joining in, and waited on later.
+//========//
+//
+class WorkerPool
+{
+    public:
+
+        enum
+        {
+            MAX_THREADS = 16
+        };
+
+        WorkerPool(void);
+        ~WorkerPool(void);
+
+        void SetThreads(int lThreads);
+        int  GetThreads(void)           {return mNumWorkers + 1;}
+        void Run(Functor * const * lJobs, int lNumJobs);
+        void Start(Functor * const * lJobs, int lNumJobs);
+        void Wait(void);
+
+    protected:
+
+        void WorkerLoop(uint64_t lSeen);
+        void RunJobs(void);
+
+        std::thread             mWorkers[MAX_THREADS - 1];
+        int                     mNumWorkers;    // Threads besides the one calling Run.
+        std::mutex              mMutex;
+        std::condition_variable mWake;          // Workers wait here for the next batch.
+        std::condition_variable mDone;          // Run waits here for the workers to finish.
+        Functor * const *       mJobs;
+        int                     mNumJobs;
+        std::atomic<int>        mNextJob;       // Next job to hand out.
+        int                     mBusy;          // Workers still on the current batch.
+        uint64_t                mBatch;         // Bumped for every batch so workers can tell a new one arrived.
+        bool                    mStopping;
+};
+
+#endif
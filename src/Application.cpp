@@ -8,6 +8,8 @@
 
 #include <Application.hpp>
 #include <Logger/ApiLogger.hpp>
+#include <algorithm>
+#include <chrono>
 
 //--------//
 //
@@ -33,6 +35,18 @@ void Application::Start(const char * lFilename)
     {
         return;
     }
+    if (!mNes.PpuTest())
+    {
+        return;
+    }
+    if (!mNes.ApuTest())
+    {
+        return;
+    }
+    if (!mNes.MapperTest())
+    {
+        return;
+    }
 
     // Load the cartridge with the rom.
     Cartridge lCartridge(lFilename);
@@ -42,8 +56,24 @@ void Application::Start(const char * lFilename)
         return;
     }
 
-    // Load cartridge into the system.
+    // Load cartridge into the system and power it on.
     mNes.InsertCartridge(&lCartridge);
+    mNes.SetOutputFormat(FrameConverter::FORMAT_RGBA8888);
+
+#ifdef PIPELINED_RENDER
+    // With cores to spare, draw each frame on another thread while the next one runs. It
+    // draws with the CHR banks, mirroring and palette as they are at vblank, so it's only
+    // used when asked for, and only for games the cartridge says that's enough for. Any
+    // cores left over after that help draw the frame in bands.
+    unsigned int lCores = std::thread::hardware_concurrency();
+    if (lCartridge.AllowsDeferredRenderer() && lCores >= PIPELINE_MIN_CORES)
+    {
+        mNes.mPpu.SetRenderMode(Ppu2C02::PIPELINED_RENDERER);
+        mNes.mPpu.SetRenderThreads(std::min<int>(lCores - PIPELINE_MIN_CORES + 1, MAX_RENDER_THREADS));
+    }
+#endif
+    mNes.Reset();
+    OpenAudio();
 
     // Open the emulator window.
     mMainWindow = Window::Open();
@@ -69,13 +99,134 @@ void Application::Start(const char * lFilename)
 // The main procession loop of the application. This function does
 // not return unless the user closes the application or something
 // wrong has occured and the only resolution is to stop the program.
+//
+// Emulation runs on its own thread so a blocking buffer swap never
+// holds it up. This thread just shows the newest finished frame, at
+// whatever rate the display refreshes.
 //--------//
 //
 void Application::Loop(void)
 {
+    TripleBuffer & lFrames = mNes.GetOutputFrames();
+
+    if (mAudioSink)
+    {
+        mAudioSink->Start();
+    }
+    mEmulationThread = std::thread(&Application::EmulationLoop, this);
+
     while (!mMainWindow->ShouldClose() && mRunning)
     {
+        mMainWindow->DrawFrame(lFrames.Acquire(), Ppu2C02::SCREEN_WIDTH, Ppu2C02::SCREEN_HEIGHT);
         mMainWindow->OnUpdate();
-        //mNes.Clock();
+    }
+
+    mRunning = false;
+    mEmulationThread.join();
+    if (mAudioSink)
+    {
+        mAudioSink->Stop();
+    }
+
+#ifdef USE_LOGGER
+    char lBuffer[160];
+    snprintf(lBuffer, sizeof(lBuffer), "[i] Frames published %llu, dropped %llu, repeated %llu, reused %llu\n",
+             static_cast<unsigned long long>(lFrames.GetPublishedCount()),
+             static_cast<unsigned long long>(lFrames.GetDroppedCount()),
+             static_cast<unsigned long long>(lFrames.GetRepeatedCount()),
+             static_cast<unsigned long long>(mNes.GetReusedFrameCount()));
+    ApiLogger::Log(lBuffer);
+    snprintf(lBuffer, sizeof(lBuffer), "[i] Audio underruns %llu, overruns %llu, rate adjust %+.3f%%\n",
+             static_cast<unsigned long long>(mAudioRing.GetUnderrunCount()),
+             static_cast<unsigned long long>(mAudioRing.GetOverrunCount()),
+             (mRateControl.GetAdjust() - 1.0) * 100.0);
+    ApiLogger::Log(lBuffer);
+#endif
+}
+
+//--------//
+// EmulationLoop
+//
+// Runs the system one frame at a time at the NTSC frame rate, publishing
+// every frame and its audio. Never waits on the presentation side or the sink.
+//
+// The rate comes from the steady clock alone. Most of each wait is a sleep,
+// but sleeps wake late, so the last SPIN_NS of it is spent yielding instead.
+//--------//
+//
+void Application::EmulationLoop(void)
+{
+    auto lDeadline = std::chrono::steady_clock::now();
+    auto lSpin     = std::chrono::nanoseconds(SPIN_NS);
+
+    while (mRunning)
+    {
+        mNes.RunFrame();
+        PushAudio();
+
+        // If we fell more than a frame behind, don't try to catch up.
+        lDeadline += std::chrono::nanoseconds(FRAME_PERIOD_NS);
+        if (std::chrono::steady_clock::now() > lDeadline + std::chrono::nanoseconds(FRAME_PERIOD_NS))
+        {
+            lDeadline = std::chrono::steady_clock::now();
+        }
+        std::this_thread::sleep_until(lDeadline - lSpin);
+        while (std::chrono::steady_clock::now() < lDeadline)
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+//--------//
+// OpenAudio
+//
+// Sets the apu to the output rate and opens the sound device. Without one, audio goes
+// to the null sink, so timing and the ring's counters behave the same either way. The
+// sink waits for the ring to reach the target before it starts, and rate control keeps
+// it there.
+//--------//
+//
+void Application::OpenAudio(void)
+{
+    mNes.mApu.SetSampleRate(AUDIO_SAMPLE_RATE);
+    mAudioRing.Resize(AUDIO_SAMPLE_RATE * AUDIO_RING_MS / 1000);
+
+    mAudioSink = AudioSink::Open(AudioSink::DEVICE_SINK, &mAudioRing, AUDIO_SAMPLE_RATE);
+    if (nullptr == mAudioSink || mAudioSink->GetStatus() != ErrorCodes::SUCCESS)
+    {
+        CAPTURE_LOG("[i] No sound device, audio is off\n");
+        delete mAudioSink;
+        mAudioSink = AudioSink::Open(AudioSink::NULL_SINK, &mAudioRing, AUDIO_SAMPLE_RATE);
+    }
+
+    mRateControl.SetTarget(AUDIO_SAMPLE_RATE * AUDIO_TARGET_MS / 1000);
+    if (mAudioSink)
+    {
+        mAudioSink->SetStartFill(mRateControl.GetTarget());
+    }
+}
+
+//--------//
+// PushAudio
+//
+// Moves the samples the apu made for the last frame into the ring. If the sink has
+// fallen behind, what doesn't fit is dropped rather than waited on. Then, going by how
+// full the ring is, sets how fast the apu makes samples for the next frame.
+//--------//
+//
+void Application::PushAudio(void)
+{
+    int16_t lSamples[AUDIO_CHUNK];
+    int     lCount;
+
+    while ((lCount = mNes.mApu.ReadSamples(lSamples, AUDIO_CHUNK)) > 0)
+    {
+        mAudioRing.Write(lSamples, lCount);
+    }
+
+    if (mAudioSink)
+    {
+        mNes.mApu.SetRateAdjust(mRateControl.Update(mAudioRing.GetFill()));
     }
 }
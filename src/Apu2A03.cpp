@@ -0,0 +1,1140 @@
+/////////////////////////////////////////////////////////////////////
+//
+// Apu2A03.cpp
+//
+// Implementation file for the apu.
+//
+/////////////////////////////////////////////////////////////////////
+
+#include <System.hpp>
+#include <Mappers/ExpansionAudio.hpp>
+
+//--------//
+// SkipTicks
+//
+// Moves a channel timer past a point in time without clocking the channel.
+//
+// param[in,out] lNext     Cpu cycle of the timer's next tick.
+// param[in]     lPeriod   Cpu cycles between ticks.
+// param[in]     lStop     Cpu cycle to move past.
+// returns  Number of ticks skipped.
+//--------//
+//
+static inline uint64_t SkipTicks(uint64_t & lNext, uint32_t lPeriod, uint64_t lStop)
+{
+    uint64_t lTicks;
+
+    if (lNext >= lStop)
+    {
+        return 0;
+    }
+    lTicks = (lStop - lNext + lPeriod - 1) / lPeriod;
+    lNext += lTicks * lPeriod;
+    return lTicks;
+}
+
+//--------//
+//
+// Apu2A03
+//
+//--------//
+
+// https://www.nesdev.org/wiki/APU_Length_Counter
+const uint8_t Apu2A03::cLengths[32] =
+{
+    10, 254, 20,  2, 40,  4, 80,  6, 160,  8, 60, 10, 14, 12, 26, 14,
+    12,  16, 24, 18, 48, 20, 96, 22, 192, 24, 72, 26, 16, 28, 32, 30
+};
+
+const uint8_t Apu2A03::cDuties[4][8] =
+{
+    {0, 1, 0, 0, 0, 0, 0, 0},   // 12.5%
+    {0, 1, 1, 0, 0, 0, 0, 0},   // 25%
+    {0, 1, 1, 1, 1, 0, 0, 0},   // 50%
+    {1, 0, 0, 1, 1, 1, 1, 1}    // 25% negated
+};
+
+const uint8_t Apu2A03::cTriangle[32] =
+{
+    15, 14, 13, 12, 11, 10,  9,  8,  7,  6,  5,  4,  3,  2,  1,  0,
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15
+};
+
+// NTSC periods in cpu cycles.
+const uint16_t Apu2A03::cNoisePeriods[16] =
+{
+    4, 8, 16, 32, 64, 96, 128, 160, 202, 254, 380, 508, 762, 1016, 2034, 4068
+};
+
+const uint16_t Apu2A03::cDmcRates[16] =
+{
+    428, 380, 340, 320, 286, 254, 226, 214, 190, 160, 142, 128, 106, 84, 72, 54
+};
+
+// Cpu cycles from the start of the sequence to each step, in 4 step and 5 step mode. The 5 step
+// mode's fourth step does nothing and is left out. https://www.nesdev.org/wiki/APU_Frame_Counter
+const uint32_t Apu2A03::cFrameSteps[2][4] =
+{
+    {7457, 14913, 22371, 29829},
+    {7457, 14913, 22371, 37281}
+};
+
+const uint32_t Apu2A03::cFramePeriods[2] = {29830, 37282};
+
+//--------//
+// Apu2A03
+//
+// Constructor.
+//--------//
+//
+Apu2A03::Apu2A03(void)
+  : mTime(0),
+    mExpansion(nullptr),
+    mInternal(nullptr),
+    mInternalSize(0),
+    mSamples(nullptr),
+    mSampleCount(0),
+    mMaxSamples(0),
+    mSampleRate(0)
+{
+    mPulseMix[0] = 0;
+    for (int lIndex = 1; lIndex < 31; ++lIndex)
+    {
+        mPulseMix[lIndex] = static_cast<int32_t>(95.52 / (8128.0 / lIndex + 100.0) * OUTPUT_SCALE);
+    }
+    mTndMix[0] = 0;
+    for (int lIndex = 1; lIndex < 203; ++lIndex)
+    {
+        mTndMix[lIndex] = static_cast<int32_t>(163.67 / (24329.0 / lIndex + 100.0) * OUTPUT_SCALE);
+    }
+
+    // The blip buffer's rate never changes, the resampler takes care of the output rate.
+    mInternalSize = INTERNAL_SAMPLE_RATE * MAX_BUFFERED_MS / 1000;
+    mInternal     = new(std::nothrow) int16_t[mInternalSize];
+    if (nullptr == mInternal)
+    {
+        mInternalSize = 0;
+        gErrorManager.Post(ErrorCodes::OUT_OF_MEMORY);
+    }
+    mOutput.SetRates(CPU_CLOCK_RATE, INTERNAL_SAMPLE_RATE, mInternalSize);
+
+    SetSampleRate(DEFAULT_SAMPLE_RATE);
+    Reset();
+}
+
+//--------//
+// ~Apu2A03
+//
+// Destructor.
+//--------//
+//
+Apu2A03::~Apu2A03(void)
+{
+    delete [] mInternal;
+    delete [] mSamples;
+}
+
+//--------//
+// Reset
+//
+// Puts the apu back into its power up state, silent with the frame counter in 4 step mode.
+//--------//
+//
+void Apu2A03::Reset(void)
+{
+    uint64_t lNow = GetCpuCycle();
+
+    memset(mPulse, 0, sizeof(mPulse));
+    memset(&mTriangle, 0, sizeof(mTriangle));
+    memset(&mNoise, 0, sizeof(mNoise));
+    memset(&mDmc, 0, sizeof(mDmc));
+    mPulse[0].mOnesComplement = 1;
+    mNoise.mShift             = 1;
+    mDmc.mBufferEmpty         = true;
+    mDmc.mSilence             = true;
+    mDmc.mBitsLeft            = 8;
+    mDmc.mSampleAddress       = 0xC000;
+    mDmc.mSampleLength        = 1;
+
+    mPulse[0].mNext   = lNow + mPulse[0].GetPeriod();
+    mPulse[1].mNext   = lNow + mPulse[1].GetPeriod();
+    mTriangle.mNext   = lNow + mTriangle.GetPeriod();
+    mNoise.mNext      = lNow + mNoise.GetPeriod();
+    mDmc.mNext        = lNow + mDmc.GetPeriod();
+
+    mTime              = lNow;
+    mFrameCounterStart = lNow;
+    mFrameStep         = 0;
+    mFiveStep          = false;
+    mIrqInhibit        = false;
+    mFrameIrq          = false;
+    mDmcIrq            = false;
+    mFrameStart        = lNow;
+    mLastOutput        = 0;
+    mSampleCount       = 0;
+    mOutput.Clear();
+    mResampler.Clear();
+    if (mExpansion)
+    {
+        mExpansion->Reset(lNow);
+    }
+
+    UpdateIrq();
+    UpdateNextEvent();
+}
+
+//--------//
+// SetSampleRate
+//
+// Sets the rate samples come out at. Anything not read yet is thrown away.
+//
+// param[in]    lSampleRate     Samples per second.
+// param[in]    lQuality        Quality of the resampling to that rate.
+// returns  If the output buffers could be allocated.
+//--------//
+//
+bool Apu2A03::SetSampleRate(int lSampleRate, Resampler::Quality lQuality)
+{
+    delete [] mSamples;
+    mSamples     = nullptr;
+    mSampleCount = 0;
+    mMaxSamples  = 0;
+    mSampleRate  = lSampleRate;
+
+    if (!mResampler.SetRates(INTERNAL_SAMPLE_RATE, lSampleRate, lQuality))
+    {
+        return false;
+    }
+
+    mMaxSamples = lSampleRate * MAX_BUFFERED_MS / 1000;
+    mSamples    = new(std::nothrow) int16_t[mMaxSamples];
+    if (nullptr == mSamples)
+    {
+        mMaxSamples = 0;
+        gErrorManager.Post(ErrorCodes::OUT_OF_MEMORY);
+        return false;
+    }
+    return true;
+}
+
+//--------//
+// SetExpansion
+//
+// Sets the sound chip on the cartridge to run along with the apu, starting now and
+// silent. Called when a cartridge goes in, with nullptr for one without a chip.
+//
+// param[in]    lExpansion  The chip, or nullptr for none.
+//--------//
+//
+void Apu2A03::SetExpansion(ExpansionAudio * lExpansion)
+{
+    Sync();
+    if (mExpansion)
+    {
+        // Whatever the old chip left in the mix goes with it.
+        AddExpansionDelta(mTime, -mExpansion->GetOutput());
+        mExpansion->Connect(nullptr);
+    }
+
+    mExpansion = lExpansion;
+    if (mExpansion)
+    {
+        mExpansion->Connect(this);
+        mExpansion->Reset(mTime);
+    }
+}
+
+//--------//
+// AddExpansionDelta
+//
+// Adds a change in the cartridge sound chip's output to the mix.
+//
+// param[in]    lTime   Cpu cycle the change is on, no earlier than the start of the frame.
+// param[in]    lDelta  Change in output.
+//--------//
+//
+void Apu2A03::AddExpansionDelta(uint64_t lTime, int32_t lDelta)
+{
+    mOutput.AddDelta(static_cast<uint32_t>(lTime - mFrameStart), lDelta);
+}
+
+//--------//
+// ReadSamples
+//
+// Reads out samples at the sample rate, oldest first.
+//
+// param[out]   lOut    Where the samples go.
+// param[in]    lCount  Most samples to read.
+// returns  Number of samples read.
+//--------//
+//
+int Apu2A03::ReadSamples(int16_t * lOut, int lCount)
+{
+    lCount = (lCount < mSampleCount) ? lCount : mSampleCount;
+    if (lCount <= 0)
+    {
+        return 0;
+    }
+
+    memcpy(lOut, mSamples, lCount * sizeof(mSamples[0]));
+    memmove(mSamples, mSamples + lCount, (mSampleCount - lCount) * sizeof(mSamples[0]));
+    mSampleCount -= lCount;
+    return lCount;
+}
+
+//--------//
+// Read
+//
+// Reads an apu register. Only STATUS can be read, which also acknowledges the frame IRQ.
+//
+// param[in] lAddress   Register, as an offset from $4000.
+// returns  The register's value.
+//--------//
+//
+DataType Apu2A03::Read(AddressType lAddress)
+{
+    DataType lStatus = 0;
+
+    if (lAddress != STATUS)
+    {
+        return 0;
+    }
+
+    Sync();
+    lStatus |= mPulse[0].mLength ? PULSE_1_ON  : 0;
+    lStatus |= mPulse[1].mLength ? PULSE_2_ON  : 0;
+    lStatus |= mTriangle.mLength ? TRIANGLE_ON : 0;
+    lStatus |= mNoise.mLength    ? NOISE_ON    : 0;
+    lStatus |= mDmc.mBytesLeft   ? DMC_ON      : 0;
+    lStatus |= mFrameIrq         ? FRAME_IRQ   : 0;
+    lStatus |= mDmcIrq           ? DMC_IRQ     : 0;
+
+    mFrameIrq = false;
+    UpdateIrq();
+    return lStatus;
+}
+
+//--------//
+// Write
+//
+// Writes an apu register, after catching up to the cpu so the write lands on the right cycle.
+//
+// param[in] lAddress   Register, as an offset from $4000.
+// param[in] lData      Data to write.
+//--------//
+//
+void Apu2A03::Write(AddressType lAddress, DataType lData)
+{
+    Sync();
+
+    if (lAddress < PULSE_2_CONTROL)
+    {
+        mPulse[0].Write(lAddress & 0x03, lData);
+    }
+    else if (lAddress < TRIANGLE_CONTROL)
+    {
+        mPulse[1].Write(lAddress & 0x03, lData);
+    }
+    else if (lAddress < NOISE_CONTROL)
+    {
+        mTriangle.Write(lAddress, lData);
+    }
+    else if (lAddress < DMC_CONTROL)
+    {
+        mNoise.Write(lAddress, lData);
+    }
+    else if (lAddress <= DMC_LENGTH)
+    {
+        mDmc.Write(lAddress, lData);
+        if (!mDmc.mIrqEnabled)
+        {
+            mDmcIrq = false;
+            UpdateIrq();
+        }
+    }
+    else if (lAddress == STATUS)
+    {
+        mPulse[0].mEnabled = (lData & PULSE_1_ON)  != 0;
+        mPulse[1].mEnabled = (lData & PULSE_2_ON)  != 0;
+        mTriangle.mEnabled = (lData & TRIANGLE_ON) != 0;
+        mNoise.mEnabled    = (lData & NOISE_ON)    != 0;
+        mPulse[0].mLength  = mPulse[0].mEnabled ? mPulse[0].mLength : 0;
+        mPulse[1].mLength  = mPulse[1].mEnabled ? mPulse[1].mLength : 0;
+        mTriangle.mLength  = mTriangle.mEnabled ? mTriangle.mLength : 0;
+        mNoise.mLength     = mNoise.mEnabled    ? mNoise.mLength    : 0;
+
+        // Starting the DMC with nothing left restarts the sample, the first byte is fetched right away.
+        if (lData & DMC_ON)
+        {
+            if (mDmc.mBytesLeft == 0)
+            {
+                mDmc.Restart();
+            }
+            FetchDmcSample();
+        }
+        else
+        {
+            mDmc.mBytesLeft = 0;
+        }
+        mDmcIrq = false;
+        UpdateIrq();
+    }
+    else if (lAddress == FRAME_COUNTER)
+    {
+        mFiveStep   = (lData & FIVE_STEP_MODE) != 0;
+        mIrqInhibit = (lData & IRQ_INHIBIT)    != 0;
+        if (mIrqInhibit)
+        {
+            mFrameIrq = false;
+            UpdateIrq();
+        }
+
+        // The sequence starts over, 5 step mode clocks everything straight away.
+        mFrameCounterStart = mTime;
+        mFrameStep         = 0;
+        if (mFiveStep)
+        {
+            ClockQuarterFrame();
+            ClockHalfFrame();
+        }
+    }
+
+    UpdateOutput(mTime);
+    UpdateNextEvent();
+}
+
+//--------//
+// Sync
+//
+// Catches the apu up to the cpu.
+//--------//
+//
+void Apu2A03::Sync(void)
+{
+    RunUntil(GetCpuCycle());
+}
+
+//--------//
+// EndFrame
+//
+// Catches up and closes the audio frame, then resamples it all in one batch to make its
+// samples available to read. If nothing has been reading, the oldest samples go.
+//--------//
+//
+void Apu2A03::EndFrame(void)
+{
+    int lCount;
+    int lDrop;
+
+    Sync();
+    mOutput.EndFrame(static_cast<uint32_t>(mTime - mFrameStart));
+    mFrameStart = mTime;
+
+    lCount = mOutput.ReadSamples(mInternal, mInternalSize);
+    lDrop  = mSampleCount + mResampler.GetMaxOutput(lCount) - mMaxSamples;
+    if (lDrop > 0)
+    {
+        lDrop = (lDrop < mSampleCount) ? lDrop : mSampleCount;
+        memmove(mSamples, mSamples + lDrop, (mSampleCount - lDrop) * sizeof(mSamples[0]));
+        mSampleCount -= lDrop;
+    }
+    mSampleCount += mResampler.Process(mInternal, lCount, mSamples + mSampleCount, mMaxSamples - mSampleCount);
+}
+
+//--------//
+// RunUntil
+//
+// Runs every channel up to a cpu cycle, stopping at each frame counter step on the way.
+//
+// param[in] lTime   Cpu cycle to run up to.
+//--------//
+//
+void Apu2A03::RunUntil(uint64_t lTime)
+{
+    uint64_t lStep;
+    uint64_t lStop;
+
+    while (mTime < lTime)
+    {
+        lStep = mFrameCounterStart + cFrameSteps[mFiveStep][mFrameStep];
+        lStop = (lStep < lTime) ? lStep : lTime;
+
+        RunChannels(lStop);
+        mTime = lStop;
+
+        if (mTime == lStep)
+        {
+            ClockFrameCounter();
+            UpdateOutput(mTime);
+        }
+    }
+    if (mExpansion)
+    {
+        mExpansion->RunUntil(mTime);
+    }
+    UpdateNextEvent();
+}
+
+//--------//
+// RunChannels
+//
+// Runs the channel timers up to a cpu cycle, in order of their ticks, with nothing but the
+// timers going on in between. Channels that can't make a sound until the next register
+// write or frame counter step skip straight past, keeping the phase of their timers.
+//
+// param[in] lStop   Cpu cycle to run up to, ticks on it are left for later.
+//--------//
+//
+void Apu2A03::RunChannels(uint64_t lStop)
+{
+    uint64_t lNext;
+    uint64_t lTicks;
+
+    for (int lIndex = 0; lIndex < 2; ++lIndex)
+    {
+        if (mPulse[lIndex].IsSilent())
+        {
+            lTicks               = SkipTicks(mPulse[lIndex].mNext, mPulse[lIndex].GetPeriod(), lStop);
+            mPulse[lIndex].mStep = (mPulse[lIndex].mStep + lTicks) & 0x07;
+        }
+    }
+    if (mTriangle.IsSilent())
+    {
+        SkipTicks(mTriangle.mNext, mTriangle.GetPeriod(), lStop);
+    }
+    if (mNoise.IsSilent())
+    {
+        SkipTicks(mNoise.mNext, mNoise.GetPeriod(), lStop);
+    }
+    if (mDmc.IsSilent())
+    {
+        lTicks         = SkipTicks(mDmc.mNext, mDmc.GetPeriod(), lStop) & 0x07;
+        mDmc.mBitsLeft = static_cast<uint8_t>((mDmc.mBitsLeft + 7 - lTicks) % 8 + 1);
+    }
+
+    for (;;)
+    {
+        lNext = mPulse[0].mNext;
+        lNext = (mPulse[1].mNext < lNext) ? mPulse[1].mNext : lNext;
+        lNext = (mTriangle.mNext < lNext) ? mTriangle.mNext : lNext;
+        lNext = (mNoise.mNext    < lNext) ? mNoise.mNext    : lNext;
+        lNext = (mDmc.mNext      < lNext) ? mDmc.mNext      : lNext;
+        if (lNext >= lStop)
+        {
+            break;
+        }
+
+        if (mPulse[0].mNext == lNext)
+        {
+            mPulse[0].Clock();
+        }
+        if (mPulse[1].mNext == lNext)
+        {
+            mPulse[1].Clock();
+        }
+        if (mTriangle.mNext == lNext)
+        {
+            mTriangle.Clock();
+        }
+        if (mNoise.mNext == lNext)
+        {
+            mNoise.Clock();
+        }
+        if (mDmc.mNext == lNext && mDmc.Clock())
+        {
+            FetchDmcSample();
+        }
+        UpdateOutput(lNext);
+    }
+}
+
+//--------//
+// ClockFrameCounter
+//
+// Runs the current step of the frame counter sequence and moves on to the next.
+//--------//
+//
+void Apu2A03::ClockFrameCounter(void)
+{
+    ClockQuarterFrame();
+    if (mFrameStep & 0x01)
+    {
+        ClockHalfFrame();
+    }
+
+    if (mFrameStep == 3)
+    {
+        if (!mFiveStep && !mIrqInhibit)
+        {
+            mFrameIrq = true;
+            UpdateIrq();
+        }
+        mFrameCounterStart += cFramePeriods[mFiveStep];
+        mFrameStep          = 0;
+    }
+    else
+    {
+        ++mFrameStep;
+    }
+}
+
+//--------//
+// ClockQuarterFrame
+//
+// Clocks the envelopes and the triangle's linear counter.
+//--------//
+//
+void Apu2A03::ClockQuarterFrame(void)
+{
+    mPulse[0].mEnvelope.Clock();
+    mPulse[1].mEnvelope.Clock();
+    mNoise.mEnvelope.Clock();
+    mTriangle.ClockLinear();
+}
+
+//--------//
+// ClockHalfFrame
+//
+// Clocks the length counters and sweeps.
+//--------//
+//
+void Apu2A03::ClockHalfFrame(void)
+{
+    for (int lIndex = 0; lIndex < 2; ++lIndex)
+    {
+        if (!mPulse[lIndex].mEnvelope.mLoop && mPulse[lIndex].mLength)
+        {
+            --mPulse[lIndex].mLength;
+        }
+        mPulse[lIndex].ClockSweep();
+    }
+    if (!mTriangle.mControl && mTriangle.mLength)
+    {
+        --mTriangle.mLength;
+    }
+    if (!mNoise.mEnvelope.mLoop && mNoise.mLength)
+    {
+        --mNoise.mLength;
+    }
+}
+
+//--------//
+// FetchDmcSample
+//
+// Fills the DMC's sample buffer from cpu memory if it's empty and there's sample left.
+// The cpu is held off while the byte is read.
+//--------//
+//
+void Apu2A03::FetchDmcSample(void)
+{
+    if (!mDmc.mBufferEmpty || mDmc.mBytesLeft == 0 || IsDisconnected())
+    {
+        return;
+    }
+
+    mDmc.mBuffer      = mSystem->Read(mDmc.mAddress);
+    mDmc.mBufferEmpty = false;
+    mSystem->mCpu.Stall(DMC_STALL_CYCLES);
+
+    mDmc.mAddress = (mDmc.mAddress == 0xFFFF) ? 0x8000 : mDmc.mAddress + 1;
+    if (--mDmc.mBytesLeft == 0)
+    {
+        if (mDmc.mLoop)
+        {
+            mDmc.Restart();
+        }
+        else if (mDmc.mIrqEnabled)
+        {
+            mDmcIrq = true;
+            UpdateIrq();
+        }
+    }
+}
+
+//--------//
+// UpdateOutput
+//
+// Mixes the channels and hands any change to the blip buffer.
+//
+// param[in] lTime   Cpu cycle the output is for.
+//--------//
+//
+void Apu2A03::UpdateOutput(uint64_t lTime)
+{
+    int32_t lOutput = mPulseMix[mPulse[0].GetOutput() + mPulse[1].GetOutput()] +
+                      mTndMix[3 * mTriangle.GetOutput() + 2 * mNoise.GetOutput() + mDmc.mLevel];
+
+    if (lOutput != mLastOutput)
+    {
+        mOutput.AddDelta(static_cast<uint32_t>(lTime - mFrameStart), lOutput - mLastOutput);
+        mLastOutput = lOutput;
+    }
+}
+
+//--------//
+// UpdateIrq
+//
+// Drives the cpu's IRQ line from the frame counter and DMC flags.
+//--------//
+//
+void Apu2A03::UpdateIrq(void)
+{
+    if (mSystem)
+    {
+        mSystem->mCpu.SetIrq(Cpu6502::IRQ_APU, mFrameIrq || mDmcIrq);
+    }
+}
+
+//--------//
+// UpdateNextEvent
+//
+// Works out when the system has to catch the apu up next. That's the next frame counter
+// step, or the next DMC fetch if a sample is playing, as either can raise an IRQ.
+//--------//
+//
+void Apu2A03::UpdateNextEvent(void)
+{
+    uint64_t lFetch;
+
+    mNextEvent = mFrameCounterStart + cFrameSteps[mFiveStep][mFrameStep];
+    if (mDmc.mBytesLeft)
+    {
+        lFetch     = mDmc.mNext + static_cast<uint64_t>(mDmc.mBitsLeft - 1) * mDmc.GetPeriod();
+        mNextEvent = (lFetch < mNextEvent) ? lFetch : mNextEvent;
+    }
+}
+
+//--------//
+// GetCpuCycle
+//
+// returns  The cpu cycle the system is on, or the apu's own time if it isn't connected.
+//--------//
+//
+uint64_t Apu2A03::GetCpuCycle(void)
+{
+    return (nullptr == mSystem) ? mTime : mSystem->GetCpuCycles();
+}
+
+//--------//
+//
+// Apu2A03::Envelope
+//
+//--------//
+
+//--------//
+// Write
+//
+// Takes the envelope bits of a channel's control register.
+//
+// param[in] lData   The control register.
+//--------//
+//
+void Apu2A03::Envelope::Write(uint8_t lData)
+{
+    mLoop     = (lData & Bit(5)) != 0;
+    mConstant = (lData & Bit(4)) != 0;
+    mVolume   = lData & BitMask(4);
+}
+
+//--------//
+// Clock
+//
+// Quarter frame clock. Restarts the decay if started, otherwise counts it down.
+//--------//
+//
+void Apu2A03::Envelope::Clock(void)
+{
+    if (mStart)
+    {
+        mStart   = false;
+        mDecay   = 15;
+        mDivider = mVolume;
+    }
+    else if (mDivider == 0)
+    {
+        mDivider = mVolume;
+        if (mDecay)
+        {
+            --mDecay;
+        }
+        else if (mLoop)
+        {
+            mDecay = 15;
+        }
+    }
+    else
+    {
+        --mDivider;
+    }
+}
+
+//--------//
+//
+// Apu2A03::Pulse
+//
+//--------//
+
+//--------//
+// Write
+//
+// Writes one of the pulse channel's registers.
+//
+// param[in] lRegister   Register, 0-3.
+// param[in] lData       Data to write.
+//--------//
+//
+void Apu2A03::Pulse::Write(uint8_t lRegister, uint8_t lData)
+{
+    switch (lRegister)
+    {
+        case 0:
+            mDuty = lData >> 6;
+            mEnvelope.Write(lData);
+            break;
+
+        case 1:
+            mSweepEnabled = (lData & Bit(7)) != 0;
+            mSweepPeriod  = (lData >> 4) & BitMask(3);
+            mSweepNegate  = (lData & Bit(3)) != 0;
+            mSweepShift   = lData & BitMask(3);
+            mSweepReload  = true;
+            break;
+
+        case 2:
+            mTimer = (mTimer & 0x0700) | lData;
+            break;
+
+        default:
+            mTimer = (mTimer & 0x00FF) | ((lData & BitMask(3)) << 8);
+            if (mEnabled)
+            {
+                mLength = cLengths[lData >> 3];
+            }
+            mStep            = 0;
+            mEnvelope.mStart = true;
+            break;
+    }
+}
+
+//--------//
+// Clock
+//
+// Timer tick, moves on to the next step of the duty cycle.
+//--------//
+//
+void Apu2A03::Pulse::Clock(void)
+{
+    mNext += GetPeriod();
+    mStep  = (mStep + 1) & 0x07;
+}
+
+//--------//
+// GetSweepTarget
+//
+// returns  The period the sweep would set next.
+//--------//
+//
+uint16_t Apu2A03::Pulse::GetSweepTarget(void)
+{
+    int lChange = mTimer >> mSweepShift;
+    int lTarget = mSweepNegate ? mTimer - lChange - mOnesComplement : mTimer + lChange;
+
+    return static_cast<uint16_t>((lTarget < 0) ? 0 : lTarget);
+}
+
+//--------//
+// ClockSweep
+//
+// Half frame clock. Moves the period towards the sweep's target unless the channel is muted.
+//--------//
+//
+void Apu2A03::Pulse::ClockSweep(void)
+{
+    uint16_t lTarget = GetSweepTarget();
+    bool     lMuted  = mTimer < 8 || (!mSweepNegate && lTarget > 0x07FF);
+
+    if (mSweepDivider == 0 && mSweepEnabled && mSweepShift && !lMuted)
+    {
+        mTimer = lTarget;
+    }
+    if (mSweepDivider == 0 || mSweepReload)
+    {
+        mSweepDivider = mSweepPeriod;
+        mSweepReload  = false;
+    }
+    else
+    {
+        --mSweepDivider;
+    }
+}
+
+//--------//
+// IsSilent
+//
+// returns  If the channel outputs 0 until a register write or frame counter step.
+//--------//
+//
+bool Apu2A03::Pulse::IsSilent(void)
+{
+    return mLength == 0 || mTimer < 8 || (!mSweepNegate && GetSweepTarget() > 0x07FF) || mEnvelope.GetVolume() == 0;
+}
+
+//--------//
+// GetOutput
+//
+// returns  The channel's output, 0-15.
+//--------//
+//
+uint8_t Apu2A03::Pulse::GetOutput(void)
+{
+    return (!IsSilent() && cDuties[mDuty][mStep]) ? mEnvelope.GetVolume() : 0;
+}
+
+//--------//
+//
+// Apu2A03::Triangle
+//
+//--------//
+
+//--------//
+// Write
+//
+// Writes one of the triangle channel's registers.
+//
+// param[in] lRegister   Register, as an offset from $4000.
+// param[in] lData       Data to write.
+//--------//
+//
+void Apu2A03::Triangle::Write(uint8_t lRegister, uint8_t lData)
+{
+    switch (lRegister)
+    {
+        case TRIANGLE_CONTROL:
+            mControl    = (lData & Bit(7)) != 0;
+            mLinearLoad = lData & BitMask(7);
+            break;
+
+        case TRIANGLE_TIMER_LOW:
+            mTimer = (mTimer & 0x0700) | lData;
+            break;
+
+        case TRIANGLE_TIMER_HIGH:
+            mTimer = (mTimer & 0x00FF) | ((lData & BitMask(3)) << 8);
+            if (mEnabled)
+            {
+                mLength = cLengths[lData >> 3];
+            }
+            mLinearReload = true;
+            break;
+
+        default:
+            break;
+    }
+}
+
+//--------//
+// Clock
+//
+// Timer tick, moves the sequence on while both counters are running. Periods too short to
+// hear hold the sequence instead, which is what games that use them to silence it expect.
+//--------//
+//
+void Apu2A03::Triangle::Clock(void)
+{
+    mNext += GetPeriod();
+    if (mLength && mLinear && mTimer >= 2)
+    {
+        mStep = (mStep + 1) & 0x1F;
+    }
+}
+
+//--------//
+// ClockLinear
+//
+// Quarter frame clock of the linear counter.
+//--------//
+//
+void Apu2A03::Triangle::ClockLinear(void)
+{
+    if (mLinearReload)
+    {
+        mLinear = mLinearLoad;
+    }
+    else if (mLinear)
+    {
+        --mLinear;
+    }
+    if (!mControl)
+    {
+        mLinearReload = false;
+    }
+}
+
+//--------//
+// GetOutput
+//
+// returns  The channel's output, 0-15. Held at the current step while the sequence is stopped.
+//--------//
+//
+uint8_t Apu2A03::Triangle::GetOutput(void)
+{
+    return cTriangle[mStep];
+}
+
+//--------//
+//
+// Apu2A03::Noise
+//
+//--------//
+
+//--------//
+// Write
+//
+// Writes one of the noise channel's registers.
+//
+// param[in] lRegister   Register, as an offset from $4000.
+// param[in] lData       Data to write.
+//--------//
+//
+void Apu2A03::Noise::Write(uint8_t lRegister, uint8_t lData)
+{
+    switch (lRegister)
+    {
+        case NOISE_CONTROL:
+            mEnvelope.Write(lData);
+            break;
+
+        case NOISE_PERIOD:
+            mShortMode = (lData & Bit(7)) != 0;
+            mPeriod    = lData & BitMask(4);
+            break;
+
+        case NOISE_LENGTH:
+            if (mEnabled)
+            {
+                mLength = cLengths[lData >> 3];
+            }
+            mEnvelope.mStart = true;
+            break;
+
+        default:
+            break;
+    }
+}
+
+//--------//
+// Clock
+//
+// Timer tick, shifts the feedback register.
+//--------//
+//
+void Apu2A03::Noise::Clock(void)
+{
+    uint16_t lFeedback = (mShift ^ (mShift >> (mShortMode ? 6 : 1))) & 0x01;
+
+    mNext  += GetPeriod();
+    mShift  = (mShift >> 1) | (lFeedback << 14);
+}
+
+//--------//
+// GetPeriod
+//
+// returns  Cpu cycles between timer ticks.
+//--------//
+//
+uint32_t Apu2A03::Noise::GetPeriod(void)
+{
+    return cNoisePeriods[mPeriod];
+}
+
+//--------//
+//
+// Apu2A03::Dmc
+//
+//--------//
+
+//--------//
+// Write
+//
+// Writes one of the DMC's registers.
+//
+// param[in] lRegister   Register, as an offset from $4000.
+// param[in] lData       Data to write.
+//--------//
+//
+void Apu2A03::Dmc::Write(uint8_t lRegister, uint8_t lData)
+{
+    switch (lRegister)
+    {
+        case DMC_CONTROL:
+            mIrqEnabled = (lData & Bit(7)) != 0;
+            mLoop       = (lData & Bit(6)) != 0;
+            mRate       = lData & BitMask(4);
+            break;
+
+        case DMC_LOAD:
+            mLevel = lData & BitMask(7);
+            break;
+
+        case DMC_ADDRESS:
+            mSampleAddress = 0xC000 + lData * 64;
+            break;
+
+        case DMC_LENGTH:
+            mSampleLength = lData * 16 + 1;
+            break;
+
+        default:
+            break;
+    }
+}
+
+//--------//
+// Clock
+//
+// Timer tick. Plays one bit of the shift register as a step up or down, and starts on the
+// sample buffer after the last one.
+//
+// returns  If the sample buffer needs filling.
+//--------//
+//
+bool Apu2A03::Dmc::Clock(void)
+{
+    mNext += GetPeriod();
+
+    if (!mSilence)
+    {
+        if (mShift & 0x01)
+        {
+            mLevel = (mLevel <= 125) ? mLevel + 2 : mLevel;
+        }
+        else
+        {
+            mLevel = (mLevel >= 2) ? mLevel - 2 : mLevel;
+        }
+    }
+    mShift >>= 1;
+
+    if (--mBitsLeft == 0)
+    {
+        mBitsLeft = 8;
+        mSilence  = mBufferEmpty;
+        if (!mBufferEmpty)
+        {
+            mShift       = mBuffer;
+            mBufferEmpty = true;
+        }
+    }
+    return mBufferEmpty && mBytesLeft;
+}
+
+//--------//
+// GetPeriod
+//
+// returns  Cpu cycles between timer ticks.
+//--------//
+//
+uint32_t Apu2A03::Dmc::GetPeriod(void)
+{
+    return cDmcRates[mRate];
+}
@@ -0,0 +1,141 @@
+/////////////////////////////////////////////////////////////////////
+//
+// AudioSink.cpp
+//
+// Implementation file for the generic audio sink.
+//
+/////////////////////////////////////////////////////////////////////
+
+#include <new>
+#include "AudioSink.hpp"
+#include "NullAudioSink.hpp"
+#include "WavAudioSink.hpp"
+#include <Errors/ApiErrors.hpp>
+#include <chrono>
+
+#ifdef USE_ALSA
+#include <Platform/Alsa/AlsaAudioSink.hpp>
+#endif
+
+//--------//
+//
+// AudioSink
+//
+//--------//
+
+//--------//
+// Open
+//
+// Creates a sink. It doesn't start draining the ring until Start is called.
+//
+// param[in]    lType           Kind of sink.
+// param[in]    lRing           Ring the sink drains.
+// param[in]    lSampleRate     Samples per second in the ring.
+// param[in]    lFilename       File to write, for WAV_FILE_SINK.
+// returns  The sink, or nullptr if the kind isn't built in or there's no memory for it.
+//--------//
+//
+AudioSink * AudioSink::Open(SinkType lType, AudioRing * lRing, int lSampleRate, const char * lFilename)
+{
+    AudioSink * lSink = nullptr;
+
+    switch (lType)
+    {
+        case NULL_SINK:
+            lSink = new(std::nothrow) NullAudioSink(lRing, lSampleRate);
+            break;
+
+        case WAV_FILE_SINK:
+            lSink = new(std::nothrow) WavAudioSink(lRing, lSampleRate, lFilename);
+            break;
+
+        case DEVICE_SINK:
+#ifdef USE_ALSA
+            lSink = new(std::nothrow) AlsaAudioSink(lRing, lSampleRate);
+            break;
+#else
+            return nullptr;
+#endif
+
+        default:
+            return nullptr;
+    }
+
+    if (nullptr == lSink)
+    {
+        gErrorManager.Post(ErrorCodes::OUT_OF_MEMORY);
+    }
+    return lSink;
+}
+
+//--------//
+// AudioSink
+//
+// Constructor.
+//
+// param[in]    lRing           Ring the sink drains.
+// param[in]    lSampleRate     Samples per second in the ring.
+//--------//
+//
+AudioSink::AudioSink(AudioRing * lRing, int lSampleRate)
+  : mRing(lRing),
+    mSampleRate(lSampleRate),
+    mStatus(ErrorCodes::SUCCESS),
+    mStartFill(0),
+    mRunning(false)
+{
+}
+
+//--------//
+// Start
+//
+// Starts the thread draining the ring. Does nothing if the sink didn't open properly.
+//--------//
+//
+void AudioSink::Start(void)
+{
+    if (mStatus != ErrorCodes::SUCCESS || mRunning)
+    {
+        return;
+    }
+    mRunning = true;
+    mThread  = std::thread(&AudioSink::Run, this);
+}
+
+//--------//
+// Stop
+//
+// Stops the thread and flushes anything the sink still holds. Safe to call more than once.
+//--------//
+//
+void AudioSink::Stop(void)
+{
+    mRunning = false;
+    if (mThread.joinable())
+    {
+        mThread.join();
+        Flush();
+    }
+}
+
+//--------//
+// Run
+//
+// The sink's thread. Waits for the ring to reach the start fill, then pumps a period at
+// a time until stopped, or until the sink fails.
+//--------//
+//
+void AudioSink::Run(void)
+{
+    while (mRunning && mRing->GetFill() < mStartFill)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(PERIOD_MS));
+    }
+    while (mRunning)
+    {
+        if (!Pump())
+        {
+            break;
+        }
+    }
+}
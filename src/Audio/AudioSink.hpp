@@ -0,0 +1,75 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// AudioSink.hpp
+//
+// Class representing a generic place the application sends its audio.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef AUDIO_SINK_HPP
+#define AUDIO_SINK_HPP
+
+#include <AudioRing.hpp>
+#include <atomic>
+#include <thread>
+
+//========//
+// AudioSink
+//
+// Platform agnostic audio output. A sink drains an AudioRing on a thread of its own, so
+// nothing it does, like waiting on a sound device or a disk, ever holds up emulation.
+// Specific sinks inherit from this class and implement Pump, which moves one period of
+// samples out of the ring and on to wherever they go.
+//
+// Sinks are created by calling the static Open method with the kind of sink wanted. A
+// kind that isn't built in comes back as nullptr, one that couldn't get its device or
+// file comes back with a status other than SUCCESS, either way the caller can fall back
+// to another. A sink can be told to hold off until the ring has some audio in it, so it
+// starts with a cushion instead of running dry right away. Derived destructors must call
+// Stop, so the thread is done with Pump before the sink is gone.
+//========//
+//
+class AudioSink
+{
+    public:
+
+        enum SinkType
+        {
+            NULL_SINK,      // Drains the ring at the sample rate and throws the samples away.
+            WAV_FILE_SINK,  // Streams everything into a wav file as fast as it comes.
+            DEVICE_SINK     // Plays through the platform's sound device.
+        };
+
+        enum
+        {
+            PERIOD_MS = 10  // Audio a sink moves at a time.
+        };
+
+        virtual ~AudioSink(void) = default;
+
+        static AudioSink * Open(SinkType lType, AudioRing * lRing, int lSampleRate, const char * lFilename = nullptr);
+
+        void            Start(void);
+        void            Stop(void);
+        int             GetStatus(void)      {return mStatus;}
+        int             GetSampleRate(void)  {return mSampleRate;}
+        int             GetPeriod(void)      {return mSampleRate * PERIOD_MS / 1000;}
+        void            SetStartFill(size_t lFill)  {mStartFill = lFill;}
+
+    protected:
+
+        AudioSink(AudioRing * lRing, int lSampleRate);
+
+        void            Run(void);
+        virtual bool    Pump(void)  = 0;
+        virtual void    Flush(void) {}
+
+        AudioRing *       mRing;
+        int               mSampleRate;
+        int               mStatus;
+        size_t            mStartFill;   // Samples the ring needs before the sink starts draining it.
+        std::atomic<bool> mRunning;
+        std::thread       mThread;
+};
+
+#endif
@@ -0,0 +1,78 @@
+/////////////////////////////////////////////////////////////////////
+//
+// NullAudioSink.cpp
+//
+// Implementation file for the audio sink that plays nothing.
+//
+/////////////////////////////////////////////////////////////////////
+
+#include <new>
+#include "NullAudioSink.hpp"
+#include <Errors/ApiErrors.hpp>
+
+//--------//
+//
+// NullAudioSink
+//
+//--------//
+
+//--------//
+// NullAudioSink
+//
+// Constructor.
+//
+// param[in]    lRing           Ring the sink drains.
+// param[in]    lSampleRate     Samples per second in the ring.
+//--------//
+//
+NullAudioSink::NullAudioSink(AudioRing * lRing, int lSampleRate)
+  : AudioSink(lRing, lSampleRate),
+    mBuffer(nullptr),
+    mStarted(false)
+{
+    mBuffer = new(std::nothrow) int16_t[GetPeriod()];
+    if (nullptr == mBuffer)
+    {
+        mStatus = ErrorCodes::OUT_OF_MEMORY;
+        gErrorManager.Post(mStatus);
+    }
+}
+
+//--------//
+// ~NullAudioSink
+//
+// Destructor.
+//--------//
+//
+NullAudioSink::~NullAudioSink(void)
+{
+    Stop();
+    delete [] mBuffer;
+}
+
+//--------//
+// Pump
+//
+// Drops a period's worth of samples, then waits out the period.
+//
+// returns  True, this sink can't fail.
+//--------//
+//
+bool NullAudioSink::Pump(void)
+{
+    auto lPeriod = std::chrono::milliseconds(PERIOD_MS);
+    auto lNow    = std::chrono::steady_clock::now();
+
+    // Start the clock on the first period, and don't try to catch up after a stall.
+    if (!mStarted || lNow > mDeadline + lPeriod)
+    {
+        mDeadline = lNow;
+        mStarted  = true;
+    }
+
+    mRing->Read(mBuffer, GetPeriod());
+
+    mDeadline += lPeriod;
+    std::this_thread::sleep_until(mDeadline);
+    return true;
+}
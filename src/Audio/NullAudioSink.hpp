@@ -0,0 +1,39 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// NullAudioSink.hpp
+//
+// Audio sink that plays nothing.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef NULL_AUDIO_SINK_HPP
+#define NULL_AUDIO_SINK_HPP
+
+#include "AudioSink.hpp"
+#include <chrono>
+
+//========//
+// NullAudioSink
+//
+// Stands in for a sound device on headless runs or machines without one. Takes a period
+// out of the ring every period, the way a device would, and throws it away. The ring's
+// counters still say whether emulation kept up.
+//========//
+//
+class NullAudioSink : public AudioSink
+{
+    public:
+
+        NullAudioSink(AudioRing * lRing, int lSampleRate);
+        virtual ~NullAudioSink(void);
+
+    protected:
+
+        virtual bool Pump(void) override;
+
+        int16_t *                             mBuffer;
+        bool                                  mStarted;
+        std::chrono::steady_clock::time_point mDeadline;
+};
+
+#endif
@@ -0,0 +1,230 @@
+/////////////////////////////////////////////////////////////////////
+//
+// WavAudioSink.cpp
+//
+// Implementation file for the audio sink that records to a wav file.
+//
+/////////////////////////////////////////////////////////////////////
+
+#include <new>
+#include "WavAudioSink.hpp"
+#include <Errors/ApiErrors.hpp>
+#include <chrono>
+
+//--------//
+// PutLittle
+//
+// Stores a value as little endian bytes, which is how everything in a wav file is stored.
+//
+// param[out]   lBytes  Where the bytes go.
+// param[in]    lValue  Value to store.
+// param[in]    lSize   Number of bytes.
+//--------//
+//
+static void PutLittle(uint8_t * lBytes, uint32_t lValue, int lSize)
+{
+    for (int lIndex = 0; lIndex < lSize; ++lIndex)
+    {
+        lBytes[lIndex] = static_cast<uint8_t>(lValue >> (lIndex * 8));
+    }
+}
+
+//--------//
+//
+// WavAudioSink
+//
+//--------//
+
+//--------//
+// WavAudioSink
+//
+// Constructor. Creates the file and writes a header for it with no samples yet.
+//
+// param[in]    lRing           Ring the sink drains.
+// param[in]    lSampleRate     Samples per second in the ring.
+// param[in]    lFilename       File to create.
+//--------//
+//
+WavAudioSink::WavAudioSink(AudioRing * lRing, int lSampleRate, const char * lFilename)
+  : AudioSink(lRing, lSampleRate),
+    mFile(nullptr),
+    mChunk(nullptr),
+    mChunkCount(0),
+    mDataBytes(0)
+{
+    if (nullptr == lFilename)
+    {
+        mStatus = ErrorCodes::FILE_COULD_NOT_OPEN;
+        return;
+    }
+
+    mChunk = new(std::nothrow) int16_t[CHUNK_SAMPLES];
+    if (nullptr == mChunk)
+    {
+        mStatus = ErrorCodes::OUT_OF_MEMORY;
+        gErrorManager.Post(mStatus);
+        return;
+    }
+
+    mStatus = ApiFileSystem::Open(lFilename, "wb", &mFile);
+    if (mStatus != ErrorCodes::SUCCESS)
+    {
+        gErrorManager.Post(mStatus, lFilename);
+        ApiFileSystem::Close(mFile);
+        mFile = nullptr;
+        return;
+    }
+
+    if (!WriteHeader())
+    {
+        mStatus = ErrorCodes::FILE_WRITE_ERROR;
+        gErrorManager.Post(mStatus);
+    }
+}
+
+//--------//
+// ~WavAudioSink
+//
+// Destructor. Stopping finishes the file.
+//--------//
+//
+WavAudioSink::~WavAudioSink(void)
+{
+    Stop();
+    if (mFile)
+    {
+        ApiFileSystem::Close(mFile);
+    }
+    delete [] mChunk;
+}
+
+//--------//
+// Pump
+//
+// Gathers what's in the ring, writing the chunk out whenever it fills. With nothing to
+// gather it waits a period rather than spin.
+//
+// returns  False if the file couldn't be written.
+//--------//
+//
+bool WavAudioSink::Pump(void)
+{
+    int lBefore = mChunkCount;
+
+    if (!Gather())
+    {
+        return false;
+    }
+    if (mChunkCount == lBefore)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(PERIOD_MS));
+    }
+    return true;
+}
+
+//--------//
+// Flush
+//
+// Writes out everything left in the ring and the chunk, then goes back and fills in the
+// header's sizes. Runs once the thread has stopped.
+//--------//
+//
+void WavAudioSink::Flush(void)
+{
+    if (nullptr == mFile || mStatus != ErrorCodes::SUCCESS)
+    {
+        return;
+    }
+
+    while (mRing->GetFill() && Gather())
+    {
+    }
+    if (!WriteChunk() || ApiFileSystem::SeekFromStart(0, mFile) != ErrorCodes::SUCCESS || !WriteHeader() ||
+        ApiFileSystem::SeekFromEnd(0, mFile) != ErrorCodes::SUCCESS)
+    {
+        mStatus = ErrorCodes::FILE_WRITE_ERROR;
+        gErrorManager.Post(mStatus);
+    }
+}
+
+//--------//
+// Gather
+//
+// Moves as much of the ring as fits into the chunk, and writes the chunk out if it's full.
+//
+// returns  False if the file couldn't be written.
+//--------//
+//
+bool WavAudioSink::Gather(void)
+{
+    size_t lCount = mRing->GetFill();
+
+    if (lCount > static_cast<size_t>(CHUNK_SAMPLES - mChunkCount))
+    {
+        lCount = CHUNK_SAMPLES - mChunkCount;
+    }
+    mChunkCount += static_cast<int>(mRing->Read(mChunk + mChunkCount, lCount));
+
+    if (mChunkCount == CHUNK_SAMPLES)
+    {
+        return WriteChunk();
+    }
+    return true;
+}
+
+//--------//
+// WriteChunk
+//
+// Writes the gathered samples to the file as little endian.
+//
+// returns  False if the file couldn't be written.
+//--------//
+//
+bool WavAudioSink::WriteChunk(void)
+{
+    size_t lBytes = mChunkCount * sizeof(mChunk[0]);
+
+    // Swap in place on big endian machines, the chunk is about to be reused anyway.
+    for (int lIndex = 0; lIndex < mChunkCount; ++lIndex)
+    {
+        PutLittle(reinterpret_cast<uint8_t *>(mChunk + lIndex), static_cast<uint16_t>(mChunk[lIndex]), 2);
+    }
+
+    if (lBytes && ApiFileSystem::Write(mChunk, lBytes, mFile) != lBytes)
+    {
+        mStatus = ErrorCodes::FILE_WRITE_ERROR;
+        gErrorManager.Post(mStatus);
+        return false;
+    }
+    mDataBytes  += static_cast<uint32_t>(lBytes);
+    mChunkCount  = 0;
+    return true;
+}
+
+//--------//
+// WriteHeader
+//
+// Writes a canonical 44 byte header at the current file position, with the sizes of
+// what's been written so far.
+//
+// returns  False if the file couldn't be written.
+//--------//
+//
+bool WavAudioSink::WriteHeader(void)
+{
+    uint8_t lHeader[HEADER_SIZE] = {'R', 'I', 'F', 'F', 0, 0, 0, 0, 'W', 'A', 'V', 'E',
+                                    'f', 'm', 't', ' ', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                                    0, 0, 0, 0, 0, 0, 0, 0, 'd', 'a', 't', 'a', 0, 0, 0, 0};
+
+    PutLittle(lHeader + 4,  HEADER_SIZE - 8 + mDataBytes, 4);
+    PutLittle(lHeader + 16, 16, 4);                     // Format chunk size.
+    PutLittle(lHeader + 20, 1, 2);                      // PCM.
+    PutLittle(lHeader + 22, 1, 2);                      // Mono.
+    PutLittle(lHeader + 24, mSampleRate, 4);
+    PutLittle(lHeader + 28, mSampleRate * 2, 4);        // Bytes per second.
+    PutLittle(lHeader + 32, 2, 2);                      // Bytes per sample.
+    PutLittle(lHeader + 34, 16, 2);                     // Bits per sample.
+    PutLittle(lHeader + 40, mDataBytes, 4);
+
+    return ApiFileSystem::Write(lHeader, HEADER_SIZE, mFile) == HEADER_SIZE;
+}
@@ -0,0 +1,54 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// WavAudioSink.hpp
+//
+// Audio sink that records to a wav file.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef WAV_AUDIO_SINK_HPP
+#define WAV_AUDIO_SINK_HPP
+
+#include "AudioSink.hpp"
+#include <File/ApiFile.hpp>
+
+//========//
+// WavAudioSink
+//
+// Streams the ring into a 16-bit mono wav file. Samples are gathered into large chunks
+// and written a chunk at a time, so the file system sees a few big writes instead of
+// one per period. The header's sizes are filled in when the sink is stopped.
+//
+// It takes whatever is in the ring as soon as it's there, so a run faster than real
+// time is still recorded whole, and an empty ring isn't counted as an underrun.
+//========//
+//
+class WavAudioSink : public AudioSink
+{
+    public:
+
+        enum
+        {
+            CHUNK_SAMPLES = 32768,  // Samples gathered before each write.
+            HEADER_SIZE   = 44
+        };
+
+        WavAudioSink(AudioRing * lRing, int lSampleRate, const char * lFilename);
+        virtual ~WavAudioSink(void);
+
+    protected:
+
+        virtual bool Pump(void) override;
+        virtual void Flush(void) override;
+
+        bool         Gather(void);
+        bool         WriteChunk(void);
+        bool         WriteHeader(void);
+
+        File *       mFile;
+        int16_t *    mChunk;
+        int          mChunkCount;   // Samples gathered into mChunk.
+        uint32_t     mDataBytes;    // Samples written to the file so far, in bytes.
+};
+
+#endif
@@ -0,0 +1,171 @@
+/////////////////////////////////////////////////////////////////////
+//
+// AudioRing.cpp
+//
+// Implementation file for the audio sample hand off.
+//
+/////////////////////////////////////////////////////////////////////
+
+#include <AudioRing.hpp>
+#include <Errors/ApiErrors.hpp>
+#include <string.h>
+
+//--------//
+//
+// AudioRing
+//
+//--------//
+
+//--------//
+// AudioRing
+//
+// Constructor.
+//--------//
+//
+AudioRing::AudioRing(void)
+  : mBuffer(nullptr),
+    mMask(0),
+    mWrite(0),
+    mRead(0),
+    mOverruns(0),
+    mUnderruns(0)
+{
+}
+
+//--------//
+// ~AudioRing
+//
+// Destructor.
+//--------//
+//
+AudioRing::~AudioRing(void)
+{
+    Resize(0);
+}
+
+//--------//
+// Resize
+//
+// Allocates the ring, rounded up to a power of 2, and empties it. Neither side may be
+// using the ring while this runs.
+//
+// param[in]    lCapacity   Most samples the ring has to hold.
+// returns  If the ring could be allocated.
+//--------//
+//
+bool AudioRing::Resize(size_t lCapacity)
+{
+    size_t lSize = 1;
+
+    if (mBuffer)
+    {
+        delete [] mBuffer;
+        mBuffer = nullptr;
+    }
+    mMask = 0;
+    mWrite.store(0);
+    mRead.store(0);
+
+    if (lCapacity == 0)
+    {
+        return true;
+    }
+
+    while (lSize < lCapacity)
+    {
+        lSize <<= 1;
+    }
+    mBuffer = new(std::nothrow) int16_t[lSize];
+    if (nullptr == mBuffer)
+    {
+        gErrorManager.Post(ErrorCodes::OUT_OF_MEMORY);
+        return false;
+    }
+    memset(mBuffer, 0, lSize * sizeof(mBuffer[0]));
+    mMask = lSize - 1;
+    return true;
+}
+
+//--------//
+// GetFill
+//
+// Either side can ask, the answer is only exact for the side asking.
+//
+// returns  Samples written and not read yet.
+//--------//
+//
+size_t AudioRing::GetFill(void)
+{
+    return mWrite.load(std::memory_order_acquire) - mRead.load(std::memory_order_acquire);
+}
+
+//--------//
+// Write
+//
+// Adds samples to the ring. Whatever doesn't fit is dropped.
+//
+// param[in]    lSamples    Samples to add.
+// param[in]    lCount      Number of samples.
+// returns  Number of samples added.
+//--------//
+//
+size_t AudioRing::Write(const int16_t * lSamples, size_t lCount)
+{
+    size_t lWrite = mWrite.load(std::memory_order_relaxed);
+    size_t lRoom  = GetCapacity() - (lWrite - mRead.load(std::memory_order_acquire));
+    size_t lStart = lWrite & mMask;
+    size_t lFirst;
+
+    if (lCount > lRoom)
+    {
+        mOverruns.fetch_add(1, std::memory_order_relaxed);
+        lCount = lRoom;
+    }
+    if (lCount == 0)
+    {
+        return 0;
+    }
+
+    // In at most two pieces, up to the end of the buffer and then from the start.
+    lFirst = (lCount < mMask + 1 - lStart) ? lCount : mMask + 1 - lStart;
+    memcpy(mBuffer + lStart, lSamples, lFirst * sizeof(mBuffer[0]));
+    memcpy(mBuffer, lSamples + lFirst, (lCount - lFirst) * sizeof(mBuffer[0]));
+
+    mWrite.store(lWrite + lCount, std::memory_order_release);
+    return lCount;
+}
+
+//--------//
+// Read
+//
+// Takes samples out of the ring, oldest first.
+//
+// param[out]   lSamples    Where the samples go.
+// param[in]    lCount      Number of samples wanted.
+// returns  Number of samples read, less than lCount if the ring ran dry.
+//--------//
+//
+size_t AudioRing::Read(int16_t * lSamples, size_t lCount)
+{
+    size_t lRead  = mRead.load(std::memory_order_relaxed);
+    size_t lFill  = mWrite.load(std::memory_order_acquire) - lRead;
+    size_t lStart = lRead & mMask;
+    size_t lFirst;
+
+    if (lCount > lFill)
+    {
+        mUnderruns.fetch_add(1, std::memory_order_relaxed);
+        lCount = lFill;
+    }
+    if (lCount == 0)
+    {
+        return 0;
+    }
+
+    lFirst = (lCount < mMask + 1 - lStart) ? lCount : mMask + 1 - lStart;
+    memcpy(lSamples, mBuffer + lStart, lFirst * sizeof(mBuffer[0]));
+    memcpy(lSamples + lFirst, mBuffer, (lCount - lFirst) * sizeof(mBuffer[0]));
+
+    mRead.store(lRead + lCount, std::memory_order_release);
+    return lCount;
+}
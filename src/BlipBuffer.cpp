@@ -0,0 +1,255 @@
+/////////////////////////////////////////////////////////////////////
+//
+// BlipBuffer.cpp
+//
+// Implementation file for band limited step synthesis.
+//
+/////////////////////////////////////////////////////////////////////
+
+#include <BlipBuffer.hpp>
+#include <Errors/ApiErrors.hpp>
+#include <math.h>
+#include <string.h>
+
+//--------//
+//
+// BlipBuffer
+//
+//--------//
+
+//--------//
+// BlipBuffer
+//
+// Constructor. Works out the step kernel for every phase. Each one is a windowed sinc
+// cut off a little below Nyquist, shifted by the phase and scaled to add up to exactly
+// one step, so a level held long enough comes back out unchanged.
+//--------//
+//
+BlipBuffer::BlipBuffer(void)
+  : mFactor(0),
+    mOffset(0),
+    mBuffer(nullptr),
+    mSize(0),
+    mMaxSamples(0),
+    mAvailable(0),
+    mIntegrator(0)
+{
+    const double cPi     = 3.14159265358979323846;
+    const double cCutoff = 0.9;     // Of Nyquist, leaves some room for the window's roll off.
+
+    for (int lPhase = 0; lPhase < NUM_PHASES; ++lPhase)
+    {
+        double lTaps[KERNEL_WIDTH];
+        double lSum     = 0.0;
+        int    lTotal   = 0;
+        int    lLargest = 0;
+
+        for (int lTap = 0; lTap < KERNEL_WIDTH; ++lTap)
+        {
+            double lX      = lTap - HALF_WIDTH - static_cast<double>(lPhase) / NUM_PHASES;
+            double lWindow = 0.42 + 0.5 * cos(cPi * lX / HALF_WIDTH) + 0.08 * cos(2.0 * cPi * lX / HALF_WIDTH);
+            double lSinc   = (lX == 0.0) ? 1.0 : sin(cPi * cCutoff * lX) / (cPi * cCutoff * lX);
+
+            lTaps[lTap] = (fabs(lX) < HALF_WIDTH) ? lSinc * lWindow : 0.0;
+            lSum       += lTaps[lTap];
+        }
+
+        for (int lTap = 0; lTap < KERNEL_WIDTH; ++lTap)
+        {
+            mKernel[lPhase][lTap] = static_cast<int16_t>(floor(lTaps[lTap] / lSum * (1 << DELTA_BITS) + 0.5));
+            lTotal += mKernel[lPhase][lTap];
+            if (mKernel[lPhase][lTap] > mKernel[lPhase][lLargest])
+            {
+                lLargest = lTap;
+            }
+        }
+
+        // Rounding can leave the phase a little off a whole step, which would drift the level.
+        mKernel[lPhase][lLargest] += static_cast<int16_t>((1 << DELTA_BITS) - lTotal);
+    }
+}
+
+//--------//
+// ~BlipBuffer
+//
+// Destructor.
+//--------//
+//
+BlipBuffer::~BlipBuffer(void)
+{
+    SetRates(0.0, 0.0, 0);
+}
+
+//--------//
+// SetRates
+//
+// Sets the clock and sample rates and sizes the buffer. Clears anything in it.
+//
+// param[in]    lClockRate      Clocks per second the times are given in.
+// param[in]    lSampleRate     Samples per second to produce.
+// param[in]    lMaxSamples     Samples to hold before the oldest are thrown away. 0 frees the buffer.
+// returns  If the buffer could be allocated.
+//--------//
+//
+bool BlipBuffer::SetRates(double lClockRate, double lSampleRate, int lMaxSamples)
+{
+    if (mBuffer)
+    {
+        delete [] mBuffer;
+        mBuffer = nullptr;
+    }
+    mSize       = 0;
+    mMaxSamples = 0;
+    mFactor     = 0;
+
+    if (lMaxSamples <= 0 || lClockRate <= 0.0 || lSampleRate >= lClockRate)
+    {
+        return lMaxSamples == 0;
+    }
+
+    // Room for a frame to run past the limit before EndFrame trims it back.
+    mSize   = lMaxSamples * 2 + KERNEL_WIDTH;
+    mBuffer = new(std::nothrow) int32_t[mSize];
+    if (nullptr == mBuffer)
+    {
+        mSize = 0;
+        gErrorManager.Post(ErrorCodes::OUT_OF_MEMORY);
+        return false;
+    }
+    mMaxSamples = lMaxSamples;
+    mFactor     = static_cast<uint64_t>(lSampleRate / lClockRate * static_cast<double>(1ULL << TIME_BITS) + 0.5);
+    Clear();
+    return true;
+}
+
+//--------//
+// Clear
+//
+// Throws away every sample and delta, and starts again from a level of 0.
+//--------//
+//
+void BlipBuffer::Clear(void)
+{
+    if (mBuffer)
+    {
+        memset(mBuffer, 0, mSize * sizeof(mBuffer[0]));
+    }
+    mOffset     = 0;
+    mAvailable  = 0;
+    mIntegrator = 0;
+}
+
+//--------//
+// AddDelta
+//
+// Adds a jump in level at the given time.
+//
+// param[in]    lTime   Clocks since the start of the frame.
+// param[in]    lDelta  Change in level, in output sample units.
+//--------//
+//
+void BlipBuffer::AddDelta(uint32_t lTime, int32_t lDelta)
+{
+    uint64_t        lPosition = mOffset + lTime * mFactor;
+    int             lIndex    = mAvailable + static_cast<int>(lPosition >> TIME_BITS);
+    const int16_t * lKernel   = mKernel[(lPosition >> (TIME_BITS - PHASE_BITS)) & (NUM_PHASES - 1)];
+    int32_t *       lOut;
+
+    // A frame far longer than the buffer was sized for, nothing sensible to do with it.
+    if (lIndex + KERNEL_WIDTH > mSize)
+    {
+        return;
+    }
+
+    lOut = mBuffer + lIndex;
+    for (int lTap = 0; lTap < KERNEL_WIDTH; ++lTap)
+    {
+        lOut[lTap] += lKernel[lTap] * lDelta;
+    }
+}
+
+//--------//
+// EndFrame
+//
+// Closes the current frame, making its samples available. The next frame starts where
+// this one ended. If nothing is reading, the oldest samples go.
+//
+// param[in]    lTime   Length of the frame in clocks.
+//--------//
+//
+void BlipBuffer::EndFrame(uint32_t lTime)
+{
+    uint64_t lPosition = mOffset + lTime * mFactor;
+
+    mAvailable += static_cast<int>(lPosition >> TIME_BITS);
+    mOffset     = lPosition & ((1ULL << TIME_BITS) - 1);
+
+    if (mAvailable > mMaxSamples)
+    {
+        RemoveSamples(mAvailable - mMaxSamples);
+    }
+}
+
+//--------//
+// ReadSamples
+//
+// Reads out finished samples, oldest first.
+//
+// param[out]   lOut    Where the samples go, or nullptr to only drop them.
+// param[in]    lCount  Most samples to read.
+// returns  Number of samples read.
+//--------//
+//
+int BlipBuffer::ReadSamples(int16_t * lOut, int lCount)
+{
+    int32_t lSum = mIntegrator;
+    int32_t lSample;
+
+    if (lCount > mAvailable)
+    {
+        lCount = mAvailable;
+    }
+    if (lCount <= 0)
+    {
+        return 0;
+    }
+
+    for (int lIndex = 0; lIndex < lCount; ++lIndex)
+    {
+        lSample = lSum >> DELTA_BITS;
+        if (lSample > INT16_MAX)
+        {
+            lSample = INT16_MAX;
+        }
+        else if (lSample < INT16_MIN)
+        {
+            lSample = INT16_MIN;
+        }
+        if (lOut)
+        {
+            lOut[lIndex] = static_cast<int16_t>(lSample);
+        }
+
+        lSum += mBuffer[lIndex];
+        lSum -= lSample * (1 << (DELTA_BITS - BASS_SHIFT));
+    }
+    mIntegrator = lSum;
+
+    memmove(mBuffer, mBuffer + lCount, (mSize - lCount) * sizeof(mBuffer[0]));
+    memset(mBuffer + mSize - lCount, 0, lCount * sizeof(mBuffer[0]));
+    mAvailable -= lCount;
+    return lCount;
+}
+
+//--------//
+// RemoveSamples
+//
+// Drops finished samples, oldest first, without reading them.
+//
+// param[in]    lCount  Number of samples to drop.
+//--------//
+//
+void BlipBuffer::RemoveSamples(int lCount)
+{
+    ReadSamples(nullptr, lCount);
+}
@@ -9,11 +9,17 @@
 #include <System.hpp>
 #include <File/ApiFile.hpp>
 #include <Errors/ApiErrors.hpp>
+#include <Crc32.hpp>
+#include <RomDatabase.hpp>
+#include <cstring>
 
 #ifdef USE_LOGGER
 #include <Logger/ApiLogger.hpp>
 #endif
 
+// Extension of the battery save file, in place of the game's.
+static const char cSaveExtension[] = ".sav";
+
 //--------//
 //
 // Cartridge
@@ -33,12 +39,23 @@ Cartridge::Cartridge(const char * lFilename)
   : mAddressStart(System::CARTRIDGE_START),
     mAddressEnd(mAddressStart + System::CARTRIDGE_SIZE),
     mMapperId(0),
+    mSubmapper(0),
+    mTiming(TIMING_NTSC),
+    mCrc(0),
     mMapper(nullptr),
-    mMirrorType(HORIZONTAL),
+    mTileCache(mChrMemory),
+    mChrPages{Ppu2C02::UNMAPPED_PAGE, Ppu2C02::UNMAPPED_PAGE, Ppu2C02::UNMAPPED_PAGE, Ppu2C02::UNMAPPED_PAGE,
+              Ppu2C02::UNMAPPED_PAGE, Ppu2C02::UNMAPPED_PAGE, Ppu2C02::UNMAPPED_PAGE, Ppu2C02::UNMAPPED_PAGE},
+    mPrgRead{},
+    mPrgWrite{},
+    mMirroring(Ppu2C02::MIRROR_HORIZONTAL),
     mNes20Format(false),
-    mPrgMirror(false),
     mChrRam(false),
-    mValidImage(false)
+    mBattery(false),
+    mSaveDirty(false),
+    mValidImage(false),
+    mDotRenderer(false),
+    mLiveRenderer(false)
 {
 #ifdef USE_LOGGER
     char lBuffer[ApiFileSystem::MAX_FILENAME * 2];
@@ -46,9 +63,12 @@ Cartridge::Cartridge(const char * lFilename)
     ApiLogger::Log(lBuffer);
 #endif
 
-    int    lStatus;
-    File * lFile;
-    size_t lBytes;
+    int             lStatus;
+    File *          lFile;
+    size_t          lBytes;
+    Crc32           lCrc;
+    const RomInfo * lInfo;
+    Sizes           lSizes;
 
     // Attempt to open the provided file.
     lStatus = ApiFileSystem::Open(lFilename, "rb", &lFile);
@@ -94,8 +114,20 @@ Cartridge::Cartridge(const char * lFilename)
     }
 
     // Grab information from the header.
-    mMirrorType = GetMirroring();
-    mMapperId   = GetHighNibbleMapId() | (GetLowNibbleMapId() >> 4);
+    if (GetFourScreen())
+    {
+        mMirroring = Ppu2C02::MIRROR_FOUR_SCREEN;
+    }
+    else
+    {
+        mMirroring = (GetMirroringBit() == VERTICAL) ? Ppu2C02::MIRROR_VERTICAL : Ppu2C02::MIRROR_HORIZONTAL;
+    }
+    if (!ParseHeader(lSizes))
+    {
+        ApiFileSystem::Close(lFile);
+        gErrorManager.Post(ErrorCodes::INVALID_NES_FORMAT);
+        return;
+    }
 
     // Not sure what to do if there is a trainer yet. For now, just skip past it.
     if (GetTrainer())
@@ -104,11 +136,7 @@ Cartridge::Cartridge(const char * lFilename)
     }
 
     // Prepare the Program ROM.
-    if (mHeader.mPrgBanks == 1)
-    {
-        mPrgMirror = true;
-    }
-    mPrgMemory.Resize(mHeader.mPrgBanks * DEFAULT_PRG_SIZE);
+    mPrgMemory.Resize(lSizes.mPrgRom);
 
     // Load Program ROM.
     lStatus = mPrgMemory.LoadMemoryFromFile(lFile, mPrgMemory.GetSize());
@@ -118,32 +146,46 @@ Cartridge::Cartridge(const char * lFilename)
         gErrorManager.Post(lStatus);
         return;
     }
+    lCrc.Update(mPrgMemory.GetBuffer(), mPrgMemory.GetSize());
 
     // Prepare the Character ROM.
     // CHR cannot have a size 0, if the head indicates 0 then it's used as a RAM instead.
-    if (mHeader.mChrBanks == 0)
+    if (lSizes.mChrRom == 0)
     {
-        mChrMemory.Resize(DEFAULT_CHR_SIZE);
+        mChrMemory.Resize(lSizes.mChrRam);
         mChrRam = true;
     }
     else
     {
-        mChrMemory.Resize(mHeader.mChrBanks * DEFAULT_CHR_SIZE);
+        mChrMemory.Resize(lSizes.mChrRom);
     }
 
-    // Load Character ROM.
-    lStatus = mChrMemory.LoadMemoryFromFile(lFile, mChrMemory.GetSize());
-    if (lStatus != ErrorCodes::SUCCESS)
+    // Load Character ROM. CHR RAM has nothing stored in the file.
+    if (!mChrRam)
     {
-        mPrgMemory.Resize(0);
-        mChrMemory.Resize(0);
-        gErrorManager.Post(lStatus);
-        return;
+        lStatus = mChrMemory.LoadMemoryFromFile(lFile, mChrMemory.GetSize());
+        if (lStatus != ErrorCodes::SUCCESS)
+        {
+            mPrgMemory.Resize(0);
+            mChrMemory.Resize(0);
+            gErrorManager.Post(lStatus);
+            return;
+        }
+        lCrc.Update(mChrMemory.GetBuffer(), mChrMemory.GetSize());
     }
+    mTileCache.Resize(mChrMemory.GetSize());
 
     // Close the file.
     ApiFileSystem::Close(lFile);
 
+    // A known image knows better than its header.
+    mCrc  = lCrc.GetValue();
+    lInfo = RomDatabase::Find(mCrc);
+    if (lInfo)
+    {
+        ApplyRomInfo(lInfo, lSizes);
+    }
+
     // Create the mapper.
     mMapper = MapperFactory(mMapperId, this);
 
@@ -156,6 +198,21 @@ Cartridge::Cartridge(const char * lFilename)
         return;
     }
 
+    // Program RAM is only there if the mapper maps it. With a battery all of it is kept
+    // in the save file, otherwise it starts out empty every time. This waits until the
+    // mapper is known, so an image that can't be played doesn't leave a save file behind.
+    if (mBattery && lSizes.mPrgRam + lSizes.mPrgNvram)
+    {
+        OpenSaveFile(lFilename, lSizes.mPrgRam + lSizes.mPrgNvram);
+    }
+    else
+    {
+        mPrgRam.Resize(lSizes.mPrgRam + lSizes.mPrgNvram);
+    }
+
+    // Let the mapper lay out its power up banks.
+    mMapper->Reset();
+
     // If we made it this far, then it was a valid file.
     mValidImage = true;
 
@@ -174,12 +231,199 @@ Cartridge::~Cartridge()
     {
         delete mMapper;
     }
+
+    // Let go of the save file before it's unmapped.
+    mPrgRam.Resize(0);
+    mSaveFile.Close();
+}
+
+//--------//
+// ParseHeader
+//
+// Works out the mapper, the size of every memory and the timing from the header, in
+// either iNES or NES 2.0 format.
+//
+// param[out]   lSizes  Sizes of the memories on the cartridge.
+// returns  False if the sizes are too large to be real.
+//--------//
+//
+bool Cartridge::ParseHeader(Sizes & lSizes)
+{
+    uint64_t lPrgRom;
+    uint64_t lChrRom;
+    uint32_t lPrgRam;
+
+    mMapperId = GetHighNibbleMapId() | (GetLowNibbleMapId() >> 4);
+    mBattery  = GetBattery();
+
+    if (!mNes20Format)
+    {
+        // Older headers give PRG RAM in 8KB units, leaving it at 0 for the one bank most boards have.
+        lPrgRam          = (mHeader.mPrgRamSize ? mHeader.mPrgRamSize : 1) * PRG_RAM_UNIT;
+        lSizes.mPrgRom   = mHeader.mPrgBanks * DEFAULT_PRG_SIZE;
+        lSizes.mChrRom   = mHeader.mChrBanks * DEFAULT_CHR_SIZE;
+        lSizes.mPrgRam   = mBattery ? 0 : lPrgRam;
+        lSizes.mPrgNvram = mBattery ? lPrgRam : 0;
+        lSizes.mChrRam   = lSizes.mChrRom ? 0 : DEFAULT_CHR_SIZE;
+        mTiming          = (GetTvSystem() == PAL) ? TIMING_PAL : TIMING_NTSC;
+        return true;
+    }
+
+    mMapperId  |= (mHeader20.mMapper & Nes20MapperBits::MAPPER_HIGH) << 8;
+    mSubmapper  = (mHeader20.mMapper & Nes20MapperBits::SUBMAPPER) >> 4;
+    mTiming     = static_cast<Timing>(mHeader20.mTiming & TIMING_MASK);
+
+    lPrgRom = GetNes20RomSize(mHeader20.mPrgBanks, mHeader20.mRomSizeHigh & 0x0F, DEFAULT_PRG_SIZE);
+    lChrRom = GetNes20RomSize(mHeader20.mChrBanks, mHeader20.mRomSizeHigh >> 4, DEFAULT_CHR_SIZE);
+    if (lPrgRom > MAX_ROM_SIZE || lChrRom > MAX_ROM_SIZE)
+    {
+        return false;
+    }
+
+    lSizes.mPrgRom   = static_cast<uint32_t>(lPrgRom);
+    lSizes.mChrRom   = static_cast<uint32_t>(lChrRom);
+    lSizes.mPrgRam   = GetNes20RamSize(mHeader20.mPrgRamShift & 0x0F);
+    lSizes.mPrgNvram = GetNes20RamSize(mHeader20.mPrgRamShift >> 4);
+    lSizes.mChrRam   = GetNes20RamSize(mHeader20.mChrRamShift & 0x0F) + GetNes20RamSize(mHeader20.mChrRamShift >> 4);
+    mBattery        |= lSizes.mPrgNvram != 0;
+
+    // The pattern tables need a full 8KB behind them.
+    if (lSizes.mChrRom == 0 && lSizes.mChrRam < DEFAULT_CHR_SIZE)
+    {
+        lSizes.mChrRam = DEFAULT_CHR_SIZE;
+    }
+    return true;
+}
+
+//--------//
+// GetNes20RomSize
+//
+// Works out a ROM size from NES 2.0's two size fields. Normally they're a count of banks,
+// but with the high nibble all set the low byte is an exponent and multiplier instead.
+//
+// param[in]    lLow        Low byte of the size, bytes 4 or 5.
+// param[in]    lHigh       High nibble of the size, from byte 9.
+// param[in]    lBankSize   Size of a bank.
+// returns  The size in bytes.
+//--------//
+//
+uint64_t Cartridge::GetNes20RomSize(uint8_t lLow, uint8_t lHigh, uint32_t lBankSize)
+{
+    uint32_t lExponent = lLow >> 2;
+
+    if (lHigh == 0x0F)
+    {
+        // Anything past 2^32 is too large already, keep the shift in range.
+        lExponent = (lExponent > 32) ? 32 : lExponent;
+        return (static_cast<uint64_t>(1) << lExponent) * ((lLow & 0x03) * 2 + 1);
+    }
+    return ((static_cast<uint64_t>(lHigh) << 8) | lLow) * lBankSize;
+}
+
+//--------//
+// OpenSaveFile
+//
+// Backs PRG RAM with a save file next to the game, named after it with a .sav extension.
+// Writes land in the file's pages directly and the operating system writes them out, so
+// nothing waits on the disk while the game runs. If the file can't be used, PRG RAM is
+// kept in memory like any other.
+//
+// param[in]    lFilename   Location of the NES game.
+// param[in]    lSize       Size of PRG RAM.
+//--------//
+//
+void Cartridge::OpenSaveFile(const char * lFilename, uint32_t lSize)
+{
+    char   lSaveName[ApiFileSystem::MAX_FILENAME + sizeof(cSaveExtension)];
+    char * lExtension;
+    int    lStatus;
+
+    strncpy(lSaveName, lFilename, ApiFileSystem::MAX_FILENAME);
+    lSaveName[ApiFileSystem::MAX_FILENAME] = '\0';
+
+    // Swap the extension for .sav, unless the dot is part of a directory name.
+    lExtension = strrchr(lSaveName, '.');
+    if (lExtension && !strpbrk(lExtension, "/\\"))
+    {
+        *lExtension = '\0';
+    }
+    strcat(lSaveName, cSaveExtension);
+
+    lStatus = mSaveFile.Open(lSaveName, lSize);
+    if (lStatus != ErrorCodes::SUCCESS)
+    {
+        gErrorManager.Post(lStatus, lSaveName);
+        mPrgRam.Resize(lSize);
+        return;
+    }
+    mPrgRam.SetBuffer(mSaveFile.GetData(), lSize);
+}
+
+//--------//
+// EndFrame
+//
+// Starts writing out the save file if the game wrote to it during the frame. Doesn't
+// wait for the write to finish.
+//--------//
+//
+void Cartridge::EndFrame(void)
+{
+    if (mSaveDirty)
+    {
+        mSaveFile.Flush();
+        mSaveDirty = false;
+    }
+}
+
+//--------//
+// ApplyRomInfo
+//
+// Takes the mapper, mirroring, PRG RAM size and battery from the database over the
+// header's, and picks the renderer the game needs.
+//
+// param[in]        lInfo   Database entry for this image.
+// param[in,out]    lSizes  Sizes of the memories on the cartridge, from the header.
+//--------//
+//
+void Cartridge::ApplyRomInfo(const RomInfo * lInfo, Sizes & lSizes)
+{
+    CAPTURE_LOG("[i] Image found in ROM database\n");
+
+    mMapperId = lInfo->mMapperId;
+    if (lInfo->mMirroring != RomInfo::MIRROR_HEADER)
+    {
+        mMirroring = static_cast<Ppu2C02::Mirroring>(lInfo->mMirroring);
+    }
+    if (lInfo->mPrgRamBanks)
+    {
+        lSizes.mPrgRam   = lInfo->mPrgRamBanks * PRG_RAM_UNIT;
+        lSizes.mPrgNvram = 0;
+    }
+    mBattery      = mBattery || (lInfo->mFlags & RomInfo::BATTERY);
+    mDotRenderer  = lInfo->mFlags & RomInfo::DOT_RENDERER;
+    mLiveRenderer = lInfo->mFlags & RomInfo::LIVE_RENDERER;
+}
+
+//--------//
+// AllowsDeferredRenderer
+//
+// Checks if the game can be drawn at vblank from the logged ppu register writes. That
+// misses anything else changed mid-frame, so not for games the database says switch
+// CHR banks, mirroring or palette then, nor for boards with a scanline IRQ, which is
+// there to do just that.
+//
+// returns  True if the deferred and pipelined renderers draw this game correctly.
+//--------//
+//
+bool Cartridge::AllowsDeferredRenderer(void)
+{
+    return !mDotRenderer && !mLiveRenderer && !WatchesA12();
 }
 
 //--------//
 // Read
 //
-// Reads data from the system.
+// Reads data from the system. Whatever the mapper put in the page is read straight out.
 //
 // param[in] lAddress   Address to read from.
 // returns  Data at the given address. 
@@ -187,35 +431,27 @@ Cartridge::~Cartridge()
 //
 DataType Cartridge::Read(AddressType lAddress)
 {
-    AddressType lMappedAddress;
+    uint8_t * lPage = mPrgRead[lAddress >> PRG_PAGE_SHIFT];
 
     if (IsDisconnected())
     {
         return 0;
     }
 
-    // If mapper doesn't exit, cartridge file is likely invalid. Open bus behavior is to
-    //  return data last read.
-    if (nullptr == mMapper)
+    // Open bus behavior is to return data last read. That's also all there is without a
+    // mapper, when the cartridge file is likely invalid.
+    if (nullptr == lPage)
     {
         return mSystem->mLastRead;
     }
-
-    // If MapRead returns true, then read from program memory.
-    if (mMapper->MapRead(lAddress, &lMappedAddress, &mSystem->mLastRead))
-    {
-        return mPrgMemory.Read(lMappedAddress);
-    }
-
-    // If made it this far, we are either reading from ram, which is the out parameter
-    // of MapRead, or the cartridge doesn't care about the address being read.
-    return mSystem->mLastRead;
+    return lPage[lAddress & PRG_PAGE_MASK];
 }
 
 //--------//
 // Write
 //
-// Writes data to memory on the system.
+// Writes data to memory on the system. Writes to PRG RAM are stored straight away,
+// anything else in the cartridge's address range is a write to the mapper's registers.
 //
 // param[in] lAddress   Address to write to. 
 // param[in] lData      Data to write. 
@@ -223,18 +459,232 @@ DataType Cartridge::Read(AddressType lAddress)
 //
 void Cartridge::Write(AddressType lAddress, DataType lData)
 {
-    AddressType lMappedAddress;
+    uint8_t * lPage = mPrgWrite[lAddress >> PRG_PAGE_SHIFT];
 
     // If mapper doesn't exit, cartridge file is likely invalid and thus
     // this is a disconnected device.
-    if (nullptr == mMapper)
+    if (nullptr == mMapper || lAddress < mAddressStart)
+    {
+        return;
+    }
+
+    if (lPage)
+    {
+        lPage[lAddress & PRG_PAGE_MASK] = lData;
+        mSaveDirty = true;
+        return;
+    }
+    mMapper->WriteRegister(lAddress, lData);
+}
+
+//--------//
+// PpuRead
+//
+// Reads data from CHR memory on behalf of the ppu.
+//
+// param[in] lAddress   Ppu address to read from.
+// returns  Data at the given address. 
+//--------//
+//
+DataType Cartridge::PpuRead(AddressType lAddress)
+{
+    uint8_t * lPage;
+
+    if (lAddress >= (NUM_CHR_PAGES << Ppu2C02::PPU_PAGE_SHIFT))
+    {
+        return 0;
+    }
+
+    lPage = GetChrPageData(static_cast<uint8_t>(lAddress >> Ppu2C02::PPU_PAGE_SHIFT));
+    return lPage ? lPage[lAddress & Ppu2C02::PPU_PAGE_MASK] : 0;
+}
+
+//--------//
+// PpuWrite
+//
+// Writes data to CHR memory on behalf of the ppu. Only CHR RAM takes it.
+//
+// param[in] lAddress   Ppu address to write to. 
+// param[in] lData      Data to write. 
+//--------//
+//
+void Cartridge::PpuWrite(AddressType lAddress, DataType lData)
+{
+    uint32_t lOffset;
+
+    if (!mChrRam || lAddress >= (NUM_CHR_PAGES << Ppu2C02::PPU_PAGE_SHIFT))
+    {
+        return;
+    }
+
+    lOffset = mChrPages[lAddress >> Ppu2C02::PPU_PAGE_SHIFT];
+    if (lOffset == Ppu2C02::UNMAPPED_PAGE)
     {
         return;
     }
+    lOffset += lAddress & Ppu2C02::PPU_PAGE_MASK;
+    mChrMemory.GetBuffer()[lOffset] = lData;
+    mTileCache.Invalidate(lOffset);
+}
+
+//--------//
+// MapPrgRom
+//
+// Maps one 4KB page of the cpu's address space to PRG ROM. Writes there go to the mapper.
+//
+// param[in] lPage        Page number, 0-15 for $0000-$FFFF.
+// param[in] lPrgOffset   Offset in PRG ROM, UNMAPPED_PAGE or anything past the end leaves
+//                        the page as open bus.
+//--------//
+//
+void Cartridge::MapPrgRom(uint8_t lPage, uint32_t lPrgOffset)
+{
+    lPage &= NUM_PRG_PAGES - 1;
+    if (lPrgOffset >= mPrgMemory.GetSize() || mPrgMemory.GetSize() - lPrgOffset < PRG_PAGE_SIZE)
+    {
+        mPrgRead[lPage] = nullptr;
+    }
+    else
+    {
+        mPrgRead[lPage] = mPrgMemory.GetBuffer() + lPrgOffset;
+    }
+    mPrgWrite[lPage] = nullptr;
+}
+
+//--------//
+// MapPrgRam
+//
+// Maps one 4KB page of the cpu's address space to PRG RAM.
+//
+// param[in] lPage        Page number, 0-15 for $0000-$FFFF.
+// param[in] lRamOffset   Offset in PRG RAM, UNMAPPED_PAGE or anything past the end leaves
+//                        the page as open bus.
+// param[in] lWritable    If writes go to the RAM, otherwise they go to the mapper.
+//--------//
+//
+void Cartridge::MapPrgRam(uint8_t lPage, uint32_t lRamOffset, bool lWritable)
+{
+    lPage &= NUM_PRG_PAGES - 1;
+    if (lRamOffset >= mPrgRam.GetSize() || mPrgRam.GetSize() - lRamOffset < PRG_PAGE_SIZE)
+    {
+        mPrgRead[lPage] = nullptr;
+    }
+    else
+    {
+        mPrgRead[lPage] = mPrgRam.GetBuffer() + lRamOffset;
+    }
+    mPrgWrite[lPage] = lWritable ? mPrgRead[lPage] : nullptr;
+}
 
-    // If MapRead returns true, then write to program memory.
-    if (mMapper->MapWrite(lAddress, &lMappedAddress, lData))
+//--------//
+// PatchPrg
+//
+// Changes whatever is mapped at an address, ROM included. For tests that need to set
+// up vectors a ROM doesn't have.
+//
+// param[in] lAddress   Address to change.
+// param[in] lData      Data to put there.
+//--------//
+//
+void Cartridge::PatchPrg(AddressType lAddress, DataType lData)
+{
+    uint8_t * lPage = mPrgRead[lAddress >> PRG_PAGE_SHIFT];
+
+    if (lPage)
+    {
+        lPage[lAddress & PRG_PAGE_MASK] = lData;
+    }
+}
+
+//--------//
+// GetCpuCycles
+//
+// Gets the cpu cycle count, for mappers that care when writes happen.
+//
+// returns  Cpu cycles since power on, 0 if not in a system.
+//--------//
+//
+uint64_t Cartridge::GetCpuCycles(void)
+{
+    return mSystem ? mSystem->GetCpuCycles() : 0;
+}
+
+//--------//
+// SetIrq
+//
+// Drives the cartridge's part of the cpu's IRQ line.
+//
+// param[in] lAsserted   If the mapper wants an IRQ.
+//--------//
+//
+void Cartridge::SetIrq(bool lAsserted)
+{
+    if (mSystem)
+    {
+        mSystem->mCpu.SetIrq(Cpu6502::IRQ_CARTRIDGE, lAsserted);
+    }
+}
+
+//--------//
+// MapChrPage
+//
+// Maps one 1KB page of the pattern tables to CHR memory. Mappers call this whenever
+// they switch CHR banks, the ppu picks it up right away if it's connected.
+//
+// param[in] lPage        Page number, 0-7 for $0000-$1FFF.
+// param[in] lChrOffset   Offset in CHR memory, Ppu2C02::UNMAPPED_PAGE or anything past
+//                        the end leaves the page empty.
+//--------//
+//
+void Cartridge::MapChrPage(uint8_t lPage, uint32_t lChrOffset)
+{
+    lPage &= NUM_CHR_PAGES - 1;
+    if (lChrOffset >= mChrMemory.GetSize() || mChrMemory.GetSize() - lChrOffset < Ppu2C02::PPU_PAGE_SIZE)
+    {
+        lChrOffset = Ppu2C02::UNMAPPED_PAGE;
+    }
+    mChrPages[lPage] = lChrOffset;
+
+    if (mSystem)
+    {
+        mSystem->mPpu.SetPatternPage(lPage, GetChrPageData(lPage), lChrOffset);
+    }
+}
+
+//--------//
+// GetChrPageData
+//
+// Gets the memory behind one 1KB page of the pattern tables.
+//
+// param[in] lPage   Page number, 0-7.
+// returns  Start of the page, nullptr if nothing is mapped there.
+//--------//
+//
+uint8_t * Cartridge::GetChrPageData(uint8_t lPage)
+{
+    uint32_t lOffset = mChrPages[lPage & (NUM_CHR_PAGES - 1)];
+
+    if (lOffset == Ppu2C02::UNMAPPED_PAGE || nullptr == mChrMemory.GetBuffer())
+    {
+        return nullptr;
+    }
+    return mChrMemory.GetBuffer() + lOffset;
+}
+
+//--------//
+// SetMirroring
+//
+// Changes the name table mirroring. Mappers with mirroring control call this whenever
+// their register is written, the ppu picks it up right away if it's connected.
+//
+// param[in] lMirroring   The new mirroring.
+//--------//
+//
+void Cartridge::SetMirroring(Ppu2C02::Mirroring lMirroring)
+{
+    mMirroring = lMirroring;
+    if (mSystem)
     {
-        mPrgMemory.Write(lMappedAddress, lData);
+        mSystem->mPpu.SetMirroring(lMirroring);
     }
 }
@@ -0,0 +1,195 @@
+/////////////////////////////////////////////////////////////////////
+//
+// ChrTileCache.cpp
+//
+// Implementation file for the decoded CHR tile cache.
+//
+/////////////////////////////////////////////////////////////////////
+
+#include <ChrTileCache.hpp>
+#include <PixelKernels.hpp>
+
+const uint8_t ChrTileCache::cBlankRow[ChrTileCache::TILE_WIDTH] = {0};
+
+//--------//
+//
+// ChrTileCache
+//
+//--------//
+
+//--------//
+// ChrTileCache
+//
+// Constructor.
+//
+// param[in]    lChrMemory  CHR memory the tiles are decoded from.
+//--------//
+//
+ChrTileCache::ChrTileCache(Memory & lChrMemory)
+  : mChrMemory(lChrMemory),
+    mDecoded(nullptr),
+    mStale(nullptr),
+    mNumTiles(0)
+{
+}
+
+//--------//
+// ~ChrTileCache
+//
+// Destructor.
+//--------//
+//
+ChrTileCache::~ChrTileCache(void)
+{
+    Resize(0);
+}
+
+//--------//
+// Resize
+//
+// Sizes the cache to cover the given amount of CHR memory. Every tile starts
+// out stale so nothing is decoded until it's first drawn.
+//
+// param[in]    lChrSize    Size of CHR memory in bytes.
+//--------//
+//
+void ChrTileCache::Resize(uint32_t lChrSize)
+{
+    if (mDecoded)
+    {
+        delete [] mDecoded;
+        mDecoded = nullptr;
+    }
+    if (mStale)
+    {
+        delete [] mStale;
+        mStale = nullptr;
+    }
+    mNumTiles = 0;
+
+    if (lChrSize == 0)
+    {
+        return;
+    }
+
+    mDecoded = new(std::nothrow) uint8_t[(lChrSize >> TILE_SHIFT) * DECODED_SIZE];
+    mStale   = new(std::nothrow) bool[lChrSize >> TILE_SHIFT];
+    if (nullptr == mDecoded || nullptr == mStale)
+    {
+        Resize(0);
+        gErrorManager.Post(ErrorCodes::OUT_OF_MEMORY);
+        return;
+    }
+
+    mNumTiles = lChrSize >> TILE_SHIFT;
+    InvalidateAll();
+}
+
+//--------//
+// Invalidate
+//
+// Marks the tile holding a CHR byte as stale, to be called whenever CHR RAM is written.
+//
+// param[in]    lChrOffset  Offset of the written byte in CHR memory.
+//--------//
+//
+void ChrTileCache::Invalidate(uint32_t lChrOffset)
+{
+    if ((lChrOffset >> TILE_SHIFT) < mNumTiles)
+    {
+        mStale[lChrOffset >> TILE_SHIFT] = true;
+    }
+}
+
+//--------//
+// InvalidateAll
+//
+// Marks every tile as stale.
+//--------//
+//
+void ChrTileCache::InvalidateAll(void)
+{
+    for (uint32_t lTile = 0; lTile < mNumTiles; ++lTile)
+    {
+        mStale[lTile] = true;
+    }
+}
+
+//--------//
+// GetRow
+//
+// Gets one decoded row of a tile, decoding the tile first if it's stale.
+//
+// param[in]    lChrOffset  Offset in CHR memory of the row's low bitplane byte.
+// param[in]    lFlip       Should the row be horizontally flipped.
+// returns  TILE_WIDTH pixels (0-3), leftmost first.
+//--------//
+//
+const uint8_t * ChrTileCache::GetRow(uint32_t lChrOffset, bool lFlip)
+{
+    uint32_t lTile = lChrOffset >> TILE_SHIFT;
+
+    if (lTile >= mNumTiles)
+    {
+        return cBlankRow;
+    }
+
+    if (mStale[lTile])
+    {
+        DecodeTile(lTile);
+    }
+
+    return mDecoded + (lTile * DECODED_SIZE) + (lFlip ? FLIPPED_OFFSET : 0) + ((lChrOffset & ROW_MASK) * TILE_WIDTH);
+}
+
+//--------//
+// DecodeRange
+//
+// Decodes every stale tile in a range of CHR memory up front. Once that's done, GetRow
+// for those tiles only reads, so several threads can draw from them at once.
+//
+// param[in]    lChrOffset  Start of the range in CHR memory.
+// param[in]    lSize       Size of the range in bytes.
+//--------//
+//
+void ChrTileCache::DecodeRange(uint32_t lChrOffset, uint32_t lSize)
+{
+    uint32_t lLast = (lChrOffset + lSize) >> TILE_SHIFT;
+
+    if (lLast > mNumTiles)
+    {
+        lLast = mNumTiles;
+    }
+
+    for (uint32_t lTile = lChrOffset >> TILE_SHIFT; lTile < lLast; ++lTile)
+    {
+        if (mStale[lTile])
+        {
+            DecodeTile(lTile);
+        }
+    }
+}
+
+//--------//
+// DecodeTile
+//
+// Merges the two bitplanes of a tile into pixels, storing both the normal and
+// flipped copy of each row.
+//
+// param[in]    lTile   Tile number within CHR memory.
+//--------//
+//
+void ChrTileCache::DecodeTile(uint32_t lTile)
+{
+    uint32_t                        lBase      = lTile << TILE_SHIFT;
+    uint8_t *                       lOut       = mDecoded + (lTile * DECODED_SIZE);
+    PixelKernels::DecodeRowFunction lDecodeRow = PixelKernels::Get().mDecodeRow;
+
+    for (int lRow = 0; lRow < TILE_ROWS; ++lRow)
+    {
+        lDecodeRow(mChrMemory.Read(lBase + lRow), mChrMemory.Read(lBase + lRow + PLANE_OFFSET),
+                   lOut + (lRow * TILE_WIDTH), lOut + FLIPPED_OFFSET + (lRow * TILE_WIDTH));
+    }
+
+    mStale[lTile] = false;
+}
@@ -81,6 +81,11 @@ Cpu6502::Cpu6502()
     },
 #endif
     mHalted(false),
+    mNmiPending(false),
+    mIrqLine(0),
+    mStallPending(0),
+    mStallCycles(0),
+    mOddCycle(false),
     mInterruptVectors
     {
         {0xFFFA, 0xFFFB},
@@ -148,7 +153,8 @@ void Cpu6502::Write(AddressType lAddress, DataType lData)
 // operations execute fully on the "first" clock cycle of that
 // instruction. If an instruction is in progress (indicated by
 // the mCyclesLeft variable), then just decrement the counter and
-// do nothing else.
+// do nothing else. A DMA started by an instruction holds off the
+// next one until its cycles have passed.
 //--------//
 //
 void Cpu6502::StepClock()
@@ -162,6 +168,36 @@ void Cpu6502::StepClock()
         return;
     }
 
+    mOddCycle = !mOddCycle;
+
+    // The instruction that started a DMA is done, the DMA takes over the bus from here. Landing
+    // on an odd cycle costs one more to line up with the reads.
+    if (mCyclesLeft == 0 && mStallPending)
+    {
+        mStallCycles += mStallPending + (mOddCycle ? 1 : 0);
+        mStallPending = 0;
+    }
+    if (mStallCycles)
+    {
+        --mStallCycles;
+#ifdef TEST_CPU
+        ++mTotalCycles;
+#endif
+        return;
+    }
+
+    // An NMI was signaled while the last instruction was in progress. Service it now
+    // that the instruction boundary has been reached.
+    if (mCyclesLeft == 0 && mNmiPending)
+    {
+        mNmiPending = false;
+        NMI();
+    }
+    else if (mCyclesLeft == 0 && mIrqLine && GetFlag(Flags::I) == 0)
+    {
+        IRQ();
+    }
+
     // No instruction is in progress, so perform fetch-decode-execute.
     if (mCyclesLeft == 0)
     {
@@ -297,7 +333,12 @@ void Cpu6502::IRQ()
 void Cpu6502::Reset()
 {
     // Reset is the only thing that will reset this flag.
-    mHalted = false;
+    mHalted       = false;
+    mNmiPending   = false;
+    mIrqLine      = 0;
+    mStallPending = 0;
+    mStallCycles  = 0;
+    mOddCycle     = false;
 
     // Reset registers and internals.
     mOpcode             = 0x1A;                 // NOP - Implied. Souldn't matter since PC will jump to some other Opcode.
@@ -0,0 +1,86 @@
+/////////////////////////////////////////////////////////////////////
+//
+// Crc32.cpp
+//
+// Implementation file for CRC-32 checksums.
+//
+/////////////////////////////////////////////////////////////////////
+
+#include <Crc32.hpp>
+
+//========//
+// CrcTables
+//
+// Table n holds the CRC of each byte followed by n zero bytes, so eight bytes can be
+// looked up independently and combined.
+//========//
+//
+struct CrcTables
+{
+    CrcTables(void)
+    {
+        for (uint32_t lByte = 0; lByte < Crc32::TABLE_SIZE; ++lByte)
+        {
+            uint32_t lCrc = lByte;
+            for (int lBit = 0; lBit < 8; ++lBit)
+            {
+                lCrc = (lCrc >> 1) ^ ((lCrc & 1) ? Crc32::POLYNOMIAL : 0);
+            }
+            mTable[0][lByte] = lCrc;
+        }
+        for (uint32_t lByte = 0; lByte < Crc32::TABLE_SIZE; ++lByte)
+        {
+            for (uint32_t lTable = 1; lTable < Crc32::NUM_TABLES; ++lTable)
+            {
+                uint32_t lPrevious     = mTable[lTable - 1][lByte];
+                mTable[lTable][lByte]  = (lPrevious >> 8) ^ mTable[0][lPrevious & 0xFF];
+            }
+        }
+    }
+
+    uint32_t mTable[Crc32::NUM_TABLES][Crc32::TABLE_SIZE];
+};
+
+static const CrcTables cTables;
+
+//--------//
+//
+// Crc32
+//
+//--------//
+
+//--------//
+// Update
+//
+// Adds a block of data to the checksum.
+//
+// param[in]    lData   Data to add.
+// param[in]    lSize   Number of bytes.
+//--------//
+//
+void Crc32::Update(const uint8_t * lData, size_t lSize)
+{
+    const uint32_t (*lTable)[TABLE_SIZE] = cTables.mTable;
+    uint32_t         lCrc                = mCrc;
+
+    while (lSize >= 8)
+    {
+        uint32_t lLow  = lCrc ^ (lData[0] | (lData[1] << 8) | (lData[2] << 16) | (static_cast<uint32_t>(lData[3]) << 24));
+        uint32_t lHigh = lData[4] | (lData[5] << 8) | (lData[6] << 16) | (static_cast<uint32_t>(lData[7]) << 24);
+
+        lCrc = lTable[7][lLow & 0xFF]         ^ lTable[6][(lLow >> 8) & 0xFF]  ^
+               lTable[5][(lLow >> 16) & 0xFF] ^ lTable[4][lLow >> 24]          ^
+               lTable[3][lHigh & 0xFF]        ^ lTable[2][(lHigh >> 8) & 0xFF] ^
+               lTable[1][(lHigh >> 16) & 0xFF] ^ lTable[0][lHigh >> 24];
+
+        lData += 8;
+        lSize -= 8;
+    }
+
+    while (lSize--)
+    {
+        lCrc = (lCrc >> 8) ^ lTable[0][(lCrc ^ *lData++) & 0xFF];
+    }
+
+    mCrc = lCrc;
+}
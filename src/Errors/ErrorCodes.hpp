@@ -41,6 +41,9 @@ enum ErrorCodes
     // Window errors
     WINDOW_FAIL_INIT,
 
+    // Audio errors
+    AUDIO_FAIL_INIT,
+
     NUM_ERRORS
 };
 
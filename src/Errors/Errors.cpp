@@ -49,6 +49,9 @@ ErrorManager::ErrorManager()
 
     // Window errors.
     mErrorDefs[WINDOW_FAIL_INIT]  = {"[!] %d, Failed to initialize window\n", sizeof("[!] %d, Failed to initialize window\n"), ErrorDefinition::NORMAL};
+
+    // Audio errors.
+    mErrorDefs[AUDIO_FAIL_INIT]   = {"[!] %d, Failed to initialize audio device\n", sizeof("[!] %d, Failed to initialize audio device\n"), ErrorDefinition::NORMAL};
 }
 
 //--------//
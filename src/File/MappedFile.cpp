@@ -0,0 +1,197 @@
+/////////////////////////////////////////////////////////////////////
+//
+// MappedFile.cpp
+//
+// Implementation file for memory mapped files.
+//
+/////////////////////////////////////////////////////////////////////
+
+#include <File/MappedFile.hpp>
+#include <Errors/ErrorCodes.hpp>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+//--------//
+//
+// MappedFile
+//
+//--------//
+
+//--------//
+// MappedFile
+//
+// Constructor.
+//--------//
+//
+MappedFile::MappedFile(void)
+  : mData(nullptr),
+    mSize(0),
+#ifdef _WIN32
+    mFile(INVALID_HANDLE_VALUE),
+    mMapping(nullptr)
+#else
+    mDescriptor(-1)
+#endif
+{
+}
+
+//--------//
+// ~MappedFile
+//
+// Destructor.
+//--------//
+//
+MappedFile::~MappedFile(void)
+{
+    Close();
+}
+
+//--------//
+// Open
+//
+// Opens a file and maps it into memory, creating it or growing it with zeros if it's
+// smaller than asked for.
+//
+// param[in] lFilename   Name of the file to open.
+// param[in] lSize       Bytes to map.
+// returns  Status on the operation.
+//--------//
+//
+int MappedFile::Open(const char * lFilename, size_t lSize)
+{
+    if (IsOpen())
+    {
+        return ErrorCodes::FILE_ALREADY_OPENED;
+    }
+
+#ifdef _WIN32
+    mFile = CreateFileA(lFilename, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS,
+                        FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (mFile == INVALID_HANDLE_VALUE)
+    {
+        return ErrorCodes::FILE_COULD_NOT_OPEN;
+    }
+
+    // Mapping more than the file holds grows it.
+    mMapping = CreateFileMappingA(mFile, nullptr, PAGE_READWRITE, 0, static_cast<DWORD>(lSize), nullptr);
+    if (nullptr == mMapping)
+    {
+        Close();
+        return ErrorCodes::FILE_WRITE_ERROR;
+    }
+
+    mData = static_cast<uint8_t *>(MapViewOfFile(mMapping, FILE_MAP_ALL_ACCESS, 0, 0, lSize));
+    if (nullptr == mData)
+    {
+        Close();
+        return ErrorCodes::FILE_READ_ERROR;
+    }
+#else
+    struct stat lStat;
+    void *      lData;
+
+    mDescriptor = open(lFilename, O_RDWR | O_CREAT, 0644);
+    if (mDescriptor < 0)
+    {
+        return ErrorCodes::FILE_COULD_NOT_OPEN;
+    }
+
+    if (fstat(mDescriptor, &lStat) != 0 ||
+        (static_cast<size_t>(lStat.st_size) < lSize && ftruncate(mDescriptor, lSize) != 0))
+    {
+        Close();
+        return ErrorCodes::FILE_WRITE_ERROR;
+    }
+
+    lData = mmap(nullptr, lSize, PROT_READ | PROT_WRITE, MAP_SHARED, mDescriptor, 0);
+    if (lData == MAP_FAILED)
+    {
+        Close();
+        return ErrorCodes::FILE_READ_ERROR;
+    }
+    mData = static_cast<uint8_t *>(lData);
+#endif
+
+    mSize = lSize;
+    return ErrorCodes::SUCCESS;
+}
+
+//--------//
+// Flush
+//
+// Starts writing out whatever has changed, without waiting for it to finish.
+//--------//
+//
+void MappedFile::Flush(void)
+{
+    if (!IsOpen())
+    {
+        return;
+    }
+
+#ifdef _WIN32
+    FlushViewOfFile(mData, mSize);
+#else
+    msync(mData, mSize, MS_ASYNC);
+#endif
+}
+
+//--------//
+// Close
+//
+// Unmaps and closes the file. Changes still in memory get written out by the operating
+// system afterwards.
+//
+// returns  Status on the operation.
+//--------//
+//
+int MappedFile::Close(void)
+{
+    int lStatus = ErrorCodes::SUCCESS;
+
+    Flush();
+
+#ifdef _WIN32
+    if (mData)
+    {
+        UnmapViewOfFile(mData);
+    }
+    if (mMapping)
+    {
+        CloseHandle(mMapping);
+        mMapping = nullptr;
+    }
+    if (mFile != INVALID_HANDLE_VALUE)
+    {
+        if (!CloseHandle(mFile))
+        {
+            lStatus = ErrorCodes::FILE_COULD_NOT_CLOSE;
+        }
+        mFile = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (mData)
+    {
+        munmap(mData, mSize);
+    }
+    if (mDescriptor >= 0)
+    {
+        if (close(mDescriptor) != 0)
+        {
+            lStatus = ErrorCodes::FILE_COULD_NOT_CLOSE;
+        }
+        mDescriptor = -1;
+    }
+#endif
+
+    mData = nullptr;
+    mSize = 0;
+    return lStatus;
+}
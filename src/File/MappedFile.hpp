@@ -0,0 +1,50 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// MappedFile.hpp
+//
+// Files mapped straight into memory.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+//========//
+// MappedFile
+//
+// A file mapped into memory, shared with the file itself. Writes to the memory are the
+// writes to the file, the operating system copies dirty pages out on its own time.
+// Flush only asks for that to start sooner, it doesn't wait for the disk.
+//========//
+//
+class MappedFile
+{
+    public:
+
+        MappedFile(void);
+        ~MappedFile(void);
+
+        int       Open(const char * lFilename, size_t lSize);
+        void      Flush(void);
+        int       Close(void);
+
+        uint8_t * GetData(void)    {return mData;}
+        size_t    GetSize(void)    {return mSize;}
+        bool      IsOpen(void)     {return nullptr != mData;}
+
+    protected:
+
+        uint8_t * mData;        // The mapped memory.
+        size_t    mSize;        // How much of the file is mapped.
+#ifdef _WIN32
+        void *    mFile;        // File handle.
+        void *    mMapping;     // File mapping handle.
+#else
+        int       mDescriptor;  // File descriptor.
+#endif
+};
+
+#endif
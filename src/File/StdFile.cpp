@@ -62,7 +62,7 @@ int StdFile::Open(const char * lFilename, const char * lMode)
     mFileHandle = fopen(lFilename, lMode);
 
     // Open failed for some reason.
-    if (nullptr != mFileHandle)
+    if (nullptr == mFileHandle)
     {
         mStatus = ErrorCodes::FILE_COULD_NOT_OPEN;
         return mStatus;
@@ -84,7 +84,7 @@ int StdFile::Open(const char * lFilename, const char * lMode)
 int StdFile::Close()
 {
     // Don't try closing a file if the file handle doesn't exist.
-    if (nullptr != mFileHandle)
+    if (nullptr == mFileHandle)
     {
         mStatus = ErrorCodes::FILE_ALREADY_CLOSED;
         return mStatus;
@@ -125,7 +125,7 @@ size_t StdFile::Read(void * lBuffer, size_t lCount)
     size_t lNumRead;
 
     // Don't try reading from a file if the file handle doesn't exist.
-    if (nullptr != mFileHandle)
+    if (nullptr == mFileHandle)
     {
         mStatus = ErrorCodes::FILE_ALREADY_CLOSED;
         return mStatus;
@@ -180,7 +180,7 @@ size_t StdFile::Write(void * lBuffer, size_t lCount)
     size_t lNumWrote;
 
     // Don't try reading from a file if the file handle doesn't exist.
-    if (nullptr != mFileHandle)
+    if (nullptr == mFileHandle)
     {
         mStatus = ErrorCodes::FILE_ALREADY_CLOSED;
         return mStatus;
@@ -271,7 +271,7 @@ int StdFile::SeekFromEnd(long int lOffset)
 int StdFile::SeekHelper(long int lOffset, int lMode)
 {
     // Don't try seeking if the file handle doesn't exist.
-    if (nullptr != mFileHandle)
+    if (nullptr == mFileHandle)
     {
         mStatus = ErrorCodes::FILE_ALREADY_CLOSED;
         return mStatus;
@@ -304,7 +304,7 @@ int StdFile::SeekHelper(long int lOffset, int lMode)
 int StdFile::Tell(long int * lPosition)
 {
     // Don't try telling if the file handle doesn't exist.
-    if (nullptr != mFileHandle)
+    if (nullptr == mFileHandle)
     {
         mStatus = ErrorCodes::FILE_ALREADY_CLOSED;
         return mStatus;
@@ -0,0 +1,246 @@
+/////////////////////////////////////////////////////////////////////
+//
+// FrameConverter.cpp
+//
+// Implementation file for the frame output stage.
+//
+/////////////////////////////////////////////////////////////////////
+
+#include <FrameConverter.hpp>
+#include <PixelKernels.hpp>
+#include <Ppu2C02.hpp>
+
+// RGB of every color the 2C02 can output.
+const uint8_t FrameConverter::cSystemPalette[FrameConverter::NUM_COLORS][3] =
+{
+    { 84,  84,  84}, {  0,  30, 116}, {  8,  16, 144}, { 48,   0, 136}, { 68,   0, 100}, { 92,   0,  48}, { 84,   4,   0}, { 60,  24,   0},
+    { 32,  42,   0}, {  8,  58,   0}, {  0,  64,   0}, {  0,  60,   0}, {  0,  50,  60}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0},
+    {152, 150, 152}, {  8,  76, 196}, { 48,  50, 236}, { 92,  30, 228}, {136,  20, 176}, {160,  20, 100}, {152,  34,  32}, {120,  60,   0},
+    { 84,  90,   0}, { 40, 114,   0}, {  8, 124,   0}, {  0, 118,  40}, {  0, 102, 120}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0},
+    {236, 238, 236}, { 76, 154, 236}, {120, 124, 236}, {176,  98, 236}, {228,  84, 236}, {236,  88, 180}, {236, 106, 100}, {212, 136,  32},
+    {160, 170,   0}, {116, 196,   0}, { 76, 208,  32}, { 56, 204, 108}, { 56, 180, 204}, { 60,  60,  60}, {  0,   0,   0}, {  0,   0,   0},
+    {236, 238, 236}, {168, 204, 236}, {188, 188, 236}, {212, 178, 236}, {236, 174, 236}, {236, 174, 212}, {236, 180, 176}, {228, 196, 144},
+    {204, 210, 120}, {180, 222, 120}, {168, 226, 144}, {152, 226, 180}, {160, 214, 228}, {160, 162, 160}, {  0,   0,   0}, {  0,   0,   0}
+};
+
+//--------//
+//
+// FrameConverter
+//
+//--------//
+
+//--------//
+// FrameConverter
+//
+// Constructor.
+//--------//
+//
+FrameConverter::FrameConverter(void)
+  : mFormat(FORMAT_NONE),
+    mColors(nullptr),
+    mLineMasks(nullptr),
+    mWidth(0),
+    mOut(nullptr)
+{
+    for (int lBand = 0; lBand < MAX_THREADS; ++lBand)
+    {
+        mBands[lBand].mConverter = this;
+        mBandJobs[lBand]         = &mBands[lBand];
+    }
+    BuildTables();
+}
+
+//--------//
+// SetFormat
+//
+// Picks the output pixel format and rebuilds the lookup tables for it.
+//
+// param[in]    lFormat     The pixel format.
+//--------//
+//
+void FrameConverter::SetFormat(PixelFormat lFormat)
+{
+    mFormat = lFormat;
+    BuildTables();
+}
+
+//--------//
+// GetBytesPerPixel
+//
+// Gets the size of one output pixel.
+//
+// returns  Bytes per pixel, 0 for FORMAT_NONE.
+//--------//
+//
+int FrameConverter::GetBytesPerPixel(void)
+{
+    switch (mFormat)
+    {
+        case FORMAT_RGBA8888:
+        case FORMAT_BGRA8888:
+            return sizeof(uint32_t);
+
+        case FORMAT_RGB565:
+            return sizeof(uint16_t);
+
+        default:
+            return 0;
+    }
+}
+
+//--------//
+// SetThreads
+//
+// Sets how many bands of rows are converted at the same time, including the one on the
+// thread calling Convert.
+//
+// param[in]    lThreads    Number of threads, clamped to 1-MAX_THREADS.
+//--------//
+//
+void FrameConverter::SetThreads(int lThreads)
+{
+    if (lThreads < 1)
+    {
+        lThreads = 1;
+    }
+    if (lThreads > MAX_THREADS)
+    {
+        lThreads = MAX_THREADS;
+    }
+    mPool.SetThreads(lThreads);
+}
+
+//--------//
+// Convert
+//
+// Converts a whole frame. Does nothing for FORMAT_NONE.
+//
+// param[in]    lColors     lWidth * lHeight system palette colors.
+// param[in]    lLineMasks  PPUMASK of each row.
+// param[in]    lWidth      Pixels per row.
+// param[in]    lHeight     Number of rows.
+// param[out]   lOut        lWidth * lHeight pixels in the current format, rows packed together.
+//--------//
+//
+void FrameConverter::Convert(const uint8_t * lColors, const uint8_t * lLineMasks, int lWidth, int lHeight, void * lOut)
+{
+    int lThreads = mPool.GetThreads();
+    int lBand;
+
+    if (mFormat == FORMAT_NONE)
+    {
+        return;
+    }
+
+    if (lThreads == 1)
+    {
+        ConvertRows(lColors, lLineMasks, lWidth, 0, lHeight, lOut);
+        return;
+    }
+
+    // The kernels are picked on first use, do it before the threads start.
+    PixelKernels::Get();
+
+    mColors    = lColors;
+    mLineMasks = lLineMasks;
+    mWidth     = lWidth;
+    mOut       = lOut;
+
+    lBand = (lHeight + lThreads - 1) / lThreads;
+    for (int lIndex = 0; lIndex < lThreads; ++lIndex)
+    {
+        mBands[lIndex].mFirst = (lIndex * lBand < lHeight) ? lIndex * lBand : lHeight;
+        mBands[lIndex].mLast  = (mBands[lIndex].mFirst + lBand < lHeight) ? mBands[lIndex].mFirst + lBand : lHeight;
+    }
+    mPool.Run(mBandJobs, lThreads);
+}
+
+//--------//
+// BuildTables
+//
+// Fills in the output pixel of every color for every emphasis setting. Each emphasis
+// bit dims the two other channels.
+//--------//
+//
+void FrameConverter::BuildTables(void)
+{
+    uint32_t lRed;
+    uint32_t lGreen;
+    uint32_t lBlue;
+
+    for (int lEmphasis = 0; lEmphasis < NUM_EMPHASIS; ++lEmphasis)
+    {
+        for (int lColor = 0; lColor < NUM_COLORS; ++lColor)
+        {
+            lRed   = cSystemPalette[lColor][0];
+            lGreen = cSystemPalette[lColor][1];
+            lBlue  = cSystemPalette[lColor][2];
+
+            if (lEmphasis & (Ppu2C02::RED >> EMPHASIS_SHIFT))
+            {
+                lGreen = (lGreen * EMPHASIS_DIM) >> 8;
+                lBlue  = (lBlue  * EMPHASIS_DIM) >> 8;
+            }
+            if (lEmphasis & (Ppu2C02::GREEN >> EMPHASIS_SHIFT))
+            {
+                lRed   = (lRed   * EMPHASIS_DIM) >> 8;
+                lBlue  = (lBlue  * EMPHASIS_DIM) >> 8;
+            }
+            if (lEmphasis & (Ppu2C02::BLUE >> EMPHASIS_SHIFT))
+            {
+                lRed   = (lRed   * EMPHASIS_DIM) >> 8;
+                lGreen = (lGreen * EMPHASIS_DIM) >> 8;
+            }
+
+            switch (mFormat)
+            {
+                case FORMAT_BGRA8888:
+                    mTables[lEmphasis][lColor] = 0xFF000000 | (lRed << 16) | (lGreen << 8) | lBlue;
+                    break;
+
+                case FORMAT_RGB565:
+                    mTables[lEmphasis][lColor] = ((lRed >> 3) << 11) | ((lGreen >> 2) << 5) | (lBlue >> 3);
+                    break;
+
+                default:
+                    mTables[lEmphasis][lColor] = 0xFF000000 | (lBlue << 16) | (lGreen << 8) | lRed;
+                    break;
+            }
+        }
+    }
+}
+
+//--------//
+// ConvertRows
+//
+// Converts a band of rows.
+//
+// param[in]    lColors     System palette colors of the whole frame.
+// param[in]    lLineMasks  PPUMASK of each row.
+// param[in]    lWidth      Pixels per row.
+// param[in]    lFirst      First row to convert.
+// param[in]    lLast       One past the last row to convert.
+// param[out]   lOut        Output pixels of the whole frame.
+//--------//
+//
+void FrameConverter::ConvertRows(const uint8_t * lColors, const uint8_t * lLineMasks, int lWidth, int lFirst, int lLast, void * lOut)
+{
+    const PixelKernels::Table & lKernels = PixelKernels::Get();
+    const uint32_t *            lTable;
+    uint8_t                     lColorMask;
+
+    for (int lRow = lFirst; lRow < lLast; ++lRow)
+    {
+        lTable     = mTables[lLineMasks[lRow] >> EMPHASIS_SHIFT];
+        lColorMask = (lLineMasks[lRow] & Ppu2C02::GREYSCALE) ? GREYSCALE_MASK : COLOR_MASK;
+
+        if (mFormat == FORMAT_RGB565)
+        {
+            lKernels.mLookupColors16(lColors + (lRow * lWidth), lColorMask, lTable, static_cast<uint16_t *>(lOut) + (lRow * lWidth), lWidth);
+        }
+        else
+        {
+            lKernels.mLookupColors32(lColors + (lRow * lWidth), lColorMask, lTable, static_cast<uint32_t *>(lOut) + (lRow * lWidth), lWidth);
+        }
+    }
+}
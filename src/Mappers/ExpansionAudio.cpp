@@ -0,0 +1,63 @@
+/////////////////////////////////////////////////////////////////////
+//
+// ExpansionAudio.cpp
+//
+// Implementation file for cartridge sound chips.
+//
+/////////////////////////////////////////////////////////////////////
+
+#include <Mappers/ExpansionAudio.hpp>
+#include <Apu2A03.hpp>
+
+//--------//
+//
+// ExpansionAudio
+//
+//--------//
+
+//--------//
+// Reset
+//
+// Silences the chip and starts its time over. Chips with state of their own should
+// reset it too, then call this.
+//
+// param[in]    lTime   Cpu cycle the chip starts from.
+//--------//
+//
+void ExpansionAudio::Reset(uint64_t lTime)
+{
+    mTime       = lTime;
+    mLastOutput = 0;
+}
+
+//--------//
+// Sync
+//
+// Catches the apu up to the cpu, which runs the chip up to there as well.
+//--------//
+//
+void ExpansionAudio::Sync(void)
+{
+    if (mApu)
+    {
+        mApu->Sync();
+    }
+}
+
+//--------//
+// SetOutput
+//
+// Hands a change in the chip's output to the apu, as a step in its blip buffer.
+//
+// param[in]    lTime       Cpu cycle the output changed on.
+// param[in]    lOutput     The chip's new output.
+//--------//
+//
+void ExpansionAudio::SetOutput(uint64_t lTime, int32_t lOutput)
+{
+    if (lOutput != mLastOutput && mApu)
+    {
+        mApu->AddExpansionDelta(lTime, lOutput - mLastOutput);
+        mLastOutput = lOutput;
+    }
+}
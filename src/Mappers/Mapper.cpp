@@ -6,8 +6,13 @@
 //
 /////////////////////////////////////////////////////////////////////
 
+#include <new>
 #include <cstddef>
 #include <Mappers/Mapper_000.hpp>
+#include <Mappers/Mapper_001.hpp>
+#include <Mappers/Mapper_004.hpp>
+#include <Mappers/DiscreteMapper.hpp>
+#include <Cartridge.hpp>
 
 //--------//
 // MapperFactory
@@ -19,19 +24,168 @@
 // returns  Dynamically created mapper. Calling functions owns the memory.
 //--------//
 //
-Mapper * MapperFactory(uint8_t lMapperId, Cartridge * lCartridge)
+Mapper * MapperFactory(uint16_t lMapperId, Cartridge * lCartridge)
 {
     Mapper * lMapper;
 
     switch (lMapperId)
     {
         case 0:
-            lMapper = new Mapper000(lCartridge);
+            lMapper = new(std::nothrow) Mapper000(lCartridge);
             break;
-        
+
+        case 1:
+            lMapper = new(std::nothrow) Mapper001(lCartridge);
+            break;
+
+        case 2:
+            lMapper = new(std::nothrow) Mapper002(lCartridge);
+            break;
+
+        case 3:
+            lMapper = new(std::nothrow) Mapper003(lCartridge);
+            break;
+
+        case 4:
+            lMapper = new(std::nothrow) Mapper004(lCartridge);
+            break;
+
+        case 7:
+            lMapper = new(std::nothrow) Mapper007(lCartridge);
+            break;
+
+        case 11:
+            lMapper = new(std::nothrow) Mapper011(lCartridge);
+            break;
+
+        case 66:
+            lMapper = new(std::nothrow) Mapper066(lCartridge);
+            break;
+
         default:
             lMapper = nullptr;
     }
 
     return lMapper;
 }
+
+//--------//
+//
+// Mapper
+//
+//--------//
+
+//--------//
+// SetPrgBank
+//
+// Maps a bank of PRG ROM into the cpu's address space. ROM smaller than the bank is
+// repeated to fill it.
+//
+// param[in]    lAddress    Cpu address the bank starts at, a multiple of its size.
+// param[in]    lSize       Size of the bank, a multiple of 4KB.
+// param[in]    lBank       Bank number, wrapped around the banks there are.
+//--------//
+//
+void Mapper::SetPrgBank(AddressType lAddress, uint32_t lSize, int lBank)
+{
+    uint32_t lRomSize = mCartridge->GetPrgRomSize();
+    uint32_t lOffset  = GetBankOffset(lRomSize, lSize, lBank);
+    uint8_t  lPage    = static_cast<uint8_t>(lAddress >> Cartridge::PRG_PAGE_SHIFT);
+
+    for (uint32_t lIndex = 0; lIndex < lSize; lIndex += Cartridge::PRG_PAGE_SIZE, ++lPage)
+    {
+        mCartridge->MapPrgRom(lPage, lRomSize ? (lOffset + lIndex) % lRomSize : Cartridge::UNMAPPED_PAGE);
+    }
+}
+
+//--------//
+// SetPrgRam8k
+//
+// Maps an 8KB bank of PRG RAM into the cpu's address space.
+//
+// param[in]    lAddress    Cpu address the bank starts at, a multiple of 8KB.
+// param[in]    lBank       Bank number, wrapped around the banks there are.
+// param[in]    lWritable   If writes go to the RAM, otherwise they go to the mapper.
+//--------//
+//
+void Mapper::SetPrgRam8k(AddressType lAddress, int lBank, bool lWritable)
+{
+    uint32_t lRamSize = mCartridge->GetPrgRamSize();
+    uint32_t lOffset  = GetBankOffset(lRamSize, 0x2000, lBank);
+    uint8_t  lPage    = static_cast<uint8_t>(lAddress >> Cartridge::PRG_PAGE_SHIFT);
+
+    for (uint32_t lIndex = 0; lIndex < 0x2000; lIndex += Cartridge::PRG_PAGE_SIZE, ++lPage)
+    {
+        mCartridge->MapPrgRam(lPage, lRamSize ? (lOffset + lIndex) % lRamSize : Cartridge::UNMAPPED_PAGE, lWritable);
+    }
+}
+
+//--------//
+// SetPrgOpenBus
+//
+// Leaves part of the cpu's address space with nothing behind it. Reads get open bus and
+// writes go to the mapper.
+//
+// param[in]    lAddress    Cpu address to start at, a multiple of 4KB.
+// param[in]    lSize       Size to leave empty, a multiple of 4KB.
+//--------//
+//
+void Mapper::SetPrgOpenBus(AddressType lAddress, uint32_t lSize)
+{
+    uint8_t lPage = static_cast<uint8_t>(lAddress >> Cartridge::PRG_PAGE_SHIFT);
+
+    for (uint32_t lIndex = 0; lIndex < lSize; lIndex += Cartridge::PRG_PAGE_SIZE, ++lPage)
+    {
+        mCartridge->MapPrgRom(lPage, Cartridge::UNMAPPED_PAGE);
+    }
+}
+
+//--------//
+// SetChrBank
+//
+// Maps a bank of CHR memory into the pattern tables.
+//
+// param[in]    lAddress    Ppu address the bank starts at, a multiple of its size.
+// param[in]    lSize       Size of the bank, a multiple of 1KB.
+// param[in]    lBank       Bank number, wrapped around the banks there are.
+//--------//
+//
+void Mapper::SetChrBank(AddressType lAddress, uint32_t lSize, int lBank)
+{
+    uint32_t lChrSize = mCartridge->GetChrSize();
+    uint32_t lOffset  = GetBankOffset(lChrSize, lSize, lBank);
+    uint8_t  lPage    = static_cast<uint8_t>(lAddress >> Ppu2C02::PPU_PAGE_SHIFT);
+
+    for (uint32_t lIndex = 0; lIndex < lSize; lIndex += Ppu2C02::PPU_PAGE_SIZE, ++lPage)
+    {
+        mCartridge->MapChrPage(lPage, lChrSize ? (lOffset + lIndex) % lChrSize : Ppu2C02::UNMAPPED_PAGE);
+    }
+}
+
+//--------//
+// GetBankOffset
+//
+// Works out where a bank starts in memory. Bank numbers wrap around the number of banks,
+// like the unconnected high bits of a bank register do on the real thing.
+//
+// param[in]    lMemorySize     Size of the memory banked.
+// param[in]    lSize           Size of a bank.
+// param[in]    lBank           Bank number, negative counts back from the last bank.
+// returns  Offset of the bank in memory.
+//--------//
+//
+uint32_t Mapper::GetBankOffset(uint32_t lMemorySize, uint32_t lSize, int lBank)
+{
+    int lCount = static_cast<int>(lMemorySize / lSize);
+
+    if (lCount == 0)
+    {
+        return 0;
+    }
+    lBank %= lCount;
+    if (lBank < 0)
+    {
+        lBank += lCount;
+    }
+    return static_cast<uint32_t>(lBank) * lSize;
+}
@@ -10,66 +10,20 @@
 #include <Cartridge.hpp>
 
 //--------//
-// MapRead
+// Reset
 //
-// Maps a given address to a mapped address for a read operation if the address
-// is for ROM. If its for RAM, handle the read directly.
-//
-// param[in]       lAddress        The address to map.
-// param[out]      lMappedAddress  The mapped address.
-// param[in,out]   lData           Last data read as IN, the data read from RAM as OUT.
-//                                 This only is set if the return is false.
-// returns  If the cartridge should read PRG ROM.
-//--------//
-//
-bool Mapper000::MapRead(AddressType lAddress, AddressType * lMappedAddress, DataType * lData)
-{
-#ifdef FAMILY_BASIC
-    // Reading from RAM.
-    if (lAddress >= Mapper000::PRG_RAM_START && lAddress <= Mapper000::PRG_RAM_END)
-    {
-        *lData = mRam.Read(lAddress & (PRG_RAM_SIZE - 1), *lData);
-        return false;
-    }
-#endif
-
-    // Map given address to ROM.
-    if (lAddress >= PRG_ROM_START && lAddress <= PRG_ROM_END)
-    {
-        *lMappedAddress = lAddress & (mCartridge->IsPrgMirror() ? PRG_ROM_MIRROR_SIZE : PRG_ROM_NO_MIRROR_SIZE);
-        return true;
-    }
-    return false;
-}
-
-//--------//
-// MapWrite
-//
-// Maps a given address to a mapped address for a write operation if the address
-// is for ROM. If its for RAM, handle the write directly.
-//
-// param[in]   lAddress        The address to map.
-// param[out]  lMappedAddress  The mapped address.
-// param[in]   lData           The data to write.
-// returns  If the cartridge should write PRG ROM.
+// Lays out the only banks there are. 16KB of PRG ROM shows up twice, 32KB fills
+// $8000-$FFFF, and the one 8KB bank of CHR covers both pattern tables.
 //--------//
 //
-bool Mapper000::MapWrite(AddressType lAddress, AddressType * lMappedAddress, DataType lData)
+void Mapper000::Reset(void)
 {
 #ifdef FAMILY_BASIC
-    // Writing to RAM.
-    if (lAddress >= Mapper000::PRG_RAM_START && lAddress <= Mapper000::PRG_RAM_END)
-    {
-        mRam.Write(lAddress & (PRG_RAM_SIZE - 1), lData);
-        return false;
-    }
+    // According to https://www.nesdev.org/wiki/NROM most emulators just provide 8kb of program ram.
+    SetPrgRam8k(PRG_RAM_START, 0);
 #endif
 
-    // Map given address to ROM.
-    if (lAddress >= PRG_ROM_START && lAddress <= PRG_ROM_END)
-    {
-        *lMappedAddress = lAddress & (mCartridge->IsPrgMirror() ? PRG_ROM_MIRROR_SIZE : PRG_ROM_NO_MIRROR_SIZE);
-        return true;
-    }
-    return false;
+    SetPrg16k(PRG_ROM_START, 0);
+    SetPrg16k(PRG_ROM_HIGH_START, 1);
+    SetChr8k(CHR_START, 0);
 }
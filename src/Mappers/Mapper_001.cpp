@@ -0,0 +1,162 @@
+/////////////////////////////////////////////////////////////////////
+//
+// Mapper_001.cpp
+//
+// Implementation file for mapper 001.
+//
+/////////////////////////////////////////////////////////////////////
+
+#include <Mappers/Mapper_001.hpp>
+#include <Cartridge.hpp>
+
+// Mirroring for each value of the CONTROL register's MIRRORING bits.
+static const Ppu2C02::Mirroring cMirroring[4] =
+{
+    Ppu2C02::MIRROR_SINGLE_LOW, Ppu2C02::MIRROR_SINGLE_HIGH, Ppu2C02::MIRROR_VERTICAL, Ppu2C02::MIRROR_HORIZONTAL
+};
+
+//--------//
+// Mapper001
+//
+// Constructor.
+//
+// param[in]    lCartridge  The Cartridge this mapper is for.
+//--------//
+//
+Mapper001::Mapper001(Cartridge * lCartridge)
+  : Mapper(lCartridge),
+    mShift(SHIFT_LOADED),
+    mRegisters{PRG_FIX_LAST, 0, 0, 0},
+    mLastWriteCycle(0)
+{
+}
+
+//--------//
+// Reset
+//
+// Puts the registers in their power up state, with the last PRG bank fixed at $C000
+// like every MMC1 game expects.
+//--------//
+//
+void Mapper001::Reset(void)
+{
+    mShift                  = SHIFT_LOADED;
+    mRegisters[CONTROL]     = PRG_FIX_LAST;
+    mRegisters[CHR_BANK_0]  = 0;
+    mRegisters[CHR_BANK_1]  = 0;
+    mRegisters[PRG_BANK]    = 0;
+    UpdateBanks();
+}
+
+//--------//
+// WriteRegister
+//
+// Shifts a bit into the shift register, and on the fifth one copies it to a register.
+// Writing with bit 7 set empties the shift register instead.
+//
+// param[in]   lAddress    Address written, $8000-$FFFF are the registers.
+// param[in]   lData       The data written.
+//--------//
+//
+void Mapper001::WriteRegister(AddressType lAddress, DataType lData)
+{
+    uint64_t lCycle = mCartridge->GetCpuCycles();
+    bool     lFull;
+
+    if (lAddress < PRG_ROM_START)
+    {
+        return;
+    }
+
+    // Read-modify-write instructions write twice in a row, only the first one counts.
+    if (mLastWriteCycle != 0 && lCycle <= mLastWriteCycle + 1)
+    {
+        mLastWriteCycle = lCycle;
+        return;
+    }
+    mLastWriteCycle = lCycle;
+
+    if (lData & SHIFT_RESET)
+    {
+        mShift                = SHIFT_LOADED;
+        mRegisters[CONTROL]  |= PRG_FIX_LAST;
+        UpdateBanks();
+        return;
+    }
+
+    lFull  = mShift & 0x01;
+    mShift = static_cast<uint8_t>((mShift >> 1) | ((lData & 0x01) << 4));
+    if (lFull)
+    {
+        mRegisters[(lAddress >> REGISTER_SHIFT) & REGISTER_MASK] = mShift;
+        mShift = SHIFT_LOADED;
+        UpdateBanks();
+    }
+}
+
+//--------//
+// UpdateBanks
+//
+// Lays out every bank and the mirroring from the registers.
+//--------//
+//
+void Mapper001::UpdateBanks(void)
+{
+    uint8_t lControl = mRegisters[CONTROL];
+    uint8_t lChr0    = mRegisters[CHR_BANK_0];
+    uint8_t lChr1    = mRegisters[CHR_BANK_1];
+    int     lBank    = mRegisters[PRG_BANK] & PRG_BANK_MASK;
+    int     lOuter   = 0;
+
+    // Larger PRG ROM takes its top bit from the CHR bank register, 16 banks of 16KB at a time.
+    if (mCartridge->GetPrgRomSize() > PRG_OUTER_SIZE && (lChr0 & PRG_OUTER_BANK))
+    {
+        lOuter = PRG_OUTER_SIZE / 0x4000;
+    }
+
+    switch (lControl & PRG_MODE)
+    {
+        case PRG_FIX_FIRST:
+            SetPrg16k(PRG_ROM_START, lOuter);
+            SetPrg16k(PRG_ROM_HIGH_START, lOuter + lBank);
+            break;
+
+        case PRG_FIX_LAST:
+            SetPrg16k(PRG_ROM_START, lOuter + lBank);
+            SetPrg16k(PRG_ROM_HIGH_START, lOuter + PRG_BANK_MASK);
+            break;
+
+        default:
+            SetPrg32k(PRG_ROM_START, (lOuter + lBank) >> 1);
+            break;
+    }
+
+    if (mRegisters[PRG_BANK] & PRG_RAM_DISABLE)
+    {
+        SetPrgOpenBus(PRG_RAM_START, 0x2000);
+    }
+    else if (mCartridge->GetPrgRamSize() == PRG_RAM_16K)
+    {
+        SetPrgRam8k(PRG_RAM_START, (lChr0 >> PRG_RAM_16K_SHIFT) & PRG_RAM_16K_MASK);
+    }
+    else if (mCartridge->GetPrgRamSize() == PRG_RAM_32K)
+    {
+        SetPrgRam8k(PRG_RAM_START, (lChr0 >> PRG_RAM_32K_SHIFT) & PRG_RAM_32K_MASK);
+    }
+    else
+    {
+        SetPrgRam8k(PRG_RAM_START, 0);
+    }
+
+    if (lControl & CHR_4K_MODE)
+    {
+        SetChr4k(CHR_START, lChr0);
+        SetChr4k(CHR_HIGH_START, lChr1);
+    }
+    else
+    {
+        SetChr8k(CHR_START, lChr0 >> 1);
+    }
+
+    mCartridge->SetMirroring(cMirroring[lControl & MIRRORING]);
+}
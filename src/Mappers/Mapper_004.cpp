@@ -0,0 +1,223 @@
+/////////////////////////////////////////////////////////////////////
+//
+// Mapper_004.cpp
+//
+// Implementation file for mapper 004.
+//
+/////////////////////////////////////////////////////////////////////
+
+#include <Mappers/Mapper_004.hpp>
+#include <Cartridge.hpp>
+
+// Bank registers at power up, consecutive CHR banks and the first two PRG banks.
+static const uint8_t cPowerBanks[Mapper004::NUM_BANK_REGISTERS] = {0, 2, 4, 5, 6, 7, 0, 1};
+
+//--------//
+// Mapper004
+//
+// Constructor.
+//
+// param[in]    lCartridge  The Cartridge this mapper is for.
+//--------//
+//
+Mapper004::Mapper004(Cartridge * lCartridge)
+  : Mapper(lCartridge),
+    mBankSelect(0),
+    mBanks{},
+    mRamProtect(0),
+    mIrqLatch(0),
+    mIrqCounter(0),
+    mIrqReload(false),
+    mIrqEnabled(false),
+    mFourScreen(lCartridge->GetMirroring() == Ppu2C02::MIRROR_FOUR_SCREEN)
+{
+}
+
+//--------//
+// Reset
+//
+// Lays out the power up banks and stops the IRQ.
+//--------//
+//
+void Mapper004::Reset(void)
+{
+    mBankSelect = 0;
+    for (int lIndex = 0; lIndex < NUM_BANK_REGISTERS; ++lIndex)
+    {
+        mBanks[lIndex] = cPowerBanks[lIndex];
+    }
+    mRamProtect = RAM_ENABLE;
+    mIrqLatch   = 0;
+    mIrqCounter = 0;
+    mIrqReload  = false;
+    mIrqEnabled = false;
+    mCartridge->SetIrq(false);
+
+    UpdatePrgBanks();
+    UpdateChrBanks();
+    UpdatePrgRam();
+}
+
+//--------//
+// WriteRegister
+//
+// Handles a write to one of the eight registers, each mirrored across its 8KB.
+//
+// param[in]   lAddress    Address written, $8000-$FFFF are the registers.
+// param[in]   lData       The data written.
+//--------//
+//
+void Mapper004::WriteRegister(AddressType lAddress, DataType lData)
+{
+    uint8_t lChanged;
+
+    if (lAddress < PRG_ROM_START)
+    {
+        return;
+    }
+
+    switch (lAddress & REGISTER_PAIR_MASK)
+    {
+        case BANK_SELECT:
+            lChanged    = mBankSelect ^ lData;
+            mBankSelect = lData;
+            if (lChanged & PRG_SWAP)
+            {
+                UpdatePrgBanks();
+            }
+            if (lChanged & CHR_INVERT)
+            {
+                UpdateChrBanks();
+            }
+            break;
+
+        case BANK_DATA:
+            mBanks[mBankSelect & BANK_REGISTER] = lData;
+            if ((mBankSelect & BANK_REGISTER) >= 6)
+            {
+                UpdatePrgBanks();
+            }
+            else
+            {
+                UpdateChrBanks();
+            }
+            break;
+
+        case MIRRORING:
+            if (!mFourScreen)
+            {
+                mCartridge->SetMirroring((lData & 0x01) ? Ppu2C02::MIRROR_HORIZONTAL : Ppu2C02::MIRROR_VERTICAL);
+            }
+            break;
+
+        case PRG_RAM_PROTECT:
+            mRamProtect = lData;
+            UpdatePrgRam();
+            break;
+
+        case IRQ_LATCH:
+            mIrqLatch = lData;
+            break;
+
+        case IRQ_RELOAD:
+            mIrqCounter = 0;
+            mIrqReload  = true;
+            break;
+
+        case IRQ_DISABLE:
+            mIrqEnabled = false;
+            mCartridge->SetIrq(false);
+            break;
+
+        case IRQ_ENABLE:
+            mIrqEnabled = true;
+            break;
+
+        default:
+            break;
+    }
+}
+
+//--------//
+// ClockA12
+//
+// Clocks the scanline counter, once a line while rendering.
+//--------//
+//
+void Mapper004::ClockA12(void)
+{
+    if (mIrqCounter == 0 || mIrqReload)
+    {
+        mIrqCounter = mIrqLatch;
+        mIrqReload  = false;
+    }
+    else
+    {
+        --mIrqCounter;
+    }
+
+    if (mIrqCounter == 0 && mIrqEnabled)
+    {
+        mCartridge->SetIrq(true);
+    }
+}
+
+//--------//
+// UpdatePrgBanks
+//
+// Lays out PRG ROM. The last bank is always at $E000, and the second last goes at
+// whichever of $8000 or $C000 isn't switchable.
+//--------//
+//
+void Mapper004::UpdatePrgBanks(void)
+{
+    if (mBankSelect & PRG_SWAP)
+    {
+        SetPrg8k(PRG_ROM_START, -2);
+        SetPrg8k(PRG_ROM_THIRD, mBanks[6]);
+    }
+    else
+    {
+        SetPrg8k(PRG_ROM_START, mBanks[6]);
+        SetPrg8k(PRG_ROM_THIRD, -2);
+    }
+    SetPrg8k(PRG_ROM_SECOND, mBanks[7]);
+    SetPrg8k(PRG_ROM_LAST, -1);
+}
+
+//--------//
+// UpdateChrBanks
+//
+// Lays out CHR. The 2KB banks ignore their low bit.
+//--------//
+//
+void Mapper004::UpdateChrBanks(void)
+{
+    AddressType lLarge = (mBankSelect & CHR_INVERT) ? CHR_HALF_SIZE : 0;
+    AddressType lSmall = lLarge ^ CHR_HALF_SIZE;
+
+    SetChr2k(lLarge,          mBanks[0] >> 1);
+    SetChr2k(lLarge + 0x0800, mBanks[1] >> 1);
+    SetChr1k(lSmall,          mBanks[2]);
+    SetChr1k(lSmall + 0x0400, mBanks[3]);
+    SetChr1k(lSmall + 0x0800, mBanks[4]);
+    SetChr1k(lSmall + 0x0C00, mBanks[5]);
+}
+
+//--------//
+// UpdatePrgRam
+//
+// Maps PRG RAM in, out, or in read only, as the protect register says.
+//--------//
+//
+void Mapper004::UpdatePrgRam(void)
+{
+    if (mRamProtect & RAM_ENABLE)
+    {
+        SetPrgRam8k(PRG_RAM_START, 0, !(mRamProtect & RAM_WRITE_PROTECT));
+    }
+    else
+    {
+        SetPrgOpenBus(PRG_RAM_START, 0x2000);
+    }
+}
@@ -0,0 +1,612 @@
+/////////////////////////////////////////////////////////////////////
+//
+// PixelKernels.cpp
+//
+// Implementation file for the renderer's pixel kernels.
+//
+/////////////////////////////////////////////////////////////////////
+
+#include <PixelKernels.hpp>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define PIXEL_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+#ifdef TEST_PPU
+#include <stdio.h>
+#include <chrono>
+#include <Logger/ApiLogger.hpp>
+#endif
+
+const PixelKernels::Table * PixelKernels::cActive = nullptr;
+
+//--------//
+// SCALAR KERNELS
+//
+
+//--------//
+// DecodeRowScalar
+//
+// Interleaves two bitplane bytes into pixels one bit at a time.
+//
+// param[in]  lLow       Low bitplane, leftmost pixel in bit 7.
+// param[in]  lHigh      High bitplane, leftmost pixel in bit 7.
+// param[out] lPixels    8 pixels, leftmost first.
+// param[out] lFlipped   8 pixels, rightmost first.
+//--------//
+//
+static void DecodeRowScalar(uint8_t lLow, uint8_t lHigh, uint8_t * lPixels, uint8_t * lFlipped)
+{
+    uint8_t lPixel;
+
+    for (int lColumn = 0; lColumn < 8; ++lColumn)
+    {
+        lPixel = (((lHigh >> (7 - lColumn)) & 1) << 1) | ((lLow >> (7 - lColumn)) & 1);
+        lPixels[lColumn]      = lPixel;
+        lFlipped[7 - lColumn] = lPixel;
+    }
+}
+
+//--------//
+// MergeAttributesScalar
+//
+// Combines background pixels with their palette into palette RAM indices.
+//
+// param[in]  lPixels    Background pixels (0-3).
+// param[in]  lPalettes  Palette of each pixel (0-3).
+// param[out] lIndices   Palette RAM index of each pixel, 0 if transparent.
+// param[in]  lCount     Number of pixels.
+//--------//
+//
+static void MergeAttributesScalar(const uint8_t * lPixels, const uint8_t * lPalettes, uint8_t * lIndices, int lCount)
+{
+    for (int lIndex = 0; lIndex < lCount; ++lIndex)
+    {
+        lIndices[lIndex] = lPixels[lIndex] ? ((lPalettes[lIndex] << 2) | lPixels[lIndex]) : 0;
+    }
+}
+
+//--------//
+// ResolvePriorityScalar
+//
+// Picks the sprite pixel if it's opaque and either in front or over a transparent
+// background, otherwise the background pixel.
+//
+// param[in]  lBackground   Background palette RAM indices, 0 if transparent.
+// param[in]  lSprite       Sprite palette RAM indices, 0 if transparent.
+// param[in]  lBehind       0xFF where the sprite is behind the background, else 0.
+// param[out] lIndices      Palette RAM index of each pixel.
+// param[in]  lCount        Number of pixels.
+//--------//
+//
+static void ResolvePriorityScalar(const uint8_t * lBackground, const uint8_t * lSprite, const uint8_t * lBehind,
+                                  uint8_t * lIndices, int lCount)
+{
+    for (int lIndex = 0; lIndex < lCount; ++lIndex)
+    {
+        if (lSprite[lIndex] && (!lBackground[lIndex] || !lBehind[lIndex]))
+        {
+            lIndices[lIndex] = lSprite[lIndex];
+        }
+        else
+        {
+            lIndices[lIndex] = lBackground[lIndex];
+        }
+    }
+}
+
+//--------//
+// LookupColors32Scalar
+//
+// Looks up the 32-bit output pixel of each color.
+//
+// param[in]  lColors      System palette colors (0-63).
+// param[in]  lColorMask   Mask applied to every color before the lookup.
+// param[in]  lTable       64 output pixels.
+// param[out] lOut         Output pixels.
+// param[in]  lCount       Number of pixels.
+//--------//
+//
+static void LookupColors32Scalar(const uint8_t * lColors, uint8_t lColorMask, const uint32_t * lTable, uint32_t * lOut, int lCount)
+{
+    for (int lIndex = 0; lIndex < lCount; ++lIndex)
+    {
+        lOut[lIndex] = lTable[lColors[lIndex] & lColorMask];
+    }
+}
+
+//--------//
+// LookupColors16Scalar
+//
+// Looks up the 16-bit output pixel of each color.
+//
+// param[in]  lColors      System palette colors (0-63).
+// param[in]  lColorMask   Mask applied to every color before the lookup.
+// param[in]  lTable       64 output pixels, in the low 16 bits.
+// param[out] lOut         Output pixels.
+// param[in]  lCount       Number of pixels.
+//--------//
+//
+static void LookupColors16Scalar(const uint8_t * lColors, uint8_t lColorMask, const uint32_t * lTable, uint16_t * lOut, int lCount)
+{
+    for (int lIndex = 0; lIndex < lCount; ++lIndex)
+    {
+        lOut[lIndex] = static_cast<uint16_t>(lTable[lColors[lIndex] & lColorMask]);
+    }
+}
+
+static const PixelKernels::Table cScalarTable = {DecodeRowScalar, MergeAttributesScalar, ResolvePriorityScalar,
+                                                 LookupColors32Scalar, LookupColors16Scalar};
+
+#ifdef PIXEL_KERNELS_X86
+
+//--------//
+// SSE2 KERNELS
+//
+
+//--------//
+// DecodeRowSse2
+//
+// Broadcasts each bitplane across a register and tests one bit per byte. The low
+// 8 bytes test bits 7 to 0 for the normal row, the high 8 bytes 0 to 7 for the flipped row.
+//
+// param[in]  lLow       Low bitplane, leftmost pixel in bit 7.
+// param[in]  lHigh      High bitplane, leftmost pixel in bit 7.
+// param[out] lPixels    8 pixels, leftmost first.
+// param[out] lFlipped   8 pixels, rightmost first.
+//--------//
+//
+__attribute__((target("sse2")))
+static void DecodeRowSse2(uint8_t lLow, uint8_t lHigh, uint8_t * lPixels, uint8_t * lFlipped)
+{
+    const __m128i lBits = _mm_setr_epi8(static_cast<char>(0x80), 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01,
+                                        0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, static_cast<char>(0x80));
+
+    __m128i lLowSet  = _mm_cmpeq_epi8(_mm_and_si128(_mm_set1_epi8(static_cast<char>(lLow)), lBits), lBits);
+    __m128i lHighSet = _mm_cmpeq_epi8(_mm_and_si128(_mm_set1_epi8(static_cast<char>(lHigh)), lBits), lBits);
+    __m128i lResult  = _mm_or_si128(_mm_and_si128(lLowSet, _mm_set1_epi8(1)), _mm_and_si128(lHighSet, _mm_set1_epi8(2)));
+
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(lPixels), lResult);
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(lFlipped), _mm_srli_si128(lResult, 8));
+}
+
+//--------//
+// MergeAttributesSse2
+//
+// 16 pixels at a time version of MergeAttributesScalar.
+//--------//
+//
+__attribute__((target("sse2")))
+static void MergeAttributesSse2(const uint8_t * lPixels, const uint8_t * lPalettes, uint8_t * lIndices, int lCount)
+{
+    const __m128i lZero = _mm_setzero_si128();
+    int           lIndex;
+
+    for (lIndex = 0; lIndex + 16 <= lCount; lIndex += 16)
+    {
+        __m128i lPixel   = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lPixels + lIndex));
+        __m128i lPalette = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lPalettes + lIndex));
+
+        // Palettes are at most 3, so shifting 16-bit lanes can't carry into the next byte.
+        __m128i lMerged  = _mm_or_si128(_mm_slli_epi16(lPalette, 2), lPixel);
+        lMerged          = _mm_andnot_si128(_mm_cmpeq_epi8(lPixel, lZero), lMerged);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(lIndices + lIndex), lMerged);
+    }
+
+    MergeAttributesScalar(lPixels + lIndex, lPalettes + lIndex, lIndices + lIndex, lCount - lIndex);
+}
+
+//--------//
+// ResolvePrioritySse2
+//
+// 16 pixels at a time version of ResolvePriorityScalar.
+//--------//
+//
+__attribute__((target("sse2")))
+static void ResolvePrioritySse2(const uint8_t * lBackground, const uint8_t * lSprite, const uint8_t * lBehind,
+                                uint8_t * lIndices, int lCount)
+{
+    const __m128i lZero = _mm_setzero_si128();
+    int           lIndex;
+
+    for (lIndex = 0; lIndex + 16 <= lCount; lIndex += 16)
+    {
+        __m128i lBg      = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lBackground + lIndex));
+        __m128i lSpr     = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lSprite + lIndex));
+        __m128i lBeh     = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lBehind + lIndex));
+
+        // Sprite wins where it's opaque and the background is transparent or it's in front.
+        __m128i lInFront = _mm_or_si128(_mm_cmpeq_epi8(lBg, lZero), _mm_cmpeq_epi8(lBeh, lZero));
+        __m128i lSelect  = _mm_andnot_si128(_mm_cmpeq_epi8(lSpr, lZero), lInFront);
+        __m128i lResult  = _mm_or_si128(_mm_and_si128(lSelect, lSpr), _mm_andnot_si128(lSelect, lBg));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(lIndices + lIndex), lResult);
+    }
+
+    ResolvePriorityScalar(lBackground + lIndex, lSprite + lIndex, lBehind + lIndex, lIndices + lIndex, lCount - lIndex);
+}
+
+// SSE2 has no gather, so the color lookups stay scalar at this level.
+static const PixelKernels::Table cSse2Table = {DecodeRowSse2, MergeAttributesSse2, ResolvePrioritySse2,
+                                               LookupColors32Scalar, LookupColors16Scalar};
+
+//--------//
+// AVX2 KERNELS
+//
+
+//--------//
+// DecodeRowAvx2
+//
+// Deposits bit n of each bitplane into byte n with pdep, which is the flipped row.
+// Swapping the bytes gives the normal row.
+//
+// param[in]  lLow       Low bitplane, leftmost pixel in bit 7.
+// param[in]  lHigh      High bitplane, leftmost pixel in bit 7.
+// param[out] lPixels    8 pixels, leftmost first.
+// param[out] lFlipped   8 pixels, rightmost first.
+//--------//
+//
+__attribute__((target("avx2,bmi2")))
+static void DecodeRowAvx2(uint8_t lLow, uint8_t lHigh, uint8_t * lPixels, uint8_t * lFlipped)
+{
+    uint64_t lReversed = _pdep_u64(lLow, 0x0101010101010101ULL) | _pdep_u64(lHigh, 0x0202020202020202ULL);
+    uint64_t lForward  = __builtin_bswap64(lReversed);
+
+    memcpy(lPixels, &lForward, sizeof(lForward));
+    memcpy(lFlipped, &lReversed, sizeof(lReversed));
+}
+
+//--------//
+// MergeAttributesAvx2
+//
+// 32 pixels at a time version of MergeAttributesScalar.
+//--------//
+//
+__attribute__((target("avx2,bmi2")))
+static void MergeAttributesAvx2(const uint8_t * lPixels, const uint8_t * lPalettes, uint8_t * lIndices, int lCount)
+{
+    const __m256i lZero = _mm256_setzero_si256();
+    int           lIndex;
+
+    for (lIndex = 0; lIndex + 32 <= lCount; lIndex += 32)
+    {
+        __m256i lPixel   = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lPixels + lIndex));
+        __m256i lPalette = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lPalettes + lIndex));
+        __m256i lMerged  = _mm256_or_si256(_mm256_slli_epi16(lPalette, 2), lPixel);
+        lMerged          = _mm256_andnot_si256(_mm256_cmpeq_epi8(lPixel, lZero), lMerged);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(lIndices + lIndex), lMerged);
+    }
+
+    MergeAttributesScalar(lPixels + lIndex, lPalettes + lIndex, lIndices + lIndex, lCount - lIndex);
+}
+
+//--------//
+// ResolvePriorityAvx2
+//
+// 32 pixels at a time version of ResolvePriorityScalar.
+//--------//
+//
+__attribute__((target("avx2,bmi2")))
+static void ResolvePriorityAvx2(const uint8_t * lBackground, const uint8_t * lSprite, const uint8_t * lBehind,
+                                uint8_t * lIndices, int lCount)
+{
+    const __m256i lZero = _mm256_setzero_si256();
+    int           lIndex;
+
+    for (lIndex = 0; lIndex + 32 <= lCount; lIndex += 32)
+    {
+        __m256i lBg      = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lBackground + lIndex));
+        __m256i lSpr     = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lSprite + lIndex));
+        __m256i lBeh     = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lBehind + lIndex));
+        __m256i lInFront = _mm256_or_si256(_mm256_cmpeq_epi8(lBg, lZero), _mm256_cmpeq_epi8(lBeh, lZero));
+        __m256i lSelect  = _mm256_andnot_si256(_mm256_cmpeq_epi8(lSpr, lZero), lInFront);
+        __m256i lResult  = _mm256_blendv_epi8(lBg, lSpr, lSelect);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(lIndices + lIndex), lResult);
+    }
+
+    ResolvePriorityScalar(lBackground + lIndex, lSprite + lIndex, lBehind + lIndex, lIndices + lIndex, lCount - lIndex);
+}
+
+//--------//
+// LookupColors32Avx2
+//
+// 8 pixels at a time version of LookupColors32Scalar, using a gather.
+//--------//
+//
+__attribute__((target("avx2,bmi2")))
+static void LookupColors32Avx2(const uint8_t * lColors, uint8_t lColorMask, const uint32_t * lTable, uint32_t * lOut, int lCount)
+{
+    const __m256i lMask = _mm256_set1_epi32(lColorMask);
+    int           lIndex;
+
+    for (lIndex = 0; lIndex + 8 <= lCount; lIndex += 8)
+    {
+        __m256i lColor = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(lColors + lIndex)));
+        __m256i lPixel = _mm256_i32gather_epi32(reinterpret_cast<const int *>(lTable), _mm256_and_si256(lColor, lMask), 4);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(lOut + lIndex), lPixel);
+    }
+
+    LookupColors32Scalar(lColors + lIndex, lColorMask, lTable, lOut + lIndex, lCount - lIndex);
+}
+
+//--------//
+// LookupColors16Avx2
+//
+// 16 pixels at a time version of LookupColors16Scalar. Two gathers, then the low
+// halves of the 32-bit results are packed down to 16 bits and put back in order.
+//--------//
+//
+__attribute__((target("avx2,bmi2")))
+static void LookupColors16Avx2(const uint8_t * lColors, uint8_t lColorMask, const uint32_t * lTable, uint16_t * lOut, int lCount)
+{
+    const __m256i lMask    = _mm256_set1_epi32(lColorMask);
+    const __m256i lLowHalf = _mm256_set1_epi32(0xFFFF);
+    int           lIndex;
+
+    for (lIndex = 0; lIndex + 16 <= lCount; lIndex += 16)
+    {
+        __m256i lColorLow  = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(lColors + lIndex)));
+        __m256i lColorHigh = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(lColors + lIndex + 8)));
+        __m256i lPixelLow  = _mm256_i32gather_epi32(reinterpret_cast<const int *>(lTable), _mm256_and_si256(lColorLow, lMask), 4);
+        __m256i lPixelHigh = _mm256_i32gather_epi32(reinterpret_cast<const int *>(lTable), _mm256_and_si256(lColorHigh, lMask), 4);
+        __m256i lPacked    = _mm256_packus_epi32(_mm256_and_si256(lPixelLow, lLowHalf), _mm256_and_si256(lPixelHigh, lLowHalf));
+        lPacked            = _mm256_permute4x64_epi64(lPacked, 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(lOut + lIndex), lPacked);
+    }
+
+    LookupColors16Scalar(lColors + lIndex, lColorMask, lTable, lOut + lIndex, lCount - lIndex);
+}
+
+static const PixelKernels::Table cAvx2Table = {DecodeRowAvx2, MergeAttributesAvx2, ResolvePriorityAvx2,
+                                               LookupColors32Avx2, LookupColors16Avx2};
+
+#endif
+
+//--------//
+//
+// PixelKernels
+//
+//--------//
+
+//--------//
+// Get
+//
+// Gets the kernels to use, picking the best supported set on the first call.
+//
+// returns  Table of kernels.
+//--------//
+//
+const PixelKernels::Table & PixelKernels::Get(void)
+{
+    if (nullptr == cActive)
+    {
+        cActive = GetLevel(GetBestLevel());
+    }
+    return *cActive;
+}
+
+//--------//
+// GetLevel
+//
+// Gets the kernels of a specific instruction set.
+//
+// param[in]    lLevel  Instruction set wanted.
+// returns  Table of kernels, nullptr if the cpu or build doesn't support it.
+//--------//
+//
+const PixelKernels::Table * PixelKernels::GetLevel(Level lLevel)
+{
+    if (lLevel > GetBestLevel())
+    {
+        return nullptr;
+    }
+
+    switch (lLevel)
+    {
+#ifdef PIXEL_KERNELS_X86
+        case AVX2:
+            return &cAvx2Table;
+
+        case SSE2:
+            return &cSse2Table;
+#endif
+        case SCALAR:
+            return &cScalarTable;
+
+        default:
+            return nullptr;
+    }
+}
+
+//--------//
+// GetBestLevel
+//
+// Asks the cpu which instruction sets it has.
+//
+// returns  The best level the kernels can run at.
+//--------//
+//
+PixelKernels::Level PixelKernels::GetBestLevel(void)
+{
+#ifdef PIXEL_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2"))
+    {
+        return AVX2;
+    }
+    if (__builtin_cpu_supports("sse2"))
+    {
+        return SSE2;
+    }
+#endif
+    return SCALAR;
+}
+
+//--------//
+// GetLevelName
+//
+// Gets a printable name of a level.
+//
+// param[in]    lLevel  The level.
+// returns  Name of the level.
+//--------//
+//
+const char * PixelKernels::GetLevelName(Level lLevel)
+{
+    switch (lLevel)
+    {
+        case SCALAR: return "scalar";
+        case SSE2:   return "sse2";
+        case AVX2:   return "avx2";
+        default:     return "unknown";
+    }
+}
+
+#ifdef TEST_PPU
+
+//--------//
+// SelfTest
+//
+// Checks every supported kernel set is bit exact with the scalar kernels, then times
+// each of them. Every bitplane combination is decoded, the line kernels run on random
+// lines, including lengths that aren't a multiple of the vector width.
+//
+// returns  If all the kernel sets matched.
+//--------//
+//
+bool PixelKernels::SelfTest(void)
+{
+    enum
+    {
+        LINE_WIDTH        = 256,
+        NUM_TEST_LINES    = 512,
+        NUM_BENCH_LOOPS   = 20000
+    };
+
+    uint8_t  lPixels[LINE_WIDTH];
+    uint8_t  lPalettes[LINE_WIDTH];
+    uint8_t  lSprite[LINE_WIDTH];
+    uint8_t  lBehind[LINE_WIDTH];
+    uint8_t  lExpected[LINE_WIDTH];
+    uint8_t  lActual[LINE_WIDTH];
+    uint8_t  lExpectedFlip[8];
+    uint8_t  lActualFlip[8];
+    uint32_t lColorTable[64];
+    uint32_t lExpected32[LINE_WIDTH];
+    uint32_t lActual32[LINE_WIDTH];
+    uint16_t lExpected16[LINE_WIDTH];
+    uint16_t lActual16[LINE_WIDTH];
+    uint32_t lSeed   = 0x12345678;
+    bool     lPassed = true;
+    char     lBuffer[160];
+
+    for (int lColor = 0; lColor < 64; ++lColor)
+    {
+        lColorTable[lColor] = 0xFF000000 | (lColor * 0x00030507);
+    }
+
+    for (int lLevel = SCALAR + 1; lLevel <= GetBestLevel(); ++lLevel)
+    {
+        const Table * lTable = GetLevel(static_cast<Level>(lLevel));
+        bool          lMatch = true;
+
+        for (int lPlanes = 0; lPlanes < 0x10000; ++lPlanes)
+        {
+            DecodeRowScalar(lPlanes & 0xFF, lPlanes >> 8, lExpected, lExpectedFlip);
+            lTable->mDecodeRow(lPlanes & 0xFF, lPlanes >> 8, lActual, lActualFlip);
+            if (memcmp(lExpected, lActual, 8) != 0 || memcmp(lExpectedFlip, lActualFlip, 8) != 0)
+            {
+                lMatch = false;
+            }
+        }
+
+        for (int lLine = 0; lLine < NUM_TEST_LINES; ++lLine)
+        {
+            int lCount = LINE_WIDTH - (lLine % 32);
+
+            for (int lIndex = 0; lIndex < LINE_WIDTH; ++lIndex)
+            {
+                lSeed = (lSeed * 1103515245) + 12345;
+                lPixels[lIndex]   = (lSeed >> 16) & 0x03;
+                lPalettes[lIndex] = (lSeed >> 18) & 0x03;
+                lSprite[lIndex]   = ((lSeed >> 20) & 0x03) ? (0x10 | ((lSeed >> 22) & 0x0F)) : 0;
+                lBehind[lIndex]   = ((lSeed >> 26) & 0x01) ? 0xFF : 0;
+            }
+
+            MergeAttributesScalar(lPixels, lPalettes, lExpected, lCount);
+            lTable->mMergeAttributes(lPixels, lPalettes, lActual, lCount);
+            if (memcmp(lExpected, lActual, lCount) != 0)
+            {
+                lMatch = false;
+            }
+
+            ResolvePriorityScalar(lExpected, lSprite, lBehind, lActual, lCount);
+            lTable->mResolvePriority(lExpected, lSprite, lBehind, lPixels, lCount);
+            if (memcmp(lActual, lPixels, lCount) != 0)
+            {
+                lMatch = false;
+            }
+
+            // Random bytes as colors, so the color mask has to do its job.
+            LookupColors32Scalar(lSprite, 0x3F, lColorTable, lExpected32, lCount);
+            lTable->mLookupColors32(lSprite, 0x3F, lColorTable, lActual32, lCount);
+            LookupColors16Scalar(lBehind, 0x30, lColorTable, lExpected16, lCount);
+            lTable->mLookupColors16(lBehind, 0x30, lColorTable, lActual16, lCount);
+            if (memcmp(lExpected32, lActual32, lCount * sizeof(uint32_t)) != 0 ||
+                memcmp(lExpected16, lActual16, lCount * sizeof(uint16_t)) != 0)
+            {
+                lMatch = false;
+            }
+        }
+
+        snprintf(lBuffer, sizeof(lBuffer), "[%s] %s pixel kernels match scalar\n", lMatch ? "+" : "---", GetLevelName(static_cast<Level>(lLevel)));
+        ApiLogger::Log(lBuffer);
+        lPassed = lPassed && lMatch;
+    }
+
+    // Microbenchmark, nanoseconds per tile row and per full line.
+    for (int lLevel = SCALAR; lLevel <= GetBestLevel(); ++lLevel)
+    {
+        const Table *    lTable = GetLevel(static_cast<Level>(lLevel));
+        volatile uint8_t lSink  = 0;
+
+        auto lStart = std::chrono::steady_clock::now();
+        for (int lLoop = 0; lLoop < NUM_BENCH_LOOPS * 32; ++lLoop)
+        {
+            lTable->mDecodeRow(lLoop & 0xFF, (lLoop >> 8) & 0xFF, lActual, lActualFlip);
+            lSink = lSink + lActual[lLoop & 7];
+        }
+        auto lDecodeEnd = std::chrono::steady_clock::now();
+        for (int lLoop = 0; lLoop < NUM_BENCH_LOOPS; ++lLoop)
+        {
+            lTable->mMergeAttributes(lPixels, lPalettes, lExpected, LINE_WIDTH);
+            lSink = lSink + lExpected[lLoop & 0xFF];
+        }
+        auto lMergeEnd = std::chrono::steady_clock::now();
+        for (int lLoop = 0; lLoop < NUM_BENCH_LOOPS; ++lLoop)
+        {
+            lTable->mResolvePriority(lExpected, lSprite, lBehind, lActual, LINE_WIDTH);
+            lSink = lSink + lActual[lLoop & 0xFF];
+        }
+        auto lResolveEnd = std::chrono::steady_clock::now();
+        for (int lLoop = 0; lLoop < NUM_BENCH_LOOPS; ++lLoop)
+        {
+            lTable->mLookupColors32(lActual, 0x3F, lColorTable, lActual32, LINE_WIDTH);
+            lSink = lSink + static_cast<uint8_t>(lActual32[lLoop & 0xFF]);
+        }
+        auto lLookupEnd = std::chrono::steady_clock::now();
+
+        snprintf(lBuffer, sizeof(lBuffer), "[i] %-6s decode %6.2f ns/row, merge %7.2f ns/line, priority %7.2f ns/line, rgba %7.2f ns/line\n",
+                 GetLevelName(static_cast<Level>(lLevel)),
+                 std::chrono::duration<double, std::nano>(lDecodeEnd - lStart).count() / (NUM_BENCH_LOOPS * 32),
+                 std::chrono::duration<double, std::nano>(lMergeEnd - lDecodeEnd).count() / NUM_BENCH_LOOPS,
+                 std::chrono::duration<double, std::nano>(lResolveEnd - lMergeEnd).count() / NUM_BENCH_LOOPS,
+                 std::chrono::duration<double, std::nano>(lLookupEnd - lResolveEnd).count() / NUM_BENCH_LOOPS);
+        ApiLogger::Log(lBuffer);
+    }
+
+    return lPassed;
+}
+
+#endif
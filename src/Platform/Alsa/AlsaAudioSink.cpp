@@ -0,0 +1,120 @@
+/////////////////////////////////////////////////////////////////////
+//
+// AlsaAudioSink.cpp
+//
+// Implementation file for ALSA audio output.
+//
+/////////////////////////////////////////////////////////////////////
+
+#ifdef USE_ALSA
+
+#include <new>
+#include "AlsaAudioSink.hpp"
+#include <Errors/ApiErrors.hpp>
+
+//--------//
+//
+// AlsaAudioSink
+//
+//--------//
+
+//--------//
+// AlsaAudioSink
+//
+// Constructor. Opens the default playback device for 16-bit mono at the sample rate,
+// letting ALSA convert if the hardware wants something else.
+//
+// param[in]    lRing           Ring the sink drains.
+// param[in]    lSampleRate     Samples per second in the ring.
+//--------//
+//
+AlsaAudioSink::AlsaAudioSink(AudioRing * lRing, int lSampleRate)
+  : AudioSink(lRing, lSampleRate),
+    mPcm(nullptr),
+    mBuffer(nullptr),
+    mLastSample(0)
+{
+    mBuffer = new(std::nothrow) int16_t[GetPeriod()];
+    if (nullptr == mBuffer)
+    {
+        mStatus = ErrorCodes::OUT_OF_MEMORY;
+        gErrorManager.Post(mStatus);
+        return;
+    }
+
+    if (snd_pcm_open(&mPcm, "default", SND_PCM_STREAM_PLAYBACK, 0) < 0)
+    {
+        mPcm    = nullptr;
+        mStatus = ErrorCodes::AUDIO_FAIL_INIT;
+        gErrorManager.Post(mStatus);
+        return;
+    }
+
+    if (snd_pcm_set_params(mPcm, SND_PCM_FORMAT_S16, SND_PCM_ACCESS_RW_INTERLEAVED, 1, lSampleRate, 1, LATENCY_US) < 0)
+    {
+        snd_pcm_close(mPcm);
+        mPcm    = nullptr;
+        mStatus = ErrorCodes::AUDIO_FAIL_INIT;
+        gErrorManager.Post(mStatus);
+    }
+}
+
+//--------//
+// ~AlsaAudioSink
+//
+// Destructor.
+//--------//
+//
+AlsaAudioSink::~AlsaAudioSink(void)
+{
+    Stop();
+    if (mPcm)
+    {
+        snd_pcm_drop(mPcm);
+        snd_pcm_close(mPcm);
+    }
+    delete [] mBuffer;
+}
+
+//--------//
+// Pump
+//
+// Takes a period out of the ring and writes it to the device, waiting for room.
+//
+// returns  False if the device stopped working.
+//--------//
+//
+bool AlsaAudioSink::Pump(void)
+{
+    int               lPeriod = GetPeriod();
+    int               lCount  = static_cast<int>(mRing->Read(mBuffer, lPeriod));
+    snd_pcm_sframes_t lWritten;
+
+    if (lCount)
+    {
+        mLastSample = mBuffer[lCount - 1];
+    }
+    for (int lIndex = lCount; lIndex < lPeriod; ++lIndex)
+    {
+        mBuffer[lIndex] = mLastSample;
+    }
+
+    for (int lOffset = 0; lOffset < lPeriod; lOffset += lWritten)
+    {
+        lWritten = snd_pcm_writei(mPcm, mBuffer + lOffset, lPeriod - lOffset);
+        if (lWritten < 0)
+        {
+            // The device ran dry or was suspended, get it going again and retry.
+            if (snd_pcm_recover(mPcm, static_cast<int>(lWritten), 1) < 0)
+            {
+                mStatus = ErrorCodes::AUDIO_FAIL_INIT;
+                gErrorManager.Post(mStatus);
+                return false;
+            }
+            lWritten = 0;
+        }
+    }
+    return true;
+}
+
+#endif
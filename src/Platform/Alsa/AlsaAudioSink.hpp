@@ -0,0 +1,44 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// AlsaAudioSink.hpp
+//
+// Contains classes to play audio through ALSA.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ALSA_AUDIO_SINK_HPP
+#define ALSA_AUDIO_SINK_HPP
+
+#include <Audio/AudioSink.hpp>
+#include <alsa/asoundlib.h>
+
+//========//
+// AlsaAudioSink
+//
+// Plays the ring through ALSA's default device. Writing a period blocks until the device
+// has room for it, which is what paces the sink. If the ring runs dry the rest of the
+// period is filled with the last sample, so an underrun is a short hold, not a click.
+//========//
+//
+class AlsaAudioSink : public AudioSink
+{
+    public:
+
+        enum
+        {
+            LATENCY_US = 40000  // Buffering asked of the device.
+        };
+
+        AlsaAudioSink(AudioRing * lRing, int lSampleRate);
+        virtual ~AlsaAudioSink(void);
+
+    protected:
+
+        virtual bool Pump(void) override;
+
+        snd_pcm_t * mPcm;
+        int16_t *   mBuffer;
+        int16_t     mLastSample;
+};
+
+#endif
@@ -135,6 +135,35 @@ void GlfwWindow::OnUpdate(void)
     glfwSwapBuffers(mWindow);
 }
 
+//--------//
+// DrawFrame
+//
+// Draws an RGBA8888 frame stretched over the whole window.
+//
+// param[in]    lPixels     The frame, rows top to bottom.
+// param[in]    lWidth      Width of the frame in pixels.
+// param[in]    lHeight     Height of the frame in pixels.
+//--------//
+//
+void GlfwWindow::DrawFrame(const void * lPixels, int lWidth, int lHeight)
+{
+    int lFramebufferWidth;
+    int lFramebufferHeight;
+
+    if (nullptr == lPixels)
+    {
+        return;
+    }
+
+    glfwGetFramebufferSize(mWindow, &lFramebufferWidth, &lFramebufferHeight);
+    glViewport(0, 0, lFramebufferWidth, lFramebufferHeight);
+
+    // OpenGL draws rows bottom up, so start at the top left corner and zoom downwards.
+    glRasterPos2f(-1.0f, 1.0f);
+    glPixelZoom(static_cast<float>(lFramebufferWidth) / lWidth, -static_cast<float>(lFramebufferHeight) / lHeight);
+    glDrawPixels(lWidth, lHeight, GL_RGBA, GL_UNSIGNED_BYTE, lPixels);
+}
+
 //--------//
 // Close
 //
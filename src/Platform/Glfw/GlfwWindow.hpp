@@ -42,6 +42,7 @@ class GlfwWindow : public Window
 
         virtual bool ShouldClose(void);
         virtual void OnUpdate(void);
+        virtual void DrawFrame(const void * lPixels, int lWidth, int lHeight);
 
     protected:
 
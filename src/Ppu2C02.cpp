@@ -1,23 +1,51 @@
 /////////////////////////////////////////////////////////////////////
 //
-// Cartridge.cpp
+// Ppu2C02.cpp
 //
 // Implementation file for the ppu.
 //
 /////////////////////////////////////////////////////////////////////
 
 #include <System.hpp>
+#include <PixelKernels.hpp>
+#include <Errors/ApiErrors.hpp>
 
 #ifdef USE_LOGGER
 #include <Logger/ApiLogger.hpp>
 #endif
 
+//--------//
+// ReverseBits
+//
+// Helper function to mirror the bits of a byte, used for horizontally flipped sprites.
+//
+// param[in]  lByte   The byte to mirror.
+// returns  The byte with bit 0 swapped with bit 7, bit 1 with bit 6, and so on.
+//--------//
+//
+static inline uint8_t ReverseBits(uint8_t lByte)
+{
+    lByte = static_cast<uint8_t>(((lByte & 0xF0) >> 4) | ((lByte & 0x0F) << 4));
+    lByte = static_cast<uint8_t>(((lByte & 0xCC) >> 2) | ((lByte & 0x33) << 2));
+    lByte = static_cast<uint8_t>(((lByte & 0xAA) >> 1) | ((lByte & 0x55) << 1));
+    return lByte;
+}
+
 //--------//
 //
 // Ppu2C02
 //
 //--------//
 
+uint8_t Ppu2C02::cEmptyPage[Ppu2C02::PPU_PAGE_SIZE] = {0};
+
+// The backdrop entries of the sprite palettes ($3F10/$3F14/$3F18/$3F1C) are mirrors of the background ones.
+const uint8_t Ppu2C02::cPaletteIndex[Ppu2C02::PALETTE_SIZE] =
+{
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+    0x00, 0x11, 0x12, 0x13, 0x04, 0x15, 0x16, 0x17, 0x08, 0x19, 0x1A, 0x1B, 0x0C, 0x1D, 0x1E, 0x1F
+};
+
 //--------//
 // Ppu2C02
 //
@@ -25,9 +53,108 @@
 //--------//
 //
 Ppu2C02::Ppu2C02(void)
- :  mNameTable      {MemoryRam{NAME_TABLE_SIZE}, MemoryRam{NAME_TABLE_SIZE}},
-    mPatternTable   {MemoryRom{PATTERN_TABLE_SIZE}, MemoryRom{PATTERN_TABLE_SIZE}}
+ :  mCartridge(nullptr),
+    mRenderMode(SCANLINE_RENDERER),
+    mTimingOnly(false),
+    mFrameDirty(true),
+    mPipelinePpu(nullptr),
+    mPipelineReused(false)
+{
+    memset(mVram, 0, sizeof(mVram));
+    memset(mPages, 0, sizeof(mPages));
+    memset(mNameTableSlots, 0, sizeof(mNameTableSlots));
+    for (int lBand = 0; lBand < WorkerPool::MAX_THREADS; ++lBand)
+    {
+        mBands[lBand].mPpu = this;
+        mBandJobs[lBand]   = &mBands[lBand];
+    }
+    mPipelineJobs[0] = &mPipelineJob;
+    ConnectCartridge(nullptr);
+    Reset();
+}
+
+//--------//
+// ConnectCartridge
+//
+// Puts a cartridge on the ppu bus and takes on its CHR pages and name table mirroring.
+//
+// param[in] lCartridge   The cartridge, or nullptr to remove it.
+//--------//
+//
+void Ppu2C02::ConnectCartridge(Cartridge * lCartridge)
+{
+    // A frame might still be drawing from the old cartridge's CHR.
+    mPipeline.Wait();
+    mCartridge  = lCartridge;
+    mWatchA12   = lCartridge && lCartridge->WatchesA12();
+    mA12RiseDot = -1;
+
+    for (uint8_t lPage = 0; lPage < NUM_PATTERN_PAGES; ++lPage)
+    {
+        if (nullptr == lCartridge)
+        {
+            SetPatternPage(lPage, nullptr, UNMAPPED_PAGE);
+        }
+        else
+        {
+            SetPatternPage(lPage, lCartridge->GetChrPageData(lPage), lCartridge->GetChrPageOffset(lPage));
+        }
+    }
+    SetMirroring((nullptr == lCartridge) ? MIRROR_HORIZONTAL : lCartridge->GetMirroring());
+}
+
+//--------//
+// SetPatternPage
+//
+// Points one 1KB page of the pattern tables at CHR memory.
+//
+// param[in] lPage        Page number, 0-7.
+// param[in] lData        Start of the page's memory, nullptr if nothing is mapped there.
+// param[in] lChrOffset   Offset of lData in CHR memory, UNMAPPED_PAGE if nothing is mapped there.
+//--------//
+//
+void Ppu2C02::SetPatternPage(uint8_t lPage, uint8_t * lData, uint32_t lChrOffset)
 {
+    lPage &= NUM_PATTERN_PAGES - 1;
+    if (nullptr == lData)
+    {
+        lData      = cEmptyPage;
+        lChrOffset = UNMAPPED_PAGE;
+    }
+    mFrameDirty          |= (mPages[lPage] != lData);
+    mPages[lPage]         = lData;
+    mChrPageOffset[lPage] = lChrOffset;
+}
+
+//--------//
+// SetMirroring
+//
+// Points the 4 logical name tables, and the ppu pages they cover, at physical memory.
+//
+// param[in] lMirroring   The mirroring to use.
+//--------//
+//
+void Ppu2C02::SetMirroring(Mirroring lMirroring)
+{
+    static const uint8_t cLayouts[][NUM_NAME_TABLES] =
+    {
+        {0, 0, 1, 1},   // MIRROR_HORIZONTAL
+        {0, 1, 0, 1},   // MIRROR_VERTICAL
+        {0, 0, 0, 0},   // MIRROR_SINGLE_LOW
+        {1, 1, 1, 1},   // MIRROR_SINGLE_HIGH
+        {0, 1, 2, 3}    // MIRROR_FOUR_SCREEN
+    };
+
+    mMirroring = lMirroring;
+    for (int lSlot = 0; lSlot < NUM_NAME_TABLES; ++lSlot)
+    {
+        mFrameDirty           |= (mNameTableSlots[lSlot] != mVram[cLayouts[lMirroring][lSlot]]);
+        mNameTableSlots[lSlot] = mVram[cLayouts[lMirroring][lSlot]];
+
+        // $3000-$3EFF mirrors $2000-$2EFF.
+        mPages[(NAME_TABLE_START >> PPU_PAGE_SHIFT) + lSlot]                   = mNameTableSlots[lSlot];
+        mPages[(NAME_TABLE_START >> PPU_PAGE_SHIFT) + NUM_NAME_TABLES + lSlot] = mNameTableSlots[lSlot];
+    }
 }
 
 //--------//
@@ -38,40 +165,1730 @@ Ppu2C02::Ppu2C02(void)
 //
 Ppu2C02::~Ppu2C02(void)
 {
+    StopPipeline();
+}
+
+//--------//
+// Reset
+//
+// Puts the ppu back into its power up state, starting on the pre-render scanline.
+//--------//
+//
+void Ppu2C02::Reset(void)
+{
+    for (int lIndex = 0; lIndex < NUM_REGISTERS; ++lIndex)
+    {
+        mRegisters[lIndex].Write(0);
+    }
+    for (int lIndex = 0; lIndex < NUM_INTERNAL_REGISTERS; ++lIndex)
+    {
+        mInternalRegisters[lIndex].Write(0);
+    }
+
+    mScanline               = PRE_RENDER_SCANLINE;
+    mDot                    = 0;
+    mOddFrame               = false;
+    mFrameComplete          = false;
+    mNmiOccurred            = false;
+    mDataBuffer             = 0;
+    mOpenBus                = 0;
+    mSpriteZeroHitDot       = -1;
+    mA12RiseDot             = -1;
+    mSpriteCount            = 0;
+    mSpriteZeroOnLine       = false;
+    mSpriteIndexDirty       = true;
+    mWriteCount             = 0;
+    mLogging                = false;
+    mFrameDirty             = true;
+    mFrameDrawn             = false;
+    mFrameReused            = false;
+    mPipelineReused         = false;
+    mNextTileId             = 0;
+    mNextTileAttribute      = 0;
+    mNextTileLow            = 0;
+    mNextTileHigh           = 0;
+    mBgShifterPatternLow    = 0;
+    mBgShifterPatternHigh   = 0;
+    mBgShifterAttributeLow  = 0;
+    mBgShifterAttributeHigh = 0;
+
+    memset(mPalette, 0, sizeof(mPalette));
+    memset(mFrameBuffer, 0, sizeof(mFrameBuffer));
+    memset(mLineMask, 0, sizeof(mLineMask));
+    memset(&mFrameStart, 0, sizeof(mFrameStart));
 }
 
 //--------//
 // Read
 //
-// Reads data from the system.
+// Reads data from the ppu address space.
 //
 // param[in] lAddress   Address to read from.
-// returns  Data at the given address. 
+// returns  Data at the given address.
 //--------//
 //
 DataType Ppu2C02::Read(AddressType lAddress)
 {
-    if (IsDisconnected())
+    lAddress &= PPU_ADDRESS_MASK;
+
+    if (lAddress >= PALETTE_START)
     {
-        return 0;
+        return mPalette[cPaletteIndex[lAddress & PALETTE_MASK]];
     }
-    return mSystem->Read(lAddress);
+
+    // Pattern tables and name tables.
+    return mPages[lAddress >> PPU_PAGE_SHIFT][lAddress & PPU_PAGE_MASK];
 }
 
 //--------//
 // Write
 //
-// Writes data to memory on the system.
+// Writes data to the ppu address space.
 //
-// param[in] lAddress   Address to write to. 
-// param[in] lData      Data to write. 
+// param[in] lAddress   Address to write to.
+// param[in] lData      Data to write.
 //--------//
 //
 void Ppu2C02::Write(AddressType lAddress, DataType lData)
 {
-    if (IsDisconnected())
+    uint8_t * lByte;
+
+    lAddress &= PPU_ADDRESS_MASK;
+
+    // Pattern table writes go through the cartridge, only CHR RAM takes them and its tile cache has to hear about it.
+    if (lAddress <= PATTERN_TABLE_END)
+    {
+        if (mCartridge)
+        {
+            if (mRenderMode == PIPELINED_RENDERER)
+            {
+                mPipeline.Wait();
+            }
+            mFrameDirty |= (mPages[lAddress >> PPU_PAGE_SHIFT][lAddress & PPU_PAGE_MASK] != lData);
+            mCartridge->PpuWrite(lAddress, lData);
+        }
+        return;
+    }
+
+    // Games tend to upload the same palette and name tables every frame, only an actual change counts.
+    if (lAddress >= PALETTE_START)
+    {
+        lByte = &mPalette[cPaletteIndex[lAddress & PALETTE_MASK]];
+        lData &= COLOR_MASK;
+    }
+    else
+    {
+        lByte = &mPages[lAddress >> PPU_PAGE_SHIFT][lAddress & PPU_PAGE_MASK];
+    }
+    mFrameDirty |= (*lByte != lData);
+    *lByte = lData;
+}
+
+//--------//
+// CpuRead
+//
+// Reads one of the ppu registers from the cpu side ($2000-$2007).
+//
+// param[in] lAddress   Register to read, already masked down to 0-7.
+// returns  Value of the register.
+//--------//
+//
+DataType Ppu2C02::CpuRead(AddressType lAddress)
+{
+    DataType    lData = mOpenBus;
+    AddressType lVram;
+
+    switch (lAddress)
+    {
+        case PPUSTATUS:
+            // Only the top 3 bits are driven, the rest is whatever was last on the bus.
+            lData = (mRegisters[PPUSTATUS].Read() & ~OPEN_BUS) | (mOpenBus & OPEN_BUS);
+            mRegisters[PPUSTATUS].ClearFlag(VERTICAL_BLANK);
+            mInternalRegisters[W].Write(0);
+            mOpenBus = lData;
+            break;
+
+        case OAMDATA:
+            lData = reinterpret_cast<uint8_t *>(mOam)[mRegisters[OAMADDR].Read()];
+            break;
+
+        case PPUDATA:
+            // Reads are buffered, returning what was read last time. Palette reads are
+            // the exception, but the buffer still gets the name table "underneath" it.
+            lVram = mInternalRegisters[V].Read() & PPU_ADDRESS_MASK;
+            lData = mDataBuffer;
+            mFrameDirty |= mLogging;
+            mDataBuffer = Read(lVram);
+            if (lVram >= PALETTE_START)
+            {
+                lData = mDataBuffer;
+                mDataBuffer = Read(lVram - 0x1000);
+            }
+            mInternalRegisters[V].Write(mInternalRegisters[V].Read() + ((mRegisters[PPUCTRL].Read() & VRAM) ? 32 : 1));
+            break;
+
+        default:
+            // Write only registers return the open bus.
+            break;
+    }
+
+    return lData;
+}
+
+//--------//
+// CpuWrite
+//
+// Writes one of the ppu registers from the cpu side ($2000-$2007).
+//
+// param[in] lAddress   Register to write, already masked down to 0-7.
+// param[in] lData      Data to write.
+//--------//
+//
+void Ppu2C02::CpuWrite(AddressType lAddress, DataType lData)
+{
+    uint16_t lT = mInternalRegisters[T].Read();
+    uint8_t  lOamAddress;
+    bool     lNmiWasOff;
+
+    mOpenBus = lData;
+
+    if (mLogging && (lAddress == PPUCTRL || lAddress == PPUMASK || lAddress == PPUSCROLL || lAddress == PPUADDR))
+    {
+        LogWrite(lAddress, lData);
+    }
+
+    switch (lAddress)
+    {
+        case PPUCTRL:
+            // Turning on NMI while already in vblank fires one right away.
+            lNmiWasOff = !(mRegisters[PPUCTRL].Read() & NMI);
+            if ((mRegisters[PPUCTRL].Read() ^ lData) & SPRITE_SIZE)
+            {
+                mSpriteIndexDirty = true;
+            }
+            mRegisters[PPUCTRL].Write(lData);
+            mInternalRegisters[T].Write((lT & ~NAMETABLE_SEL) | ((lData & BASE_NAMETBL) << 10));
+            if (lNmiWasOff && (lData & NMI) && (mRegisters[PPUSTATUS].Read() & VERTICAL_BLANK))
+            {
+                mNmiOccurred = true;
+            }
+            if (mWatchA12)
+            {
+                UpdateA12RiseDot();
+            }
+            break;
+
+        case PPUMASK:
+            mRegisters[PPUMASK].Write(lData);
+            if (mWatchA12)
+            {
+                UpdateA12RiseDot();
+            }
+            break;
+
+        case OAMADDR:
+            mRegisters[OAMADDR].Write(lData);
+            break;
+
+        case OAMDATA:
+            // Only a change of Y position can move a sprite to other scanlines.
+            lOamAddress = mRegisters[OAMADDR].Read();
+            if ((lOamAddress & 0x03) == 0 && reinterpret_cast<uint8_t *>(mOam)[lOamAddress] != lData)
+            {
+                mSpriteIndexDirty = true;
+            }
+            mFrameDirty |= (reinterpret_cast<uint8_t *>(mOam)[lOamAddress] != lData);
+            reinterpret_cast<uint8_t *>(mOam)[lOamAddress] = lData;
+            mRegisters[OAMADDR].Write(lOamAddress + 1);
+            break;
+
+        case PPUSCROLL:
+            if (mInternalRegisters[W].Read() == 0)
+            {
+                mInternalRegisters[T].Write((lT & ~COARSE_X) | (lData >> 3));
+                mInternalRegisters[X].Write(lData & 0x07);
+                mInternalRegisters[W].Write(1);
+            }
+            else
+            {
+                mInternalRegisters[T].Write((lT & ~(COARSE_Y | FINE_Y)) | ((lData & 0x07) << 12) | ((lData >> 3) << 5));
+                mInternalRegisters[W].Write(0);
+            }
+            break;
+
+        case PPUADDR:
+            if (mInternalRegisters[W].Read() == 0)
+            {
+                mInternalRegisters[T].Write((lT & 0x00FF) | ((lData & 0x3F) << 8));
+                mInternalRegisters[W].Write(1);
+            }
+            else
+            {
+                lT = (lT & 0xFF00) | lData;
+                mInternalRegisters[T].Write(lT);
+                mInternalRegisters[V].Write(lT);
+                mInternalRegisters[W].Write(0);
+            }
+            break;
+
+        case PPUDATA:
+            // Moves V while the frame is drawn, which the register log can't account for.
+            mFrameDirty |= mLogging;
+            Write(mInternalRegisters[V].Read() & PPU_ADDRESS_MASK, lData);
+            mInternalRegisters[V].Write(mInternalRegisters[V].Read() + ((mRegisters[PPUCTRL].Read() & VRAM) ? 32 : 1));
+            break;
+
+        default:
+            // PPUSTATUS is read only.
+            break;
+    }
+}
+
+//--------//
+// OamDma
+//
+// Takes a whole page written to OAM by DMA at once, the same as 256 writes to OAMDATA.
+// Writing starts at OAMADDR and wraps around, leaving OAMADDR where it was.
+//
+// param[in] lData   OAM_SIZE bytes to copy.
+//--------//
+//
+void Ppu2C02::OamDma(const uint8_t * lData)
+{
+    uint8_t * lOam   = reinterpret_cast<uint8_t *>(mOam);
+    uint8_t   lStart = mRegisters[OAMADDR].Read();
+    size_t    lFirst = OAM_SIZE - lStart;
+
+    // Most games upload the same sprites frame after frame while nothing moves.
+    if (memcmp(lOam + lStart, lData, lFirst) == 0 && memcmp(lOam, lData + lFirst, lStart) == 0)
+    {
+        return;
+    }
+
+    memcpy(lOam + lStart, lData, lFirst);
+    memcpy(lOam, lData + lFirst, lStart);
+    mSpriteIndexDirty = true;
+    mFrameDirty       = true;
+}
+
+//--------//
+// Clock
+//
+// Advances the ppu by one dot. The frame timing (vblank, NMI, status flags, odd frame skip)
+// is the same no matter which renderer is selected.
+//--------//
+//
+void Ppu2C02::Clock(void)
+{
+    bool lVisible   = mScanline < POST_RENDER_SCANLINE;
+    bool lPreRender = mScanline == PRE_RENDER_SCANLINE;
+
+    if (mDot == 0)
+    {
+        mSpriteZeroHitDot = -1;
+        if (mWatchA12)
+        {
+            UpdateA12RiseDot();
+        }
+
+        // Everything the cpu does to the scroll from here until vblank goes into the log.
+        if (mScanline == 0)
+        {
+            mFrameStart.mV       = mInternalRegisters[V].Read();
+            mFrameStart.mT       = mInternalRegisters[T].Read();
+            mFrameStart.mX       = mInternalRegisters[X].Read();
+            mFrameStart.mControl = mRegisters[PPUCTRL].Read();
+            mFrameStart.mMask    = mRegisters[PPUMASK].Read();
+            mWriteCount          = 0;
+            mLogging             = true;
+        }
+    }
+
+    // The pre-render line clears the flags from the last frame.
+    if (lPreRender && mDot == 1)
+    {
+        mRegisters[PPUSTATUS].ClearFlag(VERTICAL_BLANK | SPRITE_0_HIT | SPRITE_OFLOW);
+    }
+
+    if (lVisible && mDot == 1)
+    {
+        mLineMask[mScanline] = mRegisters[PPUMASK].Read();
+    }
+
+    if (lVisible || lPreRender)
+    {
+        if (mRenderMode == DOT_RENDERER && !mTimingOnly)
+        {
+            ClockDotRenderer();
+        }
+        else
+        {
+            // Draw the entire line up front, then keep the scroll registers moving
+            // at the points the hardware would.
+            if (lVisible && mDot == 1)
+            {
+                if (mTimingOnly || mRenderMode == DEFERRED_RENDERER || mRenderMode == PIPELINED_RENDERER)
+                {
+                    TimeScanline();
+                }
+                else
+                {
+                    RenderScanline();
+                }
+            }
+            if (IsRenderingEnabled())
+            {
+                if (mDot == 256)
+                {
+                    IncrementScrollY();
+                }
+                else if (mDot == 257)
+                {
+                    TransferAddressX();
+                }
+                else if (lPreRender && mDot == 280)
+                {
+                    TransferAddressY();
+                }
+            }
+        }
+    }
+
+    // Sprite 0 hit lands on the dot the overlapping pixel is drawn.
+    if (mDot == mSpriteZeroHitDot)
+    {
+        mRegisters[PPUSTATUS].SetFlag(SPRITE_0_HIT);
+    }
+
+    // The cartridge sees A12 rise where the fetches go from one pattern table to the other.
+    if (mDot == mA12RiseDot)
+    {
+        mA12RiseDot = -1;
+        mCartridge->ClockA12();
+    }
+
+    // Start of vertical blank, the frame is done.
+    if (mScanline == VBLANK_SCANLINE && mDot == 1)
+    {
+        mLogging = false;
+        if (!mTimingOnly)
+        {
+            FinishFrame();
+        }
+
+        mRegisters[PPUSTATUS].SetFlag(VERTICAL_BLANK);
+        mFrameComplete = true;
+        if (mRegisters[PPUCTRL].Read() & NMI)
+        {
+            mNmiOccurred = true;
+        }
+    }
+
+    // Move on to the next dot. Odd frames skip the last dot of the pre-render line while rendering.
+    ++mDot;
+    if (lPreRender && mDot == DOTS_PER_SCANLINE - 1 && mOddFrame && IsRenderingEnabled())
+    {
+        ++mDot;
+    }
+    if (mDot >= DOTS_PER_SCANLINE)
+    {
+        mDot = 0;
+        ++mScanline;
+        if (mScanline >= SCANLINES_PER_FRAME)
+        {
+            mScanline = 0;
+            mOddFrame = !mOddFrame;
+        }
+    }
+}
+
+//--------//
+// PollNmi
+//
+// Checks if the ppu has raised an NMI since the last poll.
+//
+// returns  True if the cpu should be interrupted.
+//--------//
+//
+bool Ppu2C02::PollNmi(void)
+{
+    bool lNmi    = mNmiOccurred;
+    mNmiOccurred = false;
+    return lNmi;
+}
+
+//--------//
+// GetFrameHash
+//
+// Hashes the frame buffer (64-bit FNV-1a). Used to compare the output of the renderers.
+//
+// returns  Hash of the current frame.
+//--------//
+//
+uint64_t Ppu2C02::GetFrameHash(void)
+{
+    const uint8_t * lPixel = &mFrameBuffer[0][0];
+    uint64_t        lHash  = 0xCBF29CE484222325ULL;
+
+    for (int lIndex = 0; lIndex < SCREEN_WIDTH * SCREEN_HEIGHT; ++lIndex)
+    {
+        lHash ^= lPixel[lIndex];
+        lHash *= 0x100000001B3ULL;
+    }
+    return lHash;
+}
+
+//--------//
+// REGISTER LOG
+//
+
+//--------//
+// LogWrite
+//
+// Adds a register write to this frame's log.
+//
+// param[in] lRegister   PPUCTRL, PPUMASK, PPUSCROLL or PPUADDR.
+// param[in] lData       Data written.
+//--------//
+//
+void Ppu2C02::LogWrite(uint8_t lRegister, uint8_t lData)
+{
+    if (mWriteCount >= MAX_LOGGED_WRITES)
     {
         return;
     }
-    mSystem->Write(lAddress, lData);
+
+    LoggedWrite & lWrite = mWriteLog[mWriteCount++];
+    lWrite.mScanline = mScanline;
+    lWrite.mDot      = mDot;
+    lWrite.mRegister = lRegister;
+    lWrite.mData     = lData;
+    lWrite.mLatch    = mInternalRegisters[W].Read();
+}
+
+//--------//
+// ReplayWrites
+//
+// Applies the logged writes that landed before a given dot to a line state, the same
+// way CpuWrite applied them to the registers.
+//
+// param[in,out] lState      State to update.
+// param[in]     lNext       First write in the log not applied yet.
+// param[in]     lScanline   Scanline of the dot.
+// param[in]     lDot        The dot, writes stamped with it came before it.
+// returns  First write in the log still not applied.
+//--------//
+//
+uint16_t Ppu2C02::ReplayWrites(LineState & lState, uint16_t lNext, int lScanline, int lDot)
+{
+    for (; lNext < mWriteCount; ++lNext)
+    {
+        const LoggedWrite & lWrite = mWriteLog[lNext];
+        if (lWrite.mScanline > lScanline || (lWrite.mScanline == lScanline && lWrite.mDot > lDot))
+        {
+            break;
+        }
+
+        switch (lWrite.mRegister)
+        {
+            case PPUCTRL:
+                lState.mControl = lWrite.mData;
+                lState.mT       = (lState.mT & ~NAMETABLE_SEL) | ((lWrite.mData & BASE_NAMETBL) << 10);
+                break;
+
+            case PPUMASK:
+                lState.mMask = lWrite.mData;
+                break;
+
+            case PPUSCROLL:
+                if (lWrite.mLatch == 0)
+                {
+                    lState.mT = (lState.mT & ~COARSE_X) | (lWrite.mData >> 3);
+                    lState.mX = lWrite.mData & 0x07;
+                }
+                else
+                {
+                    lState.mT = (lState.mT & ~(COARSE_Y | FINE_Y)) | ((lWrite.mData & 0x07) << 12) | ((lWrite.mData >> 3) << 5);
+                }
+                break;
+
+            case PPUADDR:
+                if (lWrite.mLatch == 0)
+                {
+                    lState.mT = (lState.mT & 0x00FF) | ((lWrite.mData & 0x3F) << 8);
+                }
+                else
+                {
+                    lState.mT = (lState.mT & 0xFF00) | lWrite.mData;
+                    lState.mV = lState.mT;
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+    return lNext;
+}
+
+//--------//
+// FETCH PRIMITIVES
+//
+
+//--------//
+// FetchNametableByte
+//
+// Fetches the tile id the given vram address points at.
+//
+// param[in] lVramAddress   Scroll position in the V register layout.
+// returns  Tile id.
+//--------//
+//
+DataType Ppu2C02::FetchNametableByte(uint16_t lVramAddress)
+{
+    return Read(NAME_TABLE_START | (lVramAddress & 0x0FFF));
+}
+
+//--------//
+// FetchAttributeBits
+//
+// Fetches the 2 palette bits of the tile the given vram address points at.
+//
+// param[in] lVramAddress   Scroll position in the V register layout.
+// returns  Palette (0-3) of the tile.
+//--------//
+//
+DataType Ppu2C02::FetchAttributeBits(uint16_t lVramAddress)
+{
+    DataType lAttribute = Read(NAME_TABLE_START | ATTRIBUTE_OFFSET | (lVramAddress & NAMETABLE_SEL) |
+                               ((lVramAddress >> 4) & 0x38) | ((lVramAddress >> 2) & 0x07));
+
+    // Each byte covers a 4x4 tile area, every 2x2 quadrant gets 2 bits.
+    uint8_t lShift = ((lVramAddress >> 4) & 0x04) | (lVramAddress & 0x02);
+    return (lAttribute >> lShift) & 0x03;
+}
+
+//--------//
+// FetchPatternRow
+//
+// Fetches both bitplanes for one row of a tile.
+//
+// param[in]  lTableBase   Pattern table to use, $0000 or $1000.
+// param[in]  lTile        Tile id within the pattern table.
+// param[in]  lRow         Row (0-7) within the tile.
+// param[out] lLow         Low bitplane.
+// param[out] lHigh        High bitplane.
+//--------//
+//
+void Ppu2C02::FetchPatternRow(AddressType lTableBase, uint8_t lTile, uint8_t lRow, uint8_t * lLow, uint8_t * lHigh)
+{
+    AddressType lAddress = lTableBase + (lTile << 4) + lRow;
+    *lLow  = Read(lAddress);
+    *lHigh = Read(lAddress + 8);
+}
+
+//--------//
+// FetchTileRow
+//
+// Fetches one row of a tile already decoded into pixels by the cartridge's tile cache.
+//
+// param[in]  lTableBase   Pattern table to use, $0000 or $1000.
+// param[in]  lTile        Tile id within the pattern table.
+// param[in]  lRow         Row (0-7) within the tile.
+// param[in]  lFlip        Should the row be horizontally flipped.
+// returns  8 pixels (0-3), leftmost first.
+//--------//
+//
+const uint8_t * Ppu2C02::FetchTileRow(AddressType lTableBase, uint8_t lTile, uint8_t lRow, bool lFlip)
+{
+    AddressType lAddress = lTableBase + (lTile << 4) + lRow;
+
+    if (nullptr == mCartridge)
+    {
+        return ChrTileCache::GetBlankRow();
+    }
+
+    // Unmapped pages have an offset past the end of CHR memory, which the cache answers with a blank row.
+    return mCartridge->GetTileRow(mChrPageOffset[lAddress >> PPU_PAGE_SHIFT] + (lAddress & PPU_PAGE_MASK), lFlip);
+}
+
+//--------//
+// BuildSpriteIndex
+//
+// Sorts every sprite into the buckets of the scanlines it covers, keeping the first 8
+// in OAM order and noting if there were more.
+//--------//
+//
+void Ppu2C02::BuildSpriteIndex(void)
+{
+    int lHeight = (mRegisters[PPUCTRL].Read() & SPRITE_SIZE) ? 16 : 8;
+    int lLast;
+
+    for (int lLine = 0; lLine < NUM_INDEXED_SCANLINES; ++lLine)
+    {
+        mSpriteBuckets[lLine].mCount    = 0;
+        mSpriteBuckets[lLine].mOverflow = false;
+    }
+
+    for (int lIndex = 0; lIndex < ObjectAttributeMemory::NUM_PRIMARY_SPRITES; ++lIndex)
+    {
+        lLast = mOam[lIndex].mYPos + lHeight;
+        if (lLast > NUM_INDEXED_SCANLINES)
+        {
+            lLast = NUM_INDEXED_SCANLINES;
+        }
+
+        for (int lLine = mOam[lIndex].mYPos; lLine < lLast; ++lLine)
+        {
+            SpriteBucket & lBucket = mSpriteBuckets[lLine];
+            if (lBucket.mCount == ObjectAttributeMemory::NUM_SECONDARY_SPRITES)
+            {
+                lBucket.mOverflow = true;
+            }
+            else
+            {
+                lBucket.mSprites[lBucket.mCount++] = lIndex;
+            }
+        }
+    }
+
+    mSpriteIndexDirty = false;
+}
+
+//--------//
+// EvaluateSprites
+//
+// Finds the first 8 sprites in OAM that are in range of a scanline, copying them
+// into the secondary OAM. Flags sprite overflow when more are found. The search
+// itself is done ahead of time by BuildSpriteIndex.
+//
+// param[in] lScanline   Scanline to compare the sprite Y positions against.
+//--------//
+//
+void Ppu2C02::EvaluateSprites(int lScanline)
+{
+    mSpriteCount      = 0;
+    mSpriteZeroOnLine = false;
+
+    if (lScanline < 0 || lScanline >= NUM_INDEXED_SCANLINES)
+    {
+        return;
+    }
+
+    if (mSpriteIndexDirty)
+    {
+        BuildSpriteIndex();
+    }
+
+    const SpriteBucket & lBucket = mSpriteBuckets[lScanline];
+    for (uint8_t lIndex = 0; lIndex < lBucket.mCount; ++lIndex)
+    {
+        mSecondaryOam[lIndex] = mOam[lBucket.mSprites[lIndex]];
+    }
+    mSpriteCount      = lBucket.mCount;
+    mSpriteZeroOnLine = (lBucket.mCount > 0) && (lBucket.mSprites[0] == 0);
+
+    if (lBucket.mOverflow)
+    {
+        mRegisters[PPUSTATUS].SetFlag(SPRITE_OFLOW);
+    }
+}
+
+//--------//
+// FetchSpriteRows
+//
+// Fetches the pattern row of every sprite in the secondary OAM, with flipping applied.
+//
+// param[in] lScanline   Scanline the sprites were evaluated against.
+//--------//
+//
+void Ppu2C02::FetchSpriteRows(int lScanline)
+{
+    // Only the dot renderer shifts out bitplanes, everything else works on decoded rows.
+    FetchSpriteRows(lScanline, mSecondaryOam, mSpriteCount, mRegisters[PPUCTRL].Read(), mRenderMode != DOT_RENDERER || mTimingOnly,
+                    mSpriteRows);
+}
+
+//--------//
+// FetchSpriteRows
+//
+// Fetches the pattern row of each given sprite, with flipping applied.
+//
+// param[in]  lScanline   Scanline the sprites were evaluated against.
+// param[in]  lSprites    Sprites in range of the scanline.
+// param[in]  lCount      Number of sprites.
+// param[in]  lControl    PPUCTRL to fetch with.
+// param[in]  lDecoded    Fetch decoded rows from the tile cache, otherwise bitplanes.
+// param[out] lRows       One row for each sprite.
+//--------//
+//
+void Ppu2C02::FetchSpriteRows(int lScanline, const ObjectAttributeMemory * lSprites, uint8_t lCount, uint8_t lControl, bool lDecoded,
+                              SpriteRow * lRows)
+{
+    uint8_t     lHeight  = (lControl & SPRITE_SIZE) ? 16 : 8;
+    AddressType lTable;
+    uint8_t     lTile;
+    uint8_t     lRow;
+
+    for (uint8_t lIndex = 0; lIndex < lCount; ++lIndex)
+    {
+        const ObjectAttributeMemory & lSprite = lSprites[lIndex];
+
+        lRow = static_cast<uint8_t>(lScanline - lSprite.mYPos);
+        if (lSprite.mAttribute & ObjectAttributeMemory::ATTR_FLIP_VERTICAL)
+        {
+            lRow = lHeight - 1 - lRow;
+        }
+
+        // 8x16 sprites pick their own pattern table and use two tiles stacked on top of each other.
+        if (lHeight == 16)
+        {
+            lTable = (lSprite.mTileIndex & ObjectAttributeMemory::BANK_TILE_BIT) ? 0x1000 : 0x0000;
+            lTile  = (lSprite.mTileIndex & ObjectAttributeMemory::TILE_NUM_MASK) + ((lRow >= 8) ? 1 : 0);
+            lRow  &= 0x07;
+        }
+        else
+        {
+            lTable = (lControl & SPRITE_PATTBL) ? 0x1000 : 0x0000;
+            lTile  = lSprite.mTileIndex;
+        }
+
+        SpriteRow & lOut = lRows[lIndex];
+        if (lDecoded)
+        {
+            lOut.mPixels = FetchTileRow(lTable, lTile, lRow, (lSprite.mAttribute & ObjectAttributeMemory::ATTR_FLIP_HORIZONAL) != 0);
+        }
+        else
+        {
+            FetchPatternRow(lTable, lTile, lRow, &lOut.mLow, &lOut.mHigh);
+            if (lSprite.mAttribute & ObjectAttributeMemory::ATTR_FLIP_HORIZONAL)
+            {
+                lOut.mLow  = ReverseBits(lOut.mLow);
+                lOut.mHigh = ReverseBits(lOut.mHigh);
+            }
+        }
+        lOut.mAttribute = lSprite.mAttribute;
+        lOut.mXPos      = lSprite.mXPos;
+    }
+}
+
+//--------//
+// ComposePixel
+//
+// Picks between the background and sprite pixel, applying the left column masks and
+// sprite priority, and detects sprite 0 hits.
+//
+// param[in] lX                 Pixel column (0-255).
+// param[in] lBgPixel           Background pixel (0-3).
+// param[in] lBgPalette         Background palette (0-3).
+// param[in] lSpritePixel       Sprite pixel (0-3).
+// param[in] lSpriteAttribute   Attribute byte of the sprite the pixel came from.
+// param[in] lSpriteZero        Did the sprite pixel come from sprite 0.
+// returns  6-bit color of the pixel.
+//--------//
+//
+uint8_t Ppu2C02::ComposePixel(int lX, uint8_t lBgPixel, uint8_t lBgPalette, uint8_t lSpritePixel, uint8_t lSpriteAttribute, bool lSpriteZero)
+{
+    uint8_t lMask = mRegisters[PPUMASK].Read();
+    uint8_t lIndex;
+
+    if (!(lMask & SHOW_BCKGND) || (lX < 8 && !(lMask & LEFT_BCKGRND)))
+    {
+        lBgPixel = 0;
+    }
+    if (!(lMask & SHOW_SPRITES) || (lX < 8 && !(lMask & LEFT_SPRITES)))
+    {
+        lSpritePixel = 0;
+    }
+
+    // Sprite 0 hit never happens on the last column.
+    if (lBgPixel && lSpritePixel && lSpriteZero && lX != SCREEN_WIDTH - 1 && mSpriteZeroHitDot < 0)
+    {
+        mSpriteZeroHitDot = lX + 1;
+    }
+
+    if (lSpritePixel && (!lBgPixel || !(lSpriteAttribute & ObjectAttributeMemory::ATTR_PRIO)))
+    {
+        lIndex = 0x10 | ((lSpriteAttribute & ObjectAttributeMemory::ATTR_PALETTE) << 2) | lSpritePixel;
+    }
+    else if (lBgPixel)
+    {
+        lIndex = (lBgPalette << 2) | lBgPixel;
+    }
+    else
+    {
+        lIndex = 0;
+    }
+    return mPalette[lIndex] & COLOR_MASK;
+}
+
+//--------//
+// IncrementScrollX
+//
+// Moves V to the next tile, wrapping into the horizontally adjacent name table.
+//--------//
+//
+void Ppu2C02::IncrementScrollX(void)
+{
+    uint16_t lV = mInternalRegisters[V].Read();
+
+    if ((lV & COARSE_X) == COARSE_X)
+    {
+        lV &= ~COARSE_X;
+        lV ^= NAMETABLE_X;
+    }
+    else
+    {
+        ++lV;
+    }
+    mInternalRegisters[V].Write(lV);
+}
+
+//--------//
+// IncrementScrollY
+//
+// Moves V down one pixel row, wrapping into the vertically adjacent name table after row 29.
+//--------//
+//
+void Ppu2C02::IncrementScrollY(void)
+{
+    mInternalRegisters[V].Write(IncrementScrollY(mInternalRegisters[V].Read()));
+}
+
+//--------//
+// IncrementScrollY
+//
+// Moves a scroll position down one pixel row, for renderers working on their own copy of V.
+//
+// param[in] lV   Scroll position in the V register layout.
+// returns  The position one row down.
+//--------//
+//
+uint16_t Ppu2C02::IncrementScrollY(uint16_t lV)
+{
+    uint16_t lCoarseY;
+
+    if ((lV & FINE_Y) != FINE_Y)
+    {
+        lV += 0x1000;
+    }
+    else
+    {
+        lV &= ~FINE_Y;
+        lCoarseY = (lV & COARSE_Y) >> 5;
+        if (lCoarseY == 29)
+        {
+            lCoarseY = 0;
+            lV ^= NAMETABLE_Y;
+        }
+        else if (lCoarseY == 31)
+        {
+            // Out of bounds coarse Y wraps without switching name tables.
+            lCoarseY = 0;
+        }
+        else
+        {
+            ++lCoarseY;
+        }
+        lV = (lV & ~COARSE_Y) | (lCoarseY << 5);
+    }
+    return lV;
+}
+
+//--------//
+// TransferAddressX
+//
+// Copies the horizontal scroll bits from T to V.
+//--------//
+//
+void Ppu2C02::TransferAddressX(void)
+{
+    mInternalRegisters[V].Write((mInternalRegisters[V].Read() & ~HORIZONTAL_BITS) | (mInternalRegisters[T].Read() & HORIZONTAL_BITS));
+}
+
+//--------//
+// TransferAddressY
+//
+// Copies the vertical scroll bits from T to V.
+//--------//
+//
+void Ppu2C02::TransferAddressY(void)
+{
+    mInternalRegisters[V].Write((mInternalRegisters[V].Read() & ~VERTICAL_BITS) | (mInternalRegisters[T].Read() & VERTICAL_BITS));
+}
+
+//--------//
+// RENDERERS
+//
+
+//--------//
+// RenderScanline
+//
+// The fast renderer. Draws the current scanline in one go from the scroll position
+// in V. Changes made to the registers partway through the line are not seen.
+//--------//
+//
+void Ppu2C02::RenderScanline(void)
+{
+    LineState lState;
+
+    lState.mV       = mInternalRegisters[V].Read();
+    lState.mT       = mInternalRegisters[T].Read();
+    lState.mX       = mInternalRegisters[X].Read();
+    lState.mControl = mRegisters[PPUCTRL].Read();
+    lState.mMask    = mRegisters[PPUMASK].Read();
+
+    // Sprite evaluation is what sets the overflow flag, so it still has to run here.
+    if (lState.mMask & (SHOW_BCKGND | SHOW_SPRITES))
+    {
+        EvaluateSprites(mScanline - 1);
+    }
+    else
+    {
+        mSpriteCount = 0;
+    }
+
+    RenderLine(mScanline, lState, mFrameBuffer[mScanline], &mSpriteZeroHitDot);
+}
+
+//--------//
+// RenderLine
+//
+// Draws one scanline in one go. Everything it needs comes from lState and memory,
+// none of the ppu's registers or flags are touched. The per-pixel work runs through
+// PixelKernels on whole lines.
+//
+// param[in]  lScanline           Scanline to draw.
+// param[in]  lState              Scroll and control the line is drawn with.
+// param[out] lOut                SCREEN_WIDTH colors.
+// param[out] lSpriteZeroHitDot   Set to the dot of a sprite 0 hit if there is one, nullptr to skip the check.
+//--------//
+//
+void Ppu2C02::RenderLine(int lScanline, const LineState & lState, uint8_t * lOut, int16_t * lSpriteZeroHitDot)
+{
+    const PixelKernels::Table & lKernels = PixelKernels::Get();
+
+    uint8_t   lMask = lState.mMask;
+    SpriteRow lRows[ObjectAttributeMemory::NUM_SECONDARY_SPRITES];
+    uint8_t   lSpriteCount;
+    bool      lSpriteZero;
+
+    // Background is drawn a tile wider than the screen, then read starting at fine X.
+    uint8_t   lBgPixel[SCREEN_WIDTH + 8]      = {0};
+    uint8_t   lBgPalette[SCREEN_WIDTH + 8]    = {0};
+    uint8_t   lBgIndex[SCREEN_WIDTH]          = {0};
+    uint8_t   lSpriteIndex[SCREEN_WIDTH]      = {0};
+    uint8_t   lSpriteBehind[SCREEN_WIDTH]     = {0};
+    uint8_t   lIndices[SCREEN_WIDTH];
+
+    // Nothing is fetched with rendering off, everything is the backdrop color.
+    if (!(lMask & (SHOW_BCKGND | SHOW_SPRITES)))
+    {
+        memset(lOut, mPalette[0] & COLOR_MASK, SCREEN_WIDTH);
+        return;
+    }
+
+    // Background, 33 tiles so the line is still covered when scrolled by a fine X amount.
+    if (lMask & SHOW_BCKGND)
+    {
+        uint16_t    lV     = lState.mV;
+        uint8_t     lFineY = (lV & FINE_Y) >> 12;
+        AddressType lTable = (lState.mControl & BACK_PATTBL) ? 0x1000 : 0x0000;
+
+        for (int lTile = 0; lTile < (SCREEN_WIDTH / 8) + 1; ++lTile)
+        {
+            memset(&lBgPalette[lTile * 8], FetchAttributeBits(lV), 8);
+            memcpy(&lBgPixel[lTile * 8], FetchTileRow(lTable, FetchNametableByte(lV), lFineY, false), 8);
+
+            // Same wrap as IncrementScrollX, but on a local copy.
+            if ((lV & COARSE_X) == COARSE_X)
+            {
+                lV &= ~COARSE_X;
+                lV ^= NAMETABLE_X;
+            }
+            else
+            {
+                ++lV;
+            }
+        }
+
+        lKernels.mMergeAttributes(&lBgPixel[lState.mX], &lBgPalette[lState.mX], lBgIndex, SCREEN_WIDTH);
+        if (!(lMask & LEFT_BCKGRND))
+        {
+            memset(lBgIndex, 0, 8);
+        }
+    }
+
+    // Sprites were evaluated on the previous line, so compare against that one. Lower
+    // OAM indices are drawn last so they win when sprites overlap.
+    lSpriteCount = GatherSprites(lScanline - 1, lState.mControl, lRows, &lSpriteZero);
+    if (lMask & SHOW_SPRITES)
+    {
+        for (int lIndex = lSpriteCount - 1; lIndex >= 0; --lIndex)
+        {
+            const SpriteRow & lRow     = lRows[lIndex];
+            uint8_t           lPalette = 0x10 | ((lRow.mAttribute & ObjectAttributeMemory::ATTR_PALETTE) << 2);
+            uint8_t           lBehind  = (lRow.mAttribute & ObjectAttributeMemory::ATTR_PRIO) ? 0xFF : 0x00;
+
+            for (int lColumn = 0, lX = lRow.mXPos; lColumn < 8 && lX < SCREEN_WIDTH; ++lColumn, ++lX)
+            {
+                if (lRow.mPixels[lColumn])
+                {
+                    lSpriteIndex[lX]  = lPalette | lRow.mPixels[lColumn];
+                    lSpriteBehind[lX] = lBehind;
+                }
+            }
+        }
+        if (!(lMask & LEFT_SPRITES))
+        {
+            memset(lSpriteIndex, 0, 8);
+        }
+
+        // Sprite 0 can only hit within its own 8 pixels, and never on the last column.
+        if (lSpriteZero && lSpriteZeroHitDot)
+        {
+            const SpriteRow & lRow = lRows[0];
+            for (int lColumn = 0, lX = lRow.mXPos; lColumn < 8 && lX < SCREEN_WIDTH - 1; ++lColumn, ++lX)
+            {
+                if (lRow.mPixels[lColumn] && lBgIndex[lX] && (lX >= 8 || (lMask & LEFT_SPRITES)))
+                {
+                    *lSpriteZeroHitDot = lX + 1;
+                    break;
+                }
+            }
+        }
+    }
+
+    lKernels.mResolvePriority(lBgIndex, lSpriteIndex, lSpriteBehind, lIndices, SCREEN_WIDTH);
+    for (int lX = 0; lX < SCREEN_WIDTH; ++lX)
+    {
+        lOut[lX] = mPalette[lIndices[lX]] & COLOR_MASK;
+    }
+}
+
+//--------//
+// GatherSprites
+//
+// Finds the sprites in range of a scanline and fetches their decoded rows, without
+// touching the secondary OAM or the status flags. Uses the sprite index when it was
+// built for the same sprite size, otherwise searches OAM.
+//
+// param[in]  lScanline     Scanline to compare the sprite Y positions against.
+// param[in]  lControl      PPUCTRL the line is drawn with.
+// param[out] lRows         Up to 8 sprite rows, in OAM order.
+// param[out] lSpriteZero   Is the first row sprite 0.
+// returns  Number of sprite rows.
+//--------//
+//
+uint8_t Ppu2C02::GatherSprites(int lScanline, uint8_t lControl, SpriteRow * lRows, bool * lSpriteZero)
+{
+    ObjectAttributeMemory lSprites[ObjectAttributeMemory::NUM_SECONDARY_SPRITES];
+    uint8_t               lCount  = 0;
+    int                   lHeight = (lControl & SPRITE_SIZE) ? 16 : 8;
+
+    *lSpriteZero = false;
+    if (lScanline < 0 || lScanline >= NUM_INDEXED_SCANLINES)
+    {
+        return 0;
+    }
+
+    if (!mSpriteIndexDirty && !((lControl ^ mRegisters[PPUCTRL].Read()) & SPRITE_SIZE))
+    {
+        const SpriteBucket & lBucket = mSpriteBuckets[lScanline];
+        for (lCount = 0; lCount < lBucket.mCount; ++lCount)
+        {
+            lSprites[lCount] = mOam[lBucket.mSprites[lCount]];
+        }
+        *lSpriteZero = (lBucket.mCount > 0) && (lBucket.mSprites[0] == 0);
+    }
+    else
+    {
+        for (int lIndex = 0; lIndex < ObjectAttributeMemory::NUM_PRIMARY_SPRITES && lCount < ObjectAttributeMemory::NUM_SECONDARY_SPRITES; ++lIndex)
+        {
+            if (lScanline >= mOam[lIndex].mYPos && lScanline < mOam[lIndex].mYPos + lHeight)
+            {
+                *lSpriteZero |= (lIndex == 0);
+                lSprites[lCount++] = mOam[lIndex];
+            }
+        }
+    }
+
+    FetchSpriteRows(lScanline, lSprites, lCount, lControl, true, lRows);
+    return lCount;
+}
+
+//--------//
+// BuildLineStates
+//
+// Works out the state every scanline of the frame started with, starting from the registers
+// scanline 0 began with and replaying the logged writes at the dots they landed before.
+// The scroll updates at dots 256 and 257 are replayed along with them, so a frame with an
+// empty log is just 240 identical steps, and a split screen changes between its writes.
+//--------//
+//
+void Ppu2C02::BuildLineStates(void)
+{
+    LineState lState = mFrameStart;
+    uint16_t  lNext  = 0;
+
+    for (int lScanline = 0; lScanline < SCREEN_HEIGHT; ++lScanline)
+    {
+        lNext = ReplayWrites(lState, lNext, lScanline, 1);
+        mLineStates[lScanline] = lState;
+
+        lNext = ReplayWrites(lState, lNext, lScanline, 256);
+        if (lState.mMask & (SHOW_BCKGND | SHOW_SPRITES))
+        {
+            lState.mV = IncrementScrollY(lState.mV);
+        }
+
+        lNext = ReplayWrites(lState, lNext, lScanline, 257);
+        if (lState.mMask & (SHOW_BCKGND | SHOW_SPRITES))
+        {
+            lState.mV = (lState.mV & ~HORIZONTAL_BITS) | (lState.mT & HORIZONTAL_BITS);
+        }
+    }
+}
+
+//--------//
+// RenderFrame
+//
+// The deferred renderer. Draws the whole frame once it's over from the scanline states
+// BuildLineStates worked out. Status flags were already taken care of by the timing pass.
+// The scanlines don't depend on each other, so the drawing is split into bands across the
+// render threads.
+//--------//
+//
+void Ppu2C02::RenderFrame(void)
+{
+    int lThreads = mRenderPool.GetThreads();
+    int lBand;
+
+    if (mSpriteIndexDirty)
+    {
+        BuildSpriteIndex();
+    }
+
+    if (lThreads == 1)
+    {
+        RenderLines(0, SCREEN_HEIGHT);
+        return;
+    }
+
+    // Drawing only reads memory, as long as nothing gets filled in on first use. Pick the
+    // kernels and decode the tiles of every mapped CHR page before the threads start.
+    PixelKernels::Get();
+    for (uint8_t lPage = 0; mCartridge && lPage < NUM_PATTERN_PAGES; ++lPage)
+    {
+        if (mChrPageOffset[lPage] != UNMAPPED_PAGE)
+        {
+            mCartridge->DecodeTiles(mChrPageOffset[lPage], PPU_PAGE_SIZE);
+        }
+    }
+
+    lBand = (SCREEN_HEIGHT + lThreads - 1) / lThreads;
+    for (int lIndex = 0; lIndex < lThreads; ++lIndex)
+    {
+        mBands[lIndex].mFirst = (lIndex * lBand < SCREEN_HEIGHT) ? lIndex * lBand : SCREEN_HEIGHT;
+        mBands[lIndex].mLast  = (mBands[lIndex].mFirst + lBand < SCREEN_HEIGHT) ? mBands[lIndex].mFirst + lBand : SCREEN_HEIGHT;
+    }
+    mRenderPool.Run(mBandJobs, lThreads);
+}
+
+//--------//
+// RenderLines
+//
+// Draws a band of scanlines from the states RenderFrame worked out.
+//
+// param[in] lFirst   First scanline of the band.
+// param[in] lLast    One past the last scanline of the band.
+//--------//
+//
+void Ppu2C02::RenderLines(int lFirst, int lLast)
+{
+    for (int lScanline = lFirst; lScanline < lLast; ++lScanline)
+    {
+        RenderLine(lScanline, mLineStates[lScanline], mFrameBuffer[lScanline], nullptr);
+    }
+}
+
+//--------//
+// FinishFrame
+//
+// Called at vblank for frames that are shown. Decides if the frame is the same as the last one
+// drawn and draws it with the deferred renderer if it isn't. The live renderers have already
+// drawn it by now, the same pixels as before if it's reused, so for them this only lets the
+// output stage skip its work. The dot renderer can change the scroll partway through a scanline,
+// so a frame of its only counts as reused with nothing in the log. The pipelined renderer hands
+// the frame on and takes the one before it instead.
+//--------//
+//
+void Ppu2C02::FinishFrame(void)
+{
+    bool lReused;
+
+    BuildLineStates();
+
+    lReused = mFrameDrawn && !mFrameDirty && (mRenderMode != DOT_RENDERER || mWriteCount == 0) && SameLineStates();
+    if (mRenderMode == PIPELINED_RENDERER)
+    {
+        mFrameReused = PipelineFrame(lReused);
+    }
+    else
+    {
+        mFrameReused = lReused;
+        if (mRenderMode == DEFERRED_RENDERER && !lReused)
+        {
+            RenderFrame();
+        }
+    }
+
+    memcpy(mLastLineStates, mLineStates, sizeof(mLastLineStates));
+    mFrameDirty = false;
+    mFrameDrawn = true;
+}
+
+//--------//
+// SameLineStates
+//
+// Compares the scanline states of this frame against the last frame drawn. Field by field,
+// the padding in LineState isn't guaranteed to match.
+//
+// returns  If every scanline started the same way.
+//--------//
+//
+bool Ppu2C02::SameLineStates(void)
+{
+    for (int lScanline = 0; lScanline < SCREEN_HEIGHT; ++lScanline)
+    {
+        const LineState & lNew = mLineStates[lScanline];
+        const LineState & lOld = mLastLineStates[lScanline];
+
+        if (lNew.mV != lOld.mV || lNew.mT != lOld.mT || lNew.mX != lOld.mX || lNew.mControl != lOld.mControl || lNew.mMask != lOld.mMask)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+//--------//
+// SetRenderMode
+//
+// Picks the renderer. The pipelined renderer needs a second ppu to draw on, if that can't be
+// had it falls back to the deferred renderer, which draws the same frames without the thread.
+//
+// param[in] lMode   The renderer.
+//--------//
+//
+void Ppu2C02::SetRenderMode(RenderMode lMode)
+{
+    if (lMode == PIPELINED_RENDERER && nullptr == mPipelinePpu)
+    {
+        mPipelinePpu = new(std::nothrow) Ppu2C02();
+        if (nullptr == mPipelinePpu)
+        {
+            gErrorManager.Post(ErrorCodes::OUT_OF_MEMORY);
+            lMode = DEFERRED_RENDERER;
+        }
+        else
+        {
+            mPipelinePpu->SetRenderThreads(GetRenderThreads());
+            mPipelineJob.mPpu = mPipelinePpu;
+            mPipeline.SetThreads(2);
+        }
+    }
+    else if (lMode != PIPELINED_RENDERER)
+    {
+        StopPipeline();
+    }
+
+    mRenderMode     = lMode;
+    mFrameDrawn     = false;
+    mPipelineReused = false;
+}
+
+//--------//
+// SetRenderThreads
+//
+// Sets how many threads draw a deferred frame in bands, including the one drawing it.
+//
+// param[in] lThreads   Number of threads.
+//--------//
+//
+void Ppu2C02::SetRenderThreads(int lThreads)
+{
+    mPipeline.Wait();
+    mRenderPool.SetThreads(lThreads);
+    if (mPipelinePpu)
+    {
+        mPipelinePpu->SetRenderThreads(lThreads);
+    }
+}
+
+//--------//
+// PipelineFrame
+//
+// Takes the frame drawn while this one played out, then hands this one over to be drawn
+// while the next one plays out. Line masks swap places, this frame's go along with it and
+// the drawn frame's come back. Nothing is copied or drawn for a frame that's reused.
+//
+// param[in] lReused   Is the frame that just finished the same as the last one drawn.
+// returns  Is the frame now in the frame buffer the same as the one before it.
+//--------//
+//
+bool Ppu2C02::PipelineFrame(bool lReused)
+{
+    bool    lShownReused = mPipelineReused;
+    uint8_t lMasks[SCREEN_HEIGHT];
+
+    mPipeline.Wait();
+    if (!lShownReused)
+    {
+        memcpy(mFrameBuffer, mPipelinePpu->mFrameBuffer, sizeof(mFrameBuffer));
+    }
+    memcpy(lMasks, mPipelinePpu->mLineMask, sizeof(lMasks));
+    memcpy(mPipelinePpu->mLineMask, mLineMask, sizeof(mLineMask));
+    memcpy(mLineMask, lMasks, sizeof(mLineMask));
+
+    if (!lReused)
+    {
+        CopyFrameTo(mPipelinePpu);
+
+        // Nothing may get filled in on first use while the other thread draws. Pick the
+        // kernels and decode the tiles of every mapped CHR page here.
+        PixelKernels::Get();
+        for (uint8_t lPage = 0; mCartridge && lPage < NUM_PATTERN_PAGES; ++lPage)
+        {
+            if (mChrPageOffset[lPage] != UNMAPPED_PAGE)
+            {
+                mCartridge->DecodeTiles(mChrPageOffset[lPage], PPU_PAGE_SIZE);
+            }
+        }
+        mPipeline.Start(mPipelineJobs, 1);
+    }
+
+    mPipelineReused = lReused;
+    return lShownReused;
+}
+
+//--------//
+// CopyFrameTo
+//
+// Copies everything a frame is drawn from into another ppu, which can then draw it with
+// RenderFrame. CHR pages are shared, not copied.
+//
+// param[in] lPpu   The ppu to copy to.
+//--------//
+//
+void Ppu2C02::CopyFrameTo(Ppu2C02 * lPpu)
+{
+    memcpy(lPpu->mVram, mVram, sizeof(mVram));
+    lPpu->SetMirroring(mMirroring);
+    memcpy(lPpu->mPages, mPages, NUM_PATTERN_PAGES * sizeof(mPages[0]));
+    memcpy(lPpu->mChrPageOffset, mChrPageOffset, sizeof(mChrPageOffset));
+    memcpy(lPpu->mPalette, mPalette, sizeof(mPalette));
+    memcpy(lPpu->mOam, mOam, sizeof(mOam));
+    memcpy(lPpu->mLineStates, mLineStates, sizeof(mLineStates));
+    lPpu->mRegisters[PPUCTRL].Write(mRegisters[PPUCTRL].Read());
+    lPpu->mCartridge        = mCartridge;
+    lPpu->mSpriteIndexDirty = true;
+}
+
+//--------//
+// StopPipeline
+//
+// Waits for the frame being drawn, then lets go of the drawing thread and its ppu.
+//--------//
+//
+void Ppu2C02::StopPipeline(void)
+{
+    mPipeline.SetThreads(1);
+    if (mPipelinePpu)
+    {
+        delete mPipelinePpu;
+        mPipelinePpu = nullptr;
+    }
+    mPipelineJob.mPpu = nullptr;
+}
+
+//--------//
+// TimeScanline
+//
+// Stands in for RenderScanline in timing only mode. Sprite overflow comes from the
+// sprite index as usual. Sprite 0 hit is the only thing that needs pixels, so only
+// sprite 0's row and the one or two background tiles under it are fetched, and only
+// on lines where sprite 0 is in range with both layers turned on.
+//--------//
+//
+void Ppu2C02::TimeScanline(void)
+{
+    uint8_t lMask = mRegisters[PPUMASK].Read();
+
+    if (!(lMask & (SHOW_BCKGND | SHOW_SPRITES)))
+    {
+        mSpriteCount = 0;
+        return;
+    }
+
+    EvaluateSprites(mScanline - 1);
+    if (!mSpriteZeroOnLine || (lMask & (SHOW_BCKGND | SHOW_SPRITES)) != (SHOW_BCKGND | SHOW_SPRITES))
+    {
+        return;
+    }
+
+    // Sprite 0 is always first in the secondary OAM when it's on the line.
+    mSpriteCount = 1;
+    FetchSpriteRows(mScanline - 1);
+
+    const SpriteRow & lSprite = mSpriteRows[0];
+    uint16_t          lV      = mInternalRegisters[V].Read();
+    uint8_t           lFineX  = mInternalRegisters[X].Read();
+    uint8_t           lFineY  = (lV & FINE_Y) >> 12;
+    AddressType       lTable  = (mRegisters[PPUCTRL].Read() & BACK_PATTBL) ? 0x1000 : 0x0000;
+    int               lLoaded = -1;
+    const uint8_t *   lBgRow  = nullptr;
+
+    // Same limits as RenderScanline, within sprite 0's 8 pixels and never on the last column.
+    for (int lColumn = 0, lX = lSprite.mXPos; lColumn < 8 && lX < SCREEN_WIDTH - 1; ++lColumn, ++lX)
+    {
+        if (!lSprite.mPixels[lColumn] || (lX < 8 && (lMask & (LEFT_SPRITES | LEFT_BCKGRND)) != (LEFT_SPRITES | LEFT_BCKGRND)))
+        {
+            continue;
+        }
+
+        // Background tile under this pixel, counted in tiles from where the line starts.
+        int lTile = (lX + lFineX) >> 3;
+        if (lTile != lLoaded)
+        {
+            uint16_t lTileV   = lV;
+            uint16_t lCoarseX = (lV & COARSE_X) + lTile;
+            if (lCoarseX > COARSE_X)
+            {
+                lTileV ^= NAMETABLE_X;
+            }
+            lTileV  = (lTileV & ~COARSE_X) | (lCoarseX & COARSE_X);
+            lBgRow  = FetchTileRow(lTable, FetchNametableByte(lTileV), lFineY, false);
+            lLoaded = lTile;
+        }
+
+        if (lBgRow[(lX + lFineX) & 0x07])
+        {
+            mSpriteZeroHitDot = lX + 1;
+            return;
+        }
+    }
+}
+
+//--------//
+// ClockDotRenderer
+//
+// The accurate renderer. Runs one dot of the background fetch pipeline and shift
+// registers, following https://www.nesdev.org/wiki/PPU_rendering.
+//--------//
+//
+void Ppu2C02::ClockDotRenderer(void)
+{
+    bool    lVisible   = mScanline < POST_RENDER_SCANLINE;
+    bool    lPreRender = mScanline == PRE_RENDER_SCANLINE;
+    uint8_t lMask      = mRegisters[PPUMASK].Read();
+    uint8_t lBgPixel   = 0;
+    uint8_t lBgPalette = 0;
+
+    if (IsRenderingEnabled())
+    {
+        if ((mDot >= 2 && mDot <= 257) || (mDot >= 321 && mDot <= 337))
+        {
+            UpdateShifters();
+
+            // Each tile takes 8 dots: name table, attribute, low and high pattern fetches.
+            switch ((mDot - 1) & 0x07)
+            {
+                case 0:
+                    LoadBackgroundShifters();
+                    mNextTileId = FetchNametableByte(mInternalRegisters[V].Read());
+                    break;
+
+                case 2:
+                    mNextTileAttribute = FetchAttributeBits(mInternalRegisters[V].Read());
+                    break;
+
+                case 4:
+                    FetchPatternRow((mRegisters[PPUCTRL].Read() & BACK_PATTBL) ? 0x1000 : 0x0000, mNextTileId,
+                                    (mInternalRegisters[V].Read() & FINE_Y) >> 12, &mNextTileLow, &mNextTileHigh);
+                    break;
+
+                case 7:
+                    IncrementScrollX();
+                    break;
+
+                default:
+                    break;
+            }
+        }
+
+        if (mDot == 256)
+        {
+            IncrementScrollY();
+        }
+        else if (mDot == 257)
+        {
+            LoadBackgroundShifters();
+            TransferAddressX();
+        }
+        else if (lPreRender && mDot >= 280 && mDot <= 304)
+        {
+            TransferAddressY();
+        }
+    }
+
+    // Sprites for the next line are found at the end of this one, then their patterns
+    // are fetched and loaded into the sprite shift registers.
+    if (mDot == 257)
+    {
+        if (lVisible && IsRenderingEnabled())
+        {
+            EvaluateSprites(mScanline);
+        }
+        else
+        {
+            mSpriteCount = 0;
+        }
+    }
+    else if (mDot == 340)
+    {
+        FetchSpriteRows(mScanline);
+        for (uint8_t lIndex = 0; lIndex < mSpriteCount; ++lIndex)
+        {
+            mSpriteShifterLow[lIndex]  = mSpriteRows[lIndex].mLow;
+            mSpriteShifterHigh[lIndex] = mSpriteRows[lIndex].mHigh;
+            mSpriteCounter[lIndex]     = mSpriteRows[lIndex].mXPos;
+        }
+    }
+
+    if (!lVisible || mDot < 1 || mDot > SCREEN_WIDTH)
+    {
+        return;
+    }
+
+    // Produce a pixel.
+    if (!(lMask & (SHOW_BCKGND | SHOW_SPRITES)))
+    {
+        mFrameBuffer[mScanline][mDot - 1] = mPalette[0] & COLOR_MASK;
+        return;
+    }
+
+    if (lMask & SHOW_BCKGND)
+    {
+        uint16_t lBit = 0x8000 >> mInternalRegisters[X].Read();
+        lBgPixel   = (((mBgShifterPatternHigh & lBit) ? 1 : 0) << 1)   | ((mBgShifterPatternLow & lBit) ? 1 : 0);
+        lBgPalette = (((mBgShifterAttributeHigh & lBit) ? 1 : 0) << 1) | ((mBgShifterAttributeLow & lBit) ? 1 : 0);
+    }
+
+    uint8_t lSpritePixel     = 0;
+    uint8_t lSpriteAttribute = 0;
+    bool    lSpriteZero      = false;
+    if (lMask & SHOW_SPRITES)
+    {
+        for (uint8_t lIndex = 0; lIndex < mSpriteCount; ++lIndex)
+        {
+            if (mSpriteCounter[lIndex] != 0)
+            {
+                continue;
+            }
+            lSpritePixel = (((mSpriteShifterHigh[lIndex] >> 7) & 1) << 1) | ((mSpriteShifterLow[lIndex] >> 7) & 1);
+            if (lSpritePixel)
+            {
+                lSpriteAttribute = mSpriteRows[lIndex].mAttribute;
+                lSpriteZero      = (lIndex == 0) && mSpriteZeroOnLine;
+                break;
+            }
+        }
+    }
+
+    mFrameBuffer[mScanline][mDot - 1] = ComposePixel(mDot - 1, lBgPixel, lBgPalette, lSpritePixel, lSpriteAttribute, lSpriteZero);
+}
+
+//--------//
+// LoadBackgroundShifters
+//
+// Loads the latched tile into the low byte of the background shift registers.
+//--------//
+//
+void Ppu2C02::LoadBackgroundShifters(void)
+{
+    mBgShifterPatternLow    = (mBgShifterPatternLow & 0xFF00)    | mNextTileLow;
+    mBgShifterPatternHigh   = (mBgShifterPatternHigh & 0xFF00)   | mNextTileHigh;
+    mBgShifterAttributeLow  = (mBgShifterAttributeLow & 0xFF00)  | ((mNextTileAttribute & 0x01) ? 0xFF : 0x00);
+    mBgShifterAttributeHigh = (mBgShifterAttributeHigh & 0xFF00) | ((mNextTileAttribute & 0x02) ? 0xFF : 0x00);
+}
+
+//--------//
+// UpdateShifters
+//
+// Shifts the background registers by one pixel. Sprite registers count down their X
+// position first and only start shifting once they reach it.
+//--------//
+//
+void Ppu2C02::UpdateShifters(void)
+{
+    uint8_t lMask = mRegisters[PPUMASK].Read();
+
+    if (lMask & SHOW_BCKGND)
+    {
+        mBgShifterPatternLow    <<= 1;
+        mBgShifterPatternHigh   <<= 1;
+        mBgShifterAttributeLow  <<= 1;
+        mBgShifterAttributeHigh <<= 1;
+    }
+
+    if ((lMask & SHOW_SPRITES) && mDot <= 257)
+    {
+        for (uint8_t lIndex = 0; lIndex < mSpriteCount; ++lIndex)
+        {
+            if (mSpriteCounter[lIndex] > 0)
+            {
+                --mSpriteCounter[lIndex];
+            }
+            else
+            {
+                mSpriteShifterLow[lIndex]  <<= 1;
+                mSpriteShifterHigh[lIndex] <<= 1;
+            }
+        }
+    }
+}
+
+//--------//
+// UpdateA12RiseDot
+//
+// Predicts where A12 rises on the current line from the pattern tables in PPUCTRL,
+// instead of watching every fetch. With background and sprites in different tables it
+// rises once a line, going into whichever one is at $1000. 8x16 sprites can come from
+// either table, so they're taken to be in the other one from the background: at $1000
+// behind a $0000 background, as in nearly every game that counts scanlines, and at
+// $0000 behind a $1000 background, which puts the rise back at the background fetches.
+//--------//
+//
+void Ppu2C02::UpdateA12RiseDot(void)
+{
+    uint8_t lControl    = mRegisters[PPUCTRL].Read();
+    bool    lBackHigh   = (lControl & BACK_PATTBL) != 0;
+    bool    lSpriteHigh = (lControl & SPRITE_PATTBL) != 0;
+    bool    lTallSprite = (lControl & SPRITE_SIZE) != 0;
+
+    mA12RiseDot = -1;
+    if (!mWatchA12 || !IsRenderingEnabled() || (mScanline >= POST_RENDER_SCANLINE && mScanline != PRE_RENDER_SCANLINE))
+    {
+        return;
+    }
+
+    if (!lBackHigh && (lSpriteHigh || lTallSprite))
+    {
+        mA12RiseDot = A12_SPRITE_DOT;
+    }
+    else if (lBackHigh && (!lSpriteHigh || lTallSprite))
+    {
+        mA12RiseDot = A12_BACKGROUND_DOT;
+    }
 }
@@ -0,0 +1,70 @@
+/////////////////////////////////////////////////////////////////////
+//
+// RateControl.cpp
+//
+// Implementation file for the audio rate control.
+//
+/////////////////////////////////////////////////////////////////////
+
+#include <RateControl.hpp>
+
+//--------//
+//
+// RateControl
+//
+//--------//
+
+//--------//
+// RateControl
+//
+// Constructor.
+//--------//
+//
+RateControl::RateControl(void)
+  : mTarget(0),
+    mAverage(0.0),
+    mAdjust(1.0)
+{
+}
+
+//--------//
+// SetTarget
+//
+// Sets the fill to aim for and starts over as if the ring were right on it.
+//
+// param[in]    lTarget     Samples to keep in the ring.
+//--------//
+//
+void RateControl::SetTarget(size_t lTarget)
+{
+    mTarget  = lTarget;
+    mAverage = static_cast<double>(lTarget);
+    mAdjust  = 1.0;
+}
+
+//--------//
+// Update
+//
+// Takes the ring's fill after a frame's audio went in, and works out the nudge for the
+// next frame. It's proportional to how far off target the average is, reaching the most
+// it can be when the ring is empty or twice the target.
+//
+// param[in]    lFill   Samples in the ring.
+// returns  Factor on the output rate, 1.0 for none.
+//--------//
+//
+double RateControl::Update(size_t lFill)
+{
+    double lError;
+
+    if (mTarget == 0)
+    {
+        return mAdjust;
+    }
+
+    mAverage += (static_cast<double>(lFill) - mAverage) * cSmoothing;
+    lError    = (mTarget - mAverage) / mTarget;
+    lError    = (lError > 1.0) ? 1.0 : ((lError < -1.0) ? -1.0 : lError);
+    mAdjust   = 1.0 + lError * cMaxAdjust;
+    return mAdjust;
+}
@@ -0,0 +1,630 @@
+/////////////////////////////////////////////////////////////////////
+//
+// Resampler.cpp
+//
+// Implementation file for the audio resampler.
+//
+/////////////////////////////////////////////////////////////////////
+
+#include <Resampler.hpp>
+#include <Errors/ApiErrors.hpp>
+#include <math.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define RESAMPLER_X86
+#include <immintrin.h>
+#endif
+
+#ifdef TEST_APU
+#include <stdio.h>
+#include <chrono>
+#include <Logger/ApiLogger.hpp>
+#endif
+
+//--------//
+// Kaiser window shape and the length of each quality.
+//
+static const int    cQualityTaps[Resampler::NUM_QUALITIES]  = {16, 32, 64};
+static const double cQualityBetas[Resampler::NUM_QUALITIES] = {5.0, 7.0, 9.0};
+
+//--------//
+// BesselI0
+//
+// Zeroth order modified Bessel function of the first kind, by its power series.
+//
+// param[in]    lX  Argument.
+// returns  I0(lX).
+//--------//
+//
+static double BesselI0(double lX)
+{
+    double lSum  = 1.0;
+    double lTerm = 1.0;
+
+    for (int lIndex = 1; lIndex < 32; ++lIndex)
+    {
+        lTerm *= (lX / (2.0 * lIndex)) * (lX / (2.0 * lIndex));
+        lSum  += lTerm;
+    }
+    return lSum;
+}
+
+//--------//
+// DotScalar
+//
+// Sum of products, four running sums to give the compiler something to work with.
+//
+// param[in]    lSamples        Input samples.
+// param[in]    lCoefficients   Filter taps.
+// param[in]    lCount          Number of taps, a multiple of 16.
+// returns  The filtered sample.
+//--------//
+//
+static float DotScalar(const float * lSamples, const float * lCoefficients, int lCount)
+{
+    float lSums[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+
+    for (int lIndex = 0; lIndex < lCount; lIndex += 4)
+    {
+        lSums[0] += lSamples[lIndex + 0] * lCoefficients[lIndex + 0];
+        lSums[1] += lSamples[lIndex + 1] * lCoefficients[lIndex + 1];
+        lSums[2] += lSamples[lIndex + 2] * lCoefficients[lIndex + 2];
+        lSums[3] += lSamples[lIndex + 3] * lCoefficients[lIndex + 3];
+    }
+    return (lSums[0] + lSums[1]) + (lSums[2] + lSums[3]);
+}
+
+#ifdef RESAMPLER_X86
+
+//--------//
+// DotSse2
+//
+// 16 taps at a time version of DotScalar.
+//--------//
+//
+__attribute__((target("sse2")))
+static float DotSse2(const float * lSamples, const float * lCoefficients, int lCount)
+{
+    __m128 lSum0 = _mm_setzero_ps();
+    __m128 lSum1 = _mm_setzero_ps();
+    __m128 lSum2 = _mm_setzero_ps();
+    __m128 lSum3 = _mm_setzero_ps();
+
+    for (int lIndex = 0; lIndex < lCount; lIndex += 16)
+    {
+        lSum0 = _mm_add_ps(lSum0, _mm_mul_ps(_mm_loadu_ps(lSamples + lIndex + 0),  _mm_loadu_ps(lCoefficients + lIndex + 0)));
+        lSum1 = _mm_add_ps(lSum1, _mm_mul_ps(_mm_loadu_ps(lSamples + lIndex + 4),  _mm_loadu_ps(lCoefficients + lIndex + 4)));
+        lSum2 = _mm_add_ps(lSum2, _mm_mul_ps(_mm_loadu_ps(lSamples + lIndex + 8),  _mm_loadu_ps(lCoefficients + lIndex + 8)));
+        lSum3 = _mm_add_ps(lSum3, _mm_mul_ps(_mm_loadu_ps(lSamples + lIndex + 12), _mm_loadu_ps(lCoefficients + lIndex + 12)));
+    }
+
+    lSum0 = _mm_add_ps(_mm_add_ps(lSum0, lSum1), _mm_add_ps(lSum2, lSum3));
+    lSum0 = _mm_add_ps(lSum0, _mm_movehl_ps(lSum0, lSum0));
+    lSum0 = _mm_add_ss(lSum0, _mm_shuffle_ps(lSum0, lSum0, 1));
+    return _mm_cvtss_f32(lSum0);
+}
+
+//--------//
+// DotAvx2
+//
+// 16 taps at a time version of DotScalar, in two 8 wide sums.
+//--------//
+//
+__attribute__((target("avx2")))
+static float DotAvx2(const float * lSamples, const float * lCoefficients, int lCount)
+{
+    __m256 lSum0 = _mm256_setzero_ps();
+    __m256 lSum1 = _mm256_setzero_ps();
+    __m128 lSum;
+
+    for (int lIndex = 0; lIndex < lCount; lIndex += 16)
+    {
+        lSum0 = _mm256_add_ps(lSum0, _mm256_mul_ps(_mm256_loadu_ps(lSamples + lIndex + 0), _mm256_loadu_ps(lCoefficients + lIndex + 0)));
+        lSum1 = _mm256_add_ps(lSum1, _mm256_mul_ps(_mm256_loadu_ps(lSamples + lIndex + 8), _mm256_loadu_ps(lCoefficients + lIndex + 8)));
+    }
+
+    lSum0 = _mm256_add_ps(lSum0, lSum1);
+    lSum  = _mm_add_ps(_mm256_castps256_ps128(lSum0), _mm256_extractf128_ps(lSum0, 1));
+    lSum  = _mm_add_ps(lSum, _mm_movehl_ps(lSum, lSum));
+    lSum  = _mm_add_ss(lSum, _mm_shuffle_ps(lSum, lSum, 1));
+    return _mm_cvtss_f32(lSum);
+}
+
+#endif
+
+//--------//
+//
+// Resampler
+//
+//--------//
+
+//--------//
+// Resampler
+//
+// Constructor. Nothing comes out until the rates are set.
+//--------//
+//
+Resampler::Resampler(void)
+  : mCoefficients(nullptr),
+    mHistory(nullptr),
+    mHistoryCount(0),
+    mTaps(0),
+    mPosition(0),
+    mStep(0),
+    mRatio(0.0),
+    mAdjust(1.0),
+    mPassband(0.0),
+    mQuality(QUALITY_NORMAL),
+    mDot(GetDot(PixelKernels::GetBestLevel()))
+{
+}
+
+//--------//
+// ~Resampler
+//
+// Destructor.
+//--------//
+//
+Resampler::~Resampler(void)
+{
+    delete [] mCoefficients;
+    delete [] mHistory;
+}
+
+//--------//
+// GetTaps
+//
+// param[in]    lQuality    A quality setting.
+// returns  The length of the filter at that quality.
+//--------//
+//
+int Resampler::GetTaps(Quality lQuality)
+{
+    return cQualityTaps[lQuality];
+}
+
+//--------//
+// SetRates
+//
+// Designs the filter for a pair of rates and clears out any input held. The stopband
+// starts where a tone would alias back into the passband, the passband ends a transition
+// width below that, which the window sets for the quality.
+//
+// param[in]    lInputRate      Input samples per second.
+// param[in]    lOutputRate     Output samples per second.
+// param[in]    lQuality        Filter length.
+// returns  If the tables could be allocated.
+//--------//
+//
+bool Resampler::SetRates(double lInputRate, double lOutputRate, Quality lQuality)
+{
+    const double cPi = 3.14159265358979323846;
+    int          lTaps;
+    double       lBeta;
+    double       lAttenuation;
+    double       lTransition;
+    double       lStopband;
+    double       lCutoff;
+
+    delete [] mCoefficients;
+    delete [] mHistory;
+    mCoefficients = nullptr;
+    mHistory      = nullptr;
+    mTaps         = 0;
+    mStep         = 0;
+
+    if (lInputRate <= 0.0 || lOutputRate <= 0.0 || lQuality < 0 || lQuality >= NUM_QUALITIES)
+    {
+        return false;
+    }
+
+    lTaps         = cQualityTaps[lQuality];
+    lBeta         = cQualityBetas[lQuality];
+    mCoefficients = new(std::nothrow) float[(NUM_PHASES + 1) * lTaps];
+    mHistory      = new(std::nothrow) float[BATCH_SIZE + lTaps];
+    if (nullptr == mCoefficients || nullptr == mHistory)
+    {
+        delete [] mCoefficients;
+        delete [] mHistory;
+        mCoefficients = nullptr;
+        mHistory      = nullptr;
+        gErrorManager.Post(ErrorCodes::OUT_OF_MEMORY);
+        return false;
+    }
+
+    // Kaiser's estimates for the window, in input samples.
+    lAttenuation = lBeta / 0.1102 + 8.7;
+    lTransition  = (lAttenuation - 7.95) / (14.36 * lTaps) * lInputRate;
+    lStopband    = lOutputRate - fmin(PASSBAND_HZ, 0.45 * lOutputRate);
+    lStopband    = fmin(lStopband, lInputRate * 0.5);
+    mPassband    = fmax(lStopband - lTransition, 0.0);
+    lCutoff      = (lStopband - lTransition * 0.5) / lInputRate;
+
+    for (int lPhase = 0; lPhase <= NUM_PHASES; ++lPhase)
+    {
+        float * lRow = mCoefficients + lPhase * lTaps;
+        double  lSum = 0.0;
+
+        for (int lTap = 0; lTap < lTaps; ++lTap)
+        {
+            double lX      = lTap - (lTaps / 2 - 1) - static_cast<double>(lPhase) / NUM_PHASES;
+            double lRatio  = lX / (lTaps / 2);
+            double lWindow = (fabs(lRatio) < 1.0) ? BesselI0(lBeta * sqrt(1.0 - lRatio * lRatio)) / BesselI0(lBeta) : 0.0;
+            double lSinc   = (lX == 0.0) ? 1.0 : sin(2.0 * cPi * lCutoff * lX) / (2.0 * cPi * lCutoff * lX);
+
+            lRow[lTap] = static_cast<float>(lSinc * lWindow);
+            lSum      += lRow[lTap];
+        }
+
+        // Every phase passes DC exactly, so a held level doesn't ripple with the phase.
+        for (int lTap = 0; lTap < lTaps; ++lTap)
+        {
+            lRow[lTap] = static_cast<float>(lRow[lTap] / lSum);
+        }
+    }
+
+    mTaps    = lTaps;
+    mQuality = lQuality;
+    mRatio   = lInputRate / lOutputRate;
+    UpdateStep();
+    Clear();
+    return true;
+}
+
+//--------//
+// SetRatioAdjust
+//
+// Nudges the output rate, within cMaxRatioAdjust. Takes effect from the next output sample,
+// the filter isn't redesigned for it.
+//
+// param[in]    lAdjust     Factor on the output rate, 1.0 for none.
+//--------//
+//
+void Resampler::SetRatioAdjust(double lAdjust)
+{
+    mAdjust = fmin(fmax(lAdjust, 1.0 - cMaxRatioAdjust), 1.0 + cMaxRatioAdjust);
+    UpdateStep();
+}
+
+//--------//
+// UpdateStep
+//
+// Works out the fixed point input step from the ratio and its adjustment.
+//--------//
+//
+void Resampler::UpdateStep(void)
+{
+    mStep = static_cast<uint64_t>(mRatio / mAdjust * static_cast<double>(1ULL << TIME_BITS) + 0.5);
+}
+
+//--------//
+// Clear
+//
+// Drops any input held, the next output starts from silence.
+//--------//
+//
+void Resampler::Clear(void)
+{
+    if (mHistory)
+    {
+        memset(mHistory, 0, mTaps * sizeof(mHistory[0]));
+    }
+
+    // Start with the filter's history full of silence, so output starts right away.
+    mHistoryCount = mTaps;
+    mPosition     = 0;
+}
+
+//--------//
+// GetMaxOutput
+//
+// param[in]    lInputCount     Input samples about to be processed.
+// returns  Most output samples they could turn into.
+//--------//
+//
+int Resampler::GetMaxOutput(int lInputCount)
+{
+    if (mStep == 0)
+    {
+        return 0;
+    }
+    return static_cast<int>((static_cast<uint64_t>(lInputCount + mTaps) << TIME_BITS) / mStep) + 1;
+}
+
+//--------//
+// Process
+//
+// Takes a batch of input, a frame's worth at a time is what it's meant for, and writes out
+// every output sample it makes possible. Input that can't be used yet is kept for the next
+// call. If lOut fills up, the rest of the input is dropped.
+//
+// param[in]    lIn             Input samples.
+// param[in]    lInputCount     Number of input samples.
+// param[out]   lOut            Where the output goes.
+// param[in]    lOutputMax      Room in lOut, GetMaxOutput says how much is enough.
+// returns  Number of samples written to lOut.
+//--------//
+//
+int Resampler::Process(const int16_t * lIn, int lInputCount, int16_t * lOut, int lOutputMax)
+{
+    const int lPhaseShift = TIME_BITS - PHASE_BITS;
+    const int lPhaseRound = 1 << (lPhaseShift - 1);
+    int       lWritten    = 0;
+    int       lCount;
+    int       lUsed;
+    int       lIndex;
+    int       lPhase;
+    float     lSample;
+
+    if (nullptr == mCoefficients)
+    {
+        return 0;
+    }
+
+    while (lInputCount > 0)
+    {
+        lCount = (lInputCount < BATCH_SIZE + mTaps - mHistoryCount) ? lInputCount : BATCH_SIZE + mTaps - mHistoryCount;
+        for (int lSampleIndex = 0; lSampleIndex < lCount; ++lSampleIndex)
+        {
+            mHistory[mHistoryCount + lSampleIndex] = lIn[lSampleIndex];
+        }
+        mHistoryCount += lCount;
+        lIn           += lCount;
+        lInputCount   -= lCount;
+
+        for (;;)
+        {
+            lIndex = static_cast<int>(mPosition >> TIME_BITS);
+            if (lIndex + mTaps > mHistoryCount || lWritten == lOutputMax)
+            {
+                break;
+            }
+
+            // Rounding to the nearest phase can land on the next sample, which is the extra row.
+            lPhase  = static_cast<int>(((mPosition & ((1ULL << TIME_BITS) - 1)) + lPhaseRound) >> lPhaseShift);
+            lSample = mDot(mHistory + lIndex, mCoefficients + lPhase * mTaps, mTaps);
+            lSample = (lSample > INT16_MAX) ? INT16_MAX : ((lSample < INT16_MIN) ? INT16_MIN : lSample);
+
+            lOut[lWritten++] = static_cast<int16_t>(lrintf(lSample));
+            mPosition       += mStep;
+        }
+
+        if (lWritten == lOutputMax)
+        {
+            break;
+        }
+
+        // Keep what the next output still needs.
+        lUsed = static_cast<int>(mPosition >> TIME_BITS);
+        lUsed = (lUsed < mHistoryCount) ? lUsed : mHistoryCount;
+        memmove(mHistory, mHistory + lUsed, (mHistoryCount - lUsed) * sizeof(mHistory[0]));
+        mHistoryCount -= lUsed;
+        mPosition     -= static_cast<uint64_t>(lUsed) << TIME_BITS;
+    }
+
+    return lWritten;
+}
+
+//--------//
+// GetDot
+//
+// param[in]    lLevel  Instruction set level.
+// returns  The dot product for that level, or the best one below it that was built.
+//--------//
+//
+Resampler::DotFunction Resampler::GetDot(PixelKernels::Level lLevel)
+{
+    switch (lLevel)
+    {
+#ifdef RESAMPLER_X86
+        case PixelKernels::AVX2:
+            return DotAvx2;
+
+        case PixelKernels::SSE2:
+            return DotSse2;
+#endif
+        default:
+            return DotScalar;
+    }
+}
+
+#ifdef TEST_APU
+
+//--------//
+// MeasureGain
+//
+// Runs a full scale tone through a resampler and measures what comes out against what
+// went in, by RMS. Below the output's Nyquist rate that's the response at the tone, above
+// it it's how much aliases back down.
+//
+// param[in]    lResampler      Resampler, with its rates set.
+// param[in]    lInputRate      Input samples per second.
+// param[in]    lFrequency      Frequency of the tone in Hz.
+// returns  Gain in dB.
+//--------//
+//
+static double MeasureGain(Resampler & lResampler, double lInputRate, double lFrequency)
+{
+    enum
+    {
+        NUM_INPUT   = 16384,
+        SETTLE      = 256   // Output samples skipped while the filter fills up.
+    };
+
+    const double cPi        = 3.14159265358979323846;
+    const double cAmplitude = 16384.0;
+    int16_t      lIn[NUM_INPUT];
+    int16_t      lOut[NUM_INPUT * 2];
+    double       lSum = 0.0;
+    int          lCount;
+
+    for (int lIndex = 0; lIndex < NUM_INPUT; ++lIndex)
+    {
+        lIn[lIndex] = static_cast<int16_t>(lrint(cAmplitude * sin(2.0 * cPi * lFrequency * lIndex / lInputRate)));
+    }
+
+    lResampler.Clear();
+    lCount = lResampler.Process(lIn, NUM_INPUT, lOut, NUM_INPUT * 2);
+    for (int lIndex = SETTLE; lIndex < lCount; ++lIndex)
+    {
+        lSum += static_cast<double>(lOut[lIndex]) * lOut[lIndex];
+    }
+
+    // RMS of a sine is its amplitude over root 2.
+    return 20.0 * log10(sqrt(lSum / (lCount - SETTLE)) * sqrt(2.0) / cAmplitude + 1e-9);
+}
+
+//--------//
+// SelfTest
+//
+// Checks the frequency response of every quality against its design, for the output
+// rates that matter: flat through the passband, and nothing from above the stopband
+// edge aliasing back in by more than the window promises. Then checks every supported
+// dot product gives the same output as the scalar one, and times them in output samples
+// per second.
+//
+// returns  If all the checks passed.
+//--------//
+//
+bool Resampler::SelfTest(void)
+{
+    enum
+    {
+        INPUT_RATE      = 64000,
+        NUM_BENCH_INPUT = 64000,
+        NUM_BENCH_LOOPS = 20
+    };
+
+    static const double cOutputRates[] = {48000.0, 44100.0};
+    static const double cStopbands[NUM_QUALITIES] = {-45.0, -65.0, -80.0};
+
+    Resampler lResampler;
+    Resampler lReference;
+    int16_t * lIn      = new(std::nothrow) int16_t[NUM_BENCH_INPUT];
+    int16_t * lOut     = new(std::nothrow) int16_t[NUM_BENCH_INPUT * 2];
+    int16_t * lCompare = new(std::nothrow) int16_t[NUM_BENCH_INPUT * 2];
+    uint32_t  lSeed    = 0x2A03;
+    bool      lPassed  = true;
+    char      lBuffer[160];
+
+    if (nullptr == lIn || nullptr == lOut || nullptr == lCompare)
+    {
+        delete [] lIn;
+        delete [] lOut;
+        delete [] lCompare;
+        return false;
+    }
+
+    for (int lQuality = 0; lQuality < NUM_QUALITIES; ++lQuality)
+    {
+        for (double lOutputRate : cOutputRates)
+        {
+            double lWorstPass = 0.0;
+            double lWorstStop = -200.0;
+            double lStopEdge;
+            bool   lMatch;
+
+            lResampler.SetRates(INPUT_RATE, lOutputRate, static_cast<Quality>(lQuality));
+            lStopEdge = fmin(lOutputRate - fmin(PASSBAND_HZ, 0.45 * lOutputRate), INPUT_RATE * 0.5);
+
+            for (double lFrequency = 100.0; lFrequency <= lResampler.GetPassband(); lFrequency += 997.0)
+            {
+                lWorstPass = fmax(lWorstPass, fabs(MeasureGain(lResampler, INPUT_RATE, lFrequency)));
+            }
+            for (double lFrequency = lStopEdge + 250.0; lFrequency < INPUT_RATE * 0.5; lFrequency += 499.0)
+            {
+                lWorstStop = fmax(lWorstStop, MeasureGain(lResampler, INPUT_RATE, lFrequency));
+            }
+
+            lMatch = lWorstPass < 0.1 && lWorstStop < cStopbands[lQuality];
+            snprintf(lBuffer, sizeof(lBuffer), "[%s] resampler %d taps to %.0f Hz: within %.3f dB to %.1f kHz, %.1f dB past %.1f kHz\n",
+                     lMatch ? "+" : "---", GetTaps(static_cast<Quality>(lQuality)), lOutputRate,
+                     lWorstPass, lResampler.GetPassband() / 1000.0, lWorstStop, lStopEdge / 1000.0);
+            ApiLogger::Log(lBuffer);
+            lPassed = lPassed && lMatch;
+        }
+    }
+
+    // White noise, it hits every tap with something different.
+    for (int lIndex = 0; lIndex < NUM_BENCH_INPUT; ++lIndex)
+    {
+        lSeed        = (lSeed * 1103515245) + 12345;
+        lIn[lIndex]  = static_cast<int16_t>(lSeed >> 16);
+    }
+
+    for (int lLevel = PixelKernels::SCALAR + 1; lLevel <= PixelKernels::GetBestLevel(); ++lLevel)
+    {
+        bool lMatch = true;
+
+        for (int lQuality = 0; lQuality < NUM_QUALITIES; ++lQuality)
+        {
+            int lCount;
+            int lReferenceCount;
+
+            lReference.SetRates(INPUT_RATE, 48000.0, static_cast<Quality>(lQuality));
+            lReference.mDot = GetDot(PixelKernels::SCALAR);
+            lResampler.SetRates(INPUT_RATE, 48000.0, static_cast<Quality>(lQuality));
+            lResampler.mDot = GetDot(static_cast<PixelKernels::Level>(lLevel));
+
+            // Odd batch sizes and a nudged ratio, so the history and phases get moved around.
+            lReference.SetRatioAdjust(1.003);
+            lResampler.SetRatioAdjust(1.003);
+            lReferenceCount = 0;
+            lCount          = 0;
+            for (int lStart = 0; lStart < NUM_BENCH_INPUT; lStart += 1067)
+            {
+                int lBatch = (NUM_BENCH_INPUT - lStart < 1067) ? NUM_BENCH_INPUT - lStart : 1067;
+
+                lReferenceCount += lReference.Process(lIn + lStart, lBatch, lCompare + lReferenceCount, NUM_BENCH_INPUT * 2 - lReferenceCount);
+                lCount          += lResampler.Process(lIn + lStart, lBatch, lOut + lCount, NUM_BENCH_INPUT * 2 - lCount);
+            }
+
+            // Sums are added in a different order, the last bit can round either way.
+            lMatch = lMatch && (lCount == lReferenceCount);
+            for (int lIndex = 0; lIndex < lCount && lMatch; ++lIndex)
+            {
+                lMatch = abs(lOut[lIndex] - lCompare[lIndex]) <= 1;
+            }
+        }
+
+        snprintf(lBuffer, sizeof(lBuffer), "[%s] %s resampler matches scalar\n", lMatch ? "+" : "---",
+                 PixelKernels::GetLevelName(static_cast<PixelKernels::Level>(lLevel)));
+        ApiLogger::Log(lBuffer);
+        lPassed = lPassed && lMatch;
+    }
+
+    // Benchmark, a second of input at a time, the way a long run of frames would feed it.
+    for (int lLevel = PixelKernels::SCALAR; lLevel <= PixelKernels::GetBestLevel(); ++lLevel)
+    {
+        double lRates[NUM_QUALITIES];
+
+        for (int lQuality = 0; lQuality < NUM_QUALITIES; ++lQuality)
+        {
+            long lTotal = 0;
+
+            lResampler.SetRates(INPUT_RATE, 48000.0, static_cast<Quality>(lQuality));
+            lResampler.mDot = GetDot(static_cast<PixelKernels::Level>(lLevel));
+
+            auto lStart = std::chrono::steady_clock::now();
+            for (int lLoop = 0; lLoop < NUM_BENCH_LOOPS; ++lLoop)
+            {
+                lTotal += lResampler.Process(lIn, NUM_BENCH_INPUT, lOut, NUM_BENCH_INPUT * 2);
+            }
+            auto lEnd = std::chrono::steady_clock::now();
+
+            lRates[lQuality] = lTotal / std::chrono::duration<double>(lEnd - lStart).count() / 1000000.0;
+        }
+
+        snprintf(lBuffer, sizeof(lBuffer), "[i] %-6s resampler %7.2f / %7.2f / %7.2f M samples/s at 16 / 32 / 64 taps\n",
+                 PixelKernels::GetLevelName(static_cast<PixelKernels::Level>(lLevel)), lRates[0], lRates[1], lRates[2]);
+        ApiLogger::Log(lBuffer);
+    }
+
+    delete [] lIn;
+    delete [] lOut;
+    delete [] lCompare;
+    return lPassed;
+}
+
+#endif
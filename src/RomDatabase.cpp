@@ -0,0 +1,56 @@
+/////////////////////////////////////////////////////////////////////
+//
+// RomDatabase.cpp
+//
+// Implementation file for the ROM database.
+//
+/////////////////////////////////////////////////////////////////////
+
+#include <RomDatabase.hpp>
+#include <Ppu2C02.hpp>
+#include <algorithm>
+
+// Known images, sorted by CRC. Only images whose header is commonly wrong, or that need
+// more than the fast scanline renderer, need to be listed. The header fixes are from the
+// corrections the common emulators carry for dumps that went around with bad headers.
+static const RomInfo cRoms[] =
+{
+    // CRC          Mapper  Mirroring                       PRG RAM  Flags
+    {0x3337EC46,    0,      Ppu2C02::MIRROR_VERTICAL,       0,       0},    // Super Mario Bros.
+    {0x55773880,    2,      Ppu2C02::MIRROR_VERTICAL,       0,       0},    // Gilligan's Island
+    {0x6D65CAC6,    2,      Ppu2C02::MIRROR_HORIZONTAL,     0,       0},    // Terra Cresta
+    {0x6E0EB43E,    2,      Ppu2C02::MIRROR_VERTICAL,       0,       0},    // Puss 'n Boots
+    {0x9BDE3267,    3,      Ppu2C02::MIRROR_VERTICAL,       0,       0},    // Adventures of Dino Riki
+    {0x9EA1DC76,    2,      Ppu2C02::MIRROR_HORIZONTAL,     0,       0},    // Rainbow Islands
+    {0xD858033D,    3,      Ppu2C02::MIRROR_HORIZONTAL,     0,       0},    // Armored Scrum Object
+    {0xDBF90772,    3,      Ppu2C02::MIRROR_HORIZONTAL,     0,       0},    // Alpha Mission
+    {0xE1B260DA,    2,      Ppu2C02::MIRROR_VERTICAL,       0,       0},    // Argos no Senshi
+};
+
+//--------//
+//
+// RomDatabase
+//
+//--------//
+
+//--------//
+// Find
+//
+// Looks up an image.
+//
+// param[in]    lCrc    CRC-32 of the image's PRG ROM then CHR ROM.
+// returns  What's known about the image, or nullptr if it isn't in the database.
+//--------//
+//
+const RomInfo * RomDatabase::Find(uint32_t lCrc)
+{
+    const RomInfo * lEnd   = cRoms + sizeof(cRoms) / sizeof(cRoms[0]);
+    const RomInfo * lEntry = std::lower_bound(cRoms, lEnd, lCrc,
+                                              [](const RomInfo & lInfo, uint32_t lKey) {return lInfo.mCrc < lKey;});
+
+    if (lEntry == lEnd || lEntry->mCrc != lCrc)
+    {
+        return nullptr;
+    }
+    return lEntry;
+}
@@ -9,6 +9,14 @@
 #include <System.hpp>
 #include <File/ApiFile.hpp>
 #include <Errors/ApiErrors.hpp>
+#include <PixelKernels.hpp>
+#include <string.h>
+
+#ifdef TEST_APU
+#include <Audio/AudioSink.hpp>
+#include <Audio/WavAudioSink.hpp>
+#include <chrono>
+#endif
 
 //--------//
 // ValidHexCharacter
@@ -56,10 +64,11 @@ bool ValidHexCharacter(char lChar, uint8_t * lByte)
 //--------//
 //
 System::System(void)
-  : mRam(RAM_SIZE), mCartridge(nullptr)
+  : mRam(RAM_SIZE), mCartridge(nullptr), mClockCounter(0), mCpuCycles(0), mReusedFrames(0)
 {
     mCpu.Connect(this);
     mPpu.Connect(this);
+    mApu.Connect(this);
 }
 
 //--------//
@@ -88,6 +97,13 @@ void System::InsertCartridge(Cartridge * lCartridge)
     }
     mCartridge = lCartridge;
     mCartridge->Connect(this);
+
+    // The cartridge also sits on the ppu bus, and decides how accurately it needs to be drawn.
+    mPpu.ConnectCartridge(mCartridge);
+    mPpu.SetRenderMode(mCartridge->UseDotRenderer() ? Ppu2C02::DOT_RENDERER : Ppu2C02::SCANLINE_RENDERER);
+
+    // Any sound chip on it plays through the apu.
+    mApu.SetExpansion(mCartridge->GetExpansionAudio());
 }
 
 //--------//
@@ -102,40 +118,123 @@ void System::RemoveCartridge(void)
     {
         mCartridge->Disconnect();
         mCartridge = nullptr;
+        mPpu.ConnectCartridge(nullptr);
+        mApu.SetExpansion(nullptr);
     }
 }
 
 //--------//
-// Clock
+// Reset
 //
-// Starts running a program already loaded into memory.
+// Resets the cpu, ppu and apu, as if the reset button was pressed on power up.
+// The cpu cycle count keeps going, it's only a time base.
+//--------//
 //
-// NOTE: This structure is just in for testing purposes.
+void System::Reset(void)
+{
+    mPpu.Reset();
+    mCpu.Reset();
+    mApu.Reset();
+    mClockCounter = 0;
+}
+
+//--------//
+// Clock
+//
+// Advances the system by one ppu dot. The cpu is stepped on every third dot.
 //
+// returns  True if the ppu finished a frame on this dot.
 //--------//
 //
 bool System::Clock(void)
 {
-    uint8_t lCycles;
-    uint8_t lInstructions = 0;
+    mPpu.Clock();
 
-    while (true)
+    if (++mClockCounter == CPU_CLOCK_DIVIDER)
     {
         mCpu.StepClock();
-        lCycles = mCpu.GetCyclesLeft();
-        if (lCycles == 0)
-        {
-            ++lInstructions;
-        }
-        if (lInstructions > 7)
+        mClockCounter = 0;
+
+        // The apu only runs when something needs it to, or when it has an IRQ to raise.
+        if (++mCpuCycles >= mApu.GetNextEvent())
         {
-            mCpu.Reset();
-            lInstructions = 0;
-            DumpMemoryAsRaw("../MemDump.hex");
-            break;
+            mApu.Sync();
         }
     }
-    return true;
+
+    // Hand any NMI over to the cpu, it gets serviced at the next instruction boundary.
+    if (mPpu.PollNmi())
+    {
+        mCpu.RequestNmi();
+    }
+
+    if (mPpu.IsFrameComplete())
+    {
+        mPpu.ClearFrameComplete();
+        return true;
+    }
+    return false;
+}
+
+//--------//
+// RunFrame
+//
+// Runs the system until the ppu has finished drawing a frame, then passes it through
+// the output stage and publishes it to the presentation side. A frame the same as the
+// last one is left out, the presentation side keeps showing the one it has. The apu's
+// samples for the frame are made available either way.
+//
+// param[in] lRender   False to only run the ppu's timing, for frames that won't be shown.
+//                     Nothing is published for them.
+//--------//
+//
+void System::RunFrame(bool lRender)
+{
+    mPpu.SetTimingOnly(!lRender);
+    while (!Clock())
+    {
+    }
+    mApu.EndFrame();
+    if (mCartridge)
+    {
+        mCartridge->EndFrame();
+    }
+
+    if (lRender && mPpu.IsFrameReused())
+    {
+        ++mReusedFrames;
+        return;
+    }
+
+    if (lRender && mOutputFrames.GetSize())
+    {
+        mConverter.Convert(mPpu.GetFrameBuffer(), mPpu.GetLineMasks(), Ppu2C02::SCREEN_WIDTH, Ppu2C02::SCREEN_HEIGHT,
+                           mOutputFrames.GetBackBuffer());
+        mOutputFrames.Publish();
+    }
+}
+
+//--------//
+// SetOutputFormat
+//
+// Sets the pixel format finished frames get converted to. Headless runs that only
+// need the indexed frame or its hash can leave this at FORMAT_NONE and skip the work.
+// Must be called before the presentation side starts acquiring frames.
+//
+// param[in]    lFormat     Output pixel format.
+// param[in]    lThreads    Number of threads converting row bands in parallel.
+//--------//
+//
+void System::SetOutputFormat(FrameConverter::PixelFormat lFormat, int lThreads)
+{
+    mConverter.SetFormat(lFormat);
+    mConverter.SetThreads(lThreads);
+
+    // Resize posts its own error, fall back to no output if it fails.
+    if (!mOutputFrames.Resize(Ppu2C02::SCREEN_WIDTH * Ppu2C02::SCREEN_HEIGHT * mConverter.GetBytesPerPixel()))
+    {
+        mConverter.SetFormat(FrameConverter::FORMAT_NONE);
+    }
 }
 
 //--------//
@@ -163,7 +262,12 @@ DataType System::Read(AddressType lAddress)
     }
     else if (lAddress >= System::PPU_REGISTER_START && lAddress <= PPU_REGISTER_RANGE)
     {
-        // Add when ppu is added.
+        // 8 registers mirrored across 8KB.
+        mLastRead = mPpu.CpuRead(lAddress & (PPU_REGISTER_SIZE - 1));
+    }
+    else if (lAddress == System::APU_STATUS)
+    {
+        mLastRead = mApu.Read(lAddress - APU_IO_REGISTER_START);
     }
 
     return mLastRead;
@@ -194,10 +298,52 @@ void System::Write(AddressType lAddress, DataType lData)
     }
     else if (lAddress >= System::PPU_REGISTER_START && lAddress <= PPU_REGISTER_RANGE)
     {
-        // Add when ppu is added.
+        // 8 registers mirrored across 8KB.
+        mPpu.CpuWrite(lAddress & (PPU_REGISTER_SIZE - 1), lData);
+    }
+    else if (lAddress == System::OAM_DMA)
+    {
+        OamDma(lData);
+    }
+    else if ((lAddress >= System::APU_IO_REGISTER_START && lAddress <= System::APU_STATUS) || lAddress == System::CONTROLLER_2)
+    {
+        mApu.Write(lAddress - APU_IO_REGISTER_START, lData);
     }
 }
 
+//--------//
+// OamDma
+//
+// Copies a page of cpu memory into OAM. The hardware does it as 256 reads and writes
+// while the cpu is held off, here it's one block copy up front and the cpu is stalled
+// for the same number of cycles. Nearly every game does this once a frame.
+//
+// param[in] lPage   High byte of the address to copy from.
+//--------//
+//
+void System::OamDma(DataType lPage)
+{
+    AddressType lAddress = static_cast<AddressType>(lPage) << 8;
+    uint8_t     lBuffer[Ppu2C02::OAM_SIZE];
+
+    // RAM is copied straight out of its buffer. Anything else could have side effects
+    // on read, so it goes through the bus a byte at a time.
+    if (lAddress <= System::RAM_RANGE)
+    {
+        mPpu.OamDma(mRam.GetBuffer() + (lAddress & (RAM_SIZE - 1)));
+    }
+    else
+    {
+        for (AddressType lOffset = 0; lOffset < Ppu2C02::OAM_SIZE; ++lOffset)
+        {
+            lBuffer[lOffset] = Read(lAddress + lOffset);
+        }
+        mPpu.OamDma(lBuffer);
+    }
+
+    mCpu.Stall(OAM_DMA_CYCLES);
+}
+
 //--------//
 // LoadMemory
 //
@@ -352,8 +498,8 @@ bool System::CpuTest(void)
     InsertCartridge(&lCartridge);
 
     // Setup system needed for test rom to work properly.
-    lCartridge.Write(0xFFFC, 0x00);
-    lCartridge.Write(0xFFFD, 0xC0);
+    lCartridge.PatchPrg(0xFFFC, 0x00);
+    lCartridge.PatchPrg(0xFFFD, 0xC0);
     mCpu.PushStack(0x00);
     mCpu.PushStack(0x08);
     ++mCpu.mRegisters.mSp;
@@ -387,6 +533,503 @@ bool System::CpuTest(void)
 #endif
 }
 
+//--------//
+// PpuTest
+//
+// Tests the ppu renderers by running ./test/nestest.nes from the project source
+// directory with each renderer and comparing hashes of every frame. The rom doesn't
+// use any mid-scanline effects, so both renderers have to agree. Then it runs again with
+// a split scroll written partway down each frame, see RunSplitFrame. Before that, the
+// pixel kernels are checked against their scalar versions and timed, and after it the
+// frame converter is checked split across threads. Passes only if every check does.
+//--------//
+//
+bool System::PpuTest(void)
+{
+#ifdef TEST_PPU
+    CAPTURE_LOG("[i] Starting ppu tests...\n");
+
+    // The SIMD pixel kernels have to be bit exact with the scalar ones.
+    bool lPassed = PixelKernels::SelfTest();
+
+    // Grab the test file.
+    char lFilename[ApiFileSystem::MAX_FILENAME * 2];
+
+    const char * lExecDirectory = ApiFileSystem::GetExecDirectory();
+    if (nullptr == lExecDirectory)
+    {
+        gErrorManager.Post(ErrorCodes::FILE_GENERAL_ERROR);
+        return false;
+    }
+    snprintf(lFilename, sizeof(lFilename), "%s%s", lExecDirectory, "../tests/nestest.nes");
+
+    // Load the cartridge.
+    Cartridge lCartridge(lFilename);
+    if (!lCartridge.IsValidImage())
+    {
+        ApiLogger::Log("[!] Invalid ROM loaded into cartridge\n");
+        return false;
+    }
+    InsertCartridge(&lCartridge);
+
+    // Run the same frames through every renderer, folding every frame into one hash. The
+    // pipelined renderer is a frame behind, so it runs one more frame and its hashes start one
+    // later. The deferred renderers run again with the frame drawn in bands on several threads.
+    // The last pass only runs the timing, what the cpu sees has to match the rendered passes.
+    const Ppu2C02::RenderMode lModes[]   = {Ppu2C02::SCANLINE_RENDERER, Ppu2C02::DOT_RENDERER, Ppu2C02::DEFERRED_RENDERER,
+                                            Ppu2C02::PIPELINED_RENDERER, Ppu2C02::DEFERRED_RENDERER,
+                                            Ppu2C02::PIPELINED_RENDERER, Ppu2C02::SCANLINE_RENDERER};
+    const int                 lThreads[] = {1, 1, 1, 1, PPU_TEST_THREADS, PPU_TEST_THREADS, 1};
+    const bool                lRender[]  = {true, true, true, true, true, true, false};
+    const int                 lLatency[] = {0, 0, 0, 1, 0, 1, 0};
+    const int                 lNumModes  = sizeof(lModes) / sizeof(lModes[0]);
+    uint64_t lHashes[lNumModes]    = {};
+    uint64_t lRamHashes[lNumModes] = {};
+    bool     lHashesMatch          = true;
+    bool     lRamHashesMatch       = true;
+
+    for (int lMode = 0; lMode < lNumModes; ++lMode)
+    {
+        // Power cycle, so both renderers start from the same memory.
+        mPpu.SetRenderMode(lModes[lMode]);
+        mPpu.SetRenderThreads(lThreads[lMode]);
+        mRam.Resize(RAM_SIZE);
+        Reset();
+        for (int lFrame = 0; lFrame < PPU_TEST_FRAMES + lLatency[lMode]; ++lFrame)
+        {
+            RunFrame(lRender[lMode]);
+
+            // While booting, the rom loads the palette with rendering off partway through a
+            // frame. Only the dot renderer can show that, so skip those frames.
+            if (lFrame >= PPU_TEST_WARMUP_FRAMES + lLatency[lMode])
+            {
+                lHashes[lMode] = (lHashes[lMode] * 31) ^ mPpu.GetFrameHash();
+            }
+            for (AddressType lAddress = 0; lAddress < RAM_SIZE && lFrame < PPU_TEST_FRAMES; ++lAddress)
+            {
+                lRamHashes[lMode] = (lRamHashes[lMode] * 31) ^ mRam.Read(lAddress);
+            }
+        }
+    }
+
+    for (int lMode = 1; lMode < lNumModes; ++lMode)
+    {
+        lHashesMatch    = lHashesMatch && (!lRender[lMode] || lHashes[lMode] == lHashes[0]);
+        lRamHashesMatch = lRamHashesMatch && lRamHashes[lMode] == lRamHashes[0];
+    }
+
+    if (lHashesMatch)
+    {
+        ApiLogger::Log("\n[+] Ppu renderers agree!\n");
+    }
+    else
+    {
+        ApiLogger::Log("\n[---] Ppu renderers produced different frames!\n");
+        lPassed = false;
+    }
+
+    if (lRamHashesMatch)
+    {
+        ApiLogger::Log("[+] Timing only frames kept the cpu in step!\n");
+    }
+    else
+    {
+        ApiLogger::Log("[---] Timing only frames changed what the cpu saw!\n");
+        lPassed = false;
+    }
+
+    // The output stage has to come out the same however many threads convert the frame.
+    FrameConverter lSingle;
+    FrameConverter lThreaded;
+    size_t         lPixels   = Ppu2C02::SCREEN_WIDTH * Ppu2C02::SCREEN_HEIGHT;
+    uint32_t *     lExpected = new(std::nothrow) uint32_t[lPixels];
+    uint32_t *     lActual   = new(std::nothrow) uint32_t[lPixels];
+
+    lSingle.SetFormat(FrameConverter::FORMAT_RGBA8888);
+    lThreaded.SetFormat(FrameConverter::FORMAT_RGBA8888);
+    lThreaded.SetThreads(PPU_TEST_THREADS);
+    if (lExpected && lActual)
+    {
+        lSingle.Convert(mPpu.GetFrameBuffer(), mPpu.GetLineMasks(), Ppu2C02::SCREEN_WIDTH, Ppu2C02::SCREEN_HEIGHT, lExpected);
+        lThreaded.Convert(mPpu.GetFrameBuffer(), mPpu.GetLineMasks(), Ppu2C02::SCREEN_WIDTH, Ppu2C02::SCREEN_HEIGHT, lActual);
+    }
+    if (lExpected && lActual && memcmp(lExpected, lActual, lPixels * sizeof(uint32_t)) == 0)
+    {
+        ApiLogger::Log("[+] Threaded frame conversion matches!\n");
+    }
+    else
+    {
+        ApiLogger::Log("[---] Threaded frame conversion differs!\n");
+        lPassed = false;
+    }
+    delete [] lExpected;
+    delete [] lActual;
+
+    // Again, with a split scroll written partway down every frame. The rom never writes the
+    // scroll mid-frame itself, this is what the deferred renderers replay from the register
+    // log, so they have to draw the same splits the scanline renderer draws live.
+    const Ppu2C02::RenderMode lSplitModes[]   = {Ppu2C02::SCANLINE_RENDERER, Ppu2C02::DOT_RENDERER,
+                                                 Ppu2C02::DEFERRED_RENDERER, Ppu2C02::PIPELINED_RENDERER,
+                                                 Ppu2C02::DEFERRED_RENDERER, Ppu2C02::PIPELINED_RENDERER};
+    const int                 lSplitThreads[] = {1, 1, 1, 1, PPU_TEST_THREADS, PPU_TEST_THREADS};
+    const int                 lSplitLatency[] = {0, 0, 0, 1, 0, 1};
+    const int                 lNumSplitModes  = sizeof(lSplitModes) / sizeof(lSplitModes[0]);
+    uint64_t lSplitHashes[lNumSplitModes] = {};
+    bool     lSplitsMatch                 = true;
+    bool     lLogged                      = true;
+
+    for (int lMode = 0; lMode < lNumSplitModes; ++lMode)
+    {
+        mPpu.SetRenderMode(lSplitModes[lMode]);
+        mPpu.SetRenderThreads(lSplitThreads[lMode]);
+        mRam.Resize(RAM_SIZE);
+        Reset();
+        for (int lFrame = 0; lFrame < PPU_TEST_FRAMES + lSplitLatency[lMode]; ++lFrame)
+        {
+            RunSplitFrame();
+            if (lSplitModes[lMode] == Ppu2C02::DEFERRED_RENDERER && lFrame >= PPU_TEST_WARMUP_FRAMES)
+            {
+                lLogged &= mPpu.GetLoggedWriteCount() >= PPU_TEST_SPLIT_WRITES;
+            }
+            if (lFrame >= PPU_TEST_WARMUP_FRAMES + lSplitLatency[lMode])
+            {
+                lSplitHashes[lMode] = (lSplitHashes[lMode] * 31) ^ mPpu.GetFrameHash();
+            }
+        }
+    }
+
+    for (int lMode = 1; lMode < lNumSplitModes; ++lMode)
+    {
+        lSplitsMatch = lSplitsMatch && lSplitHashes[lMode] == lSplitHashes[0];
+    }
+    mPpu.SetRenderThreads(1);
+
+    if (lLogged && lSplitHashes[0] != lHashes[0] && lSplitsMatch)
+    {
+        ApiLogger::Log("[+] Ppu renderers agree on mid-frame splits!\n");
+    }
+    else
+    {
+        ApiLogger::Log("[---] Ppu renderers drew mid-frame splits differently!\n");
+        lPassed = false;
+    }
+    ApiLogger::Log(lPassed ? "[+] Ppu tests passed!\n" : "[---] Ppu tests failed!\n");
+
+    // Final cleanup.
+    RemoveCartridge();
+
+    return false;
+#else
+    return true;
+#endif
+}
+
+#ifdef TEST_PPU
+//--------//
+// RunSplitFrame
+//
+// Runs a frame like RunFrame does for the ppu test, writing a split into the ppu partway
+// down it the way a game's raster code would: a new horizontal scroll through PPUSCROLL,
+// then a jump to another row of the other name table through PPUADDR. The writes land in
+// the horizontal blank, where every renderer has to honour them.
+//--------//
+//
+void System::RunSplitFrame(void)
+{
+    do
+    {
+        if (mPpu.GetDot() == PPU_TEST_SPLIT_DOT)
+        {
+            if (mPpu.GetScanline() == PPU_TEST_SCROLL_LINE)
+            {
+                Write(PPU_REGISTER_START + 5, 0x25);    // PPUSCROLL, x.
+                Write(PPU_REGISTER_START + 5, 0x00);    // PPUSCROLL, y, only takes effect next frame.
+            }
+            else if (mPpu.GetScanline() == PPU_TEST_ADDRESS_LINE)
+            {
+                Write(PPU_REGISTER_START + 6, 0x24);    // PPUADDR, name table 1.
+                Write(PPU_REGISTER_START + 6, 0x40);    // PPUADDR, row 2.
+            }
+        }
+    }
+    while (!Clock());
+    mApu.EndFrame();
+}
+#endif
+
+//--------//
+// ApuTest
+//
+// Tests the audio resampler: its frequency response against the filter design for each
+// quality, and every SIMD dot product against the scalar one, timing them as it goes.
+// Then drives the apu through the registers with ./test/mmc3_irq.nes running, which
+// never touches the apu itself. In 4 step mode the frame IRQ has to come up as the
+// sequence ends and go away when the status is read. A pulse loaded with a length of
+// 10 has to fall silent on the 10th half frame, with the frame IRQ inhibited.
+//
+// Last, the audio path without any sound hardware. A few frames go through a ring into
+// the wav file sink, and the sizes in the file's header have to add up to the samples
+// that went in. Then a small ring is written past full and drained past empty by the
+// null sink, which has to show up in its overrun and underrun counts.
+//--------//
+//
+bool System::ApuTest(void)
+{
+#ifdef TEST_APU
+    CAPTURE_LOG("[i] Starting apu tests...\n");
+
+    char     lFilename[ApiFileSystem::MAX_FILENAME * 2];
+    char     lBuffer[160];
+    bool     lPassed    = Resampler::SelfTest();
+    bool     lInhibited = true;
+    bool     lMatch;
+    uint64_t lStart;
+    uint64_t lCycles;
+    DataType lStatus;
+    int16_t  lSamples[APU_TEST_CHUNK];
+    int      lCount;
+    uint32_t lWritten = 0;
+    uint8_t  lHeader[WavAudioSink::HEADER_SIZE] = {};
+    uint32_t lRiffSize;
+    uint32_t lDataSize;
+    uint64_t lOverruns;
+    uint64_t lUnderruns;
+    File *   lFile;
+
+    const char * lExecDirectory = ApiFileSystem::GetExecDirectory();
+    if (nullptr == lExecDirectory)
+    {
+        gErrorManager.Post(ErrorCodes::FILE_GENERAL_ERROR);
+        return false;
+    }
+    snprintf(lFilename, sizeof(lFilename), "%s%s", lExecDirectory, "../tests/mmc3_irq.nes");
+
+    Cartridge lCartridge(lFilename);
+    if (!lCartridge.IsValidImage())
+    {
+        ApiLogger::Log("[!] Invalid ROM loaded into cartridge\n");
+        return false;
+    }
+    InsertCartridge(&lCartridge);
+    Reset();
+
+    // The frame IRQ, from a restarted 4 step sequence.
+    Read(APU_STATUS);
+    Write(APU_IO_REGISTER_START + Apu2A03::FRAME_COUNTER, 0x00);
+    lStart = mCpuCycles;
+    while (mCpuCycles - lStart < APU_TEST_TIMEOUT && !(mCpu.mIrqLine & Cpu6502::IRQ_APU))
+    {
+        Clock();
+    }
+    lCycles = mCpuCycles - lStart;
+    lStatus = Read(APU_STATUS);
+    lMatch  = (lCycles == APU_TEST_FRAME_IRQ || lCycles == APU_TEST_FRAME_IRQ + 1) && (lStatus & Apu2A03::FRAME_IRQ) &&
+              !(mCpu.mIrqLine & Cpu6502::IRQ_APU);
+    snprintf(lBuffer, sizeof(lBuffer), "[%s] frame IRQ %llu cycles after $4017, cleared by $4015: %s\n", lMatch ? "+" : "---",
+             static_cast<unsigned long long>(lCycles), (mCpu.mIrqLine & Cpu6502::IRQ_APU) ? "no" : "yes");
+    ApiLogger::Log(lBuffer);
+    lPassed = lPassed && lMatch;
+
+    // The length counter. Index 0 of the length table is 10 half frames.
+    Write(APU_IO_REGISTER_START + Apu2A03::FRAME_COUNTER, Apu2A03::IRQ_INHIBIT);
+    lStart = mCpuCycles;
+    Write(APU_STATUS, Apu2A03::PULSE_1_ON);
+    Write(APU_IO_REGISTER_START + Apu2A03::PULSE_1_CONTROL, 0x1F);      // Constant volume 15, length not halted.
+    Write(APU_IO_REGISTER_START + Apu2A03::PULSE_1_TIMER_LOW, 0xFD);    // 440 Hz.
+    Write(APU_IO_REGISTER_START + Apu2A03::PULSE_1_TIMER_HIGH, 0x00);   // Length index 0.
+    while (mCpuCycles - lStart < APU_TEST_TIMEOUT && (Read(APU_STATUS) & Apu2A03::PULSE_1_ON))
+    {
+        Clock();
+        lInhibited = lInhibited && !(mCpu.mIrqLine & Cpu6502::IRQ_APU);
+    }
+    lCycles = mCpuCycles - lStart;
+    lMatch  = (lCycles == APU_TEST_LENGTH_SILENT || lCycles == APU_TEST_LENGTH_SILENT + 1) && lInhibited;
+    snprintf(lBuffer, sizeof(lBuffer), "[%s] pulse length of 10 ran out %llu cycles after $4017, IRQ inhibited: %s\n",
+             lMatch ? "+" : "---", static_cast<unsigned long long>(lCycles), lInhibited ? "yes" : "no");
+    ApiLogger::Log(lBuffer);
+    lPassed = lPassed && lMatch;
+
+    // A long note through the ring into a wav file. Deleting the sink stops it, and stopping
+    // writes out the rest and fills in the header.
+    AudioRing   lRing;
+    AudioSink * lSink;
+
+    mApu.SetSampleRate(Apu2A03::DEFAULT_SAMPLE_RATE);
+    lRing.Resize(Apu2A03::DEFAULT_SAMPLE_RATE);
+    snprintf(lFilename, sizeof(lFilename), "%s%s", lExecDirectory, "apu_test.wav");
+    lSink = AudioSink::Open(AudioSink::WAV_FILE_SINK, &lRing, Apu2A03::DEFAULT_SAMPLE_RATE, lFilename);
+    lMatch = nullptr != lSink && lSink->GetStatus() == ErrorCodes::SUCCESS;
+    if (lMatch)
+    {
+        lSink->Start();
+        Write(APU_STATUS, Apu2A03::PULSE_1_ON);
+        Write(APU_IO_REGISTER_START + Apu2A03::PULSE_1_TIMER_HIGH, 0x08);   // Length index 1, 254 half frames.
+        for (int lFrame = 0; lFrame < APU_TEST_WAV_FRAMES; ++lFrame)
+        {
+            RunFrame(false);
+            while ((lCount = mApu.ReadSamples(lSamples, APU_TEST_CHUNK)) > 0)
+            {
+                lWritten += static_cast<uint32_t>(lRing.Write(lSamples, lCount));
+            }
+        }
+        lMatch = lSink->GetStatus() == ErrorCodes::SUCCESS;
+    }
+    delete lSink;
+
+    lMatch = lMatch && lWritten && ApiFileSystem::Open(lFilename, "rb", &lFile) == ErrorCodes::SUCCESS;
+    if (lMatch)
+    {
+        lMatch = ApiFileSystem::Read(lHeader, sizeof(lHeader), lFile) == sizeof(lHeader) && memcmp(lHeader, "RIFF", 4) == 0;
+        ApiFileSystem::Close(lFile);
+    }
+    lRiffSize = lHeader[4]  | (lHeader[5] << 8)  | (lHeader[6] << 16)  | (static_cast<uint32_t>(lHeader[7]) << 24);
+    lDataSize = lHeader[40] | (lHeader[41] << 8) | (lHeader[42] << 16) | (static_cast<uint32_t>(lHeader[43]) << 24);
+    lMatch    = lMatch && lDataSize == lWritten * sizeof(int16_t) && lRiffSize == lDataSize + WavAudioSink::HEADER_SIZE - 8;
+    snprintf(lBuffer, sizeof(lBuffer), "[%s] wav sink recorded %u samples, header says %u\n", lMatch ? "+" : "---",
+             lWritten, lDataSize / static_cast<uint32_t>(sizeof(int16_t)));
+    ApiLogger::Log(lBuffer);
+    lPassed = lPassed && lMatch;
+    remove(lFilename);
+
+    // Write a chunk into a smaller ring, then let the null sink drain it until it comes up short.
+    lRing.Resize(APU_TEST_RING_SIZE);
+    lOverruns  = lRing.GetOverrunCount();
+    lUnderruns = lRing.GetUnderrunCount();
+    lRing.Write(lSamples, APU_TEST_CHUNK);
+    lMatch = lRing.GetOverrunCount() > lOverruns && lRing.GetFill() == lRing.GetCapacity();
+
+    lSink = AudioSink::Open(AudioSink::NULL_SINK, &lRing, Apu2A03::DEFAULT_SAMPLE_RATE);
+    if (nullptr != lSink && lSink->GetStatus() == ErrorCodes::SUCCESS)
+    {
+        lSink->Start();
+        for (int lWait = 0; lWait < APU_TEST_WAIT_PERIODS && lRing.GetUnderrunCount() == lUnderruns; ++lWait)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(AudioSink::PERIOD_MS));
+        }
+    }
+    delete lSink;
+    lMatch = lMatch && lRing.GetUnderrunCount() > lUnderruns && lRing.GetFill() == 0;
+    snprintf(lBuffer, sizeof(lBuffer), "[%s] ring counted %llu overruns and %llu underruns\n", lMatch ? "+" : "---",
+             static_cast<unsigned long long>(lRing.GetOverrunCount() - lOverruns),
+             static_cast<unsigned long long>(lRing.GetUnderrunCount() - lUnderruns));
+    ApiLogger::Log(lBuffer);
+    lPassed = lPassed && lMatch;
+
+    ApiLogger::Log(lPassed ? "[+] Apu tests passed!\n" : "[---] Apu tests failed!\n");
+
+    // Final cleanup.
+    RemoveCartridge();
+
+    return false;
+#else
+    return true;
+#endif
+}
+
+//--------//
+// MapperTest
+//
+// Tests the MMC3 scanline counter by running ./test/mmc3_irq.nes from the project source
+// directory. The rom only enables interrupts and loops, and its IRQ handler acknowledges
+// the IRQ, enables it again and counts it at $00. Each case sets up the counter and the
+// pattern tables, then checks the line and dot of the first few IRQs. A latch of N fires
+// on line N-1, as the pre-render line loads it, and every N+1 lines after that as the
+// counter reloads. The later IRQs are only seen if acknowledging released the line.
+//--------//
+//
+bool System::MapperTest(void)
+{
+#ifdef TEST_MAPPER
+    CAPTURE_LOG("[i] Starting mapper tests...\n");
+
+    struct IrqCase
+    {
+        const char * mName;
+        uint8_t      mControl;
+        uint8_t      mMask;
+        uint8_t      mLatch;
+        int16_t      mLines[3];         // Lines the first IRQs fire on, -1 for none.
+        int16_t      mDot;
+    };
+
+    const IrqCase lCases[] =
+    {
+        {"sprites at $1000",                   0x08, 0x18, 20, {19, 40, 61},  Ppu2C02::A12_SPRITE_DOT},
+        {"background at $1000",                0x10, 0x18, 20, {19, 40, 61},  Ppu2C02::A12_BACKGROUND_DOT},
+        {"8x16 sprites",                       0x20, 0x18, 5,  {4, 10, 16},   Ppu2C02::A12_SPRITE_DOT},
+        {"8x16 sprites, background at $1000",  0x30, 0x18, 5,  {4, 10, 16},   Ppu2C02::A12_BACKGROUND_DOT},
+        {"both at $1000",                      0x18, 0x18, 5,  {-1, -1, -1},  -1},
+        {"rendering off",                      0x08, 0x00, 5,  {-1, -1, -1},  -1}
+    };
+
+    char lFilename[ApiFileSystem::MAX_FILENAME * 2];
+    char lBuffer[160];
+    bool lPassed = true;
+
+    const char * lExecDirectory = ApiFileSystem::GetExecDirectory();
+    if (nullptr == lExecDirectory)
+    {
+        gErrorManager.Post(ErrorCodes::FILE_GENERAL_ERROR);
+        return false;
+    }
+    snprintf(lFilename, sizeof(lFilename), "%s%s", lExecDirectory, "../tests/mmc3_irq.nes");
+
+    Cartridge lCartridge(lFilename);
+    if (!lCartridge.IsValidImage())
+    {
+        ApiLogger::Log("[!] Invalid ROM loaded into cartridge\n");
+        return false;
+    }
+    InsertCartridge(&lCartridge);
+
+    for (const IrqCase & lCase : lCases)
+    {
+        int16_t lLines[3] = {-1, -1, -1};
+        int     lCount    = 0;
+        bool    lDotsOk   = true;
+        bool    lAsserted = false;
+
+        mRam.Resize(RAM_SIZE);
+        Reset();
+        Write(0xC000, lCase.mLatch);    // IRQ latch.
+        Write(0xC001, 0);               // IRQ reload.
+        Write(0xE001, 0);               // IRQ enable.
+        Write(PPU_REGISTER_START, lCase.mControl);
+        Write(PPU_REGISTER_START + 1, lCase.mMask);
+
+        // Two frames is plenty for three IRQs.
+        for (int lClock = 0; lClock < Ppu2C02::SCANLINES_PER_FRAME * 341 * 2 && lCount < 3; ++lClock)
+        {
+            Clock();
+            if ((mCpu.mIrqLine & Cpu6502::IRQ_CARTRIDGE) && !lAsserted)
+            {
+                // The ppu has already moved on to the next dot.
+                lLines[lCount++] = mPpu.GetScanline();
+                lDotsOk         &= (mPpu.GetDot() - 1 == lCase.mDot);
+            }
+            lAsserted = mCpu.mIrqLine & Cpu6502::IRQ_CARTRIDGE;
+        }
+
+        // The handler acknowledged every IRQ but the one it may be in the middle of.
+        bool lOk = lDotsOk && Read(0x0000) + 1 >= lCount && lLines[0] == lCase.mLines[0] &&
+                   lLines[1] == lCase.mLines[1] && lLines[2] == lCase.mLines[2];
+        snprintf(lBuffer, sizeof(lBuffer), "%s MMC3 IRQ, %s: lines %d %d %d\n", lOk ? "[+]" : "[---]", lCase.mName,
+                 lLines[0], lLines[1], lLines[2]);
+        ApiLogger::Log(lBuffer);
+        lPassed &= lOk;
+    }
+
+    ApiLogger::Log(lPassed ? "[+] Mapper tests passed!\n" : "[---] Mapper tests failed!\n");
+
+    // Final cleanup.
+    RemoveCartridge();
+
+    return false;
+#else
+    return true;
+#endif
+}
+
 //--------//
 //
 // TestNesFunctor
@@ -0,0 +1,140 @@
+/////////////////////////////////////////////////////////////////////
+//
+// TripleBuffer.cpp
+//
+// Implementation file for the triple buffered frame hand off.
+//
+/////////////////////////////////////////////////////////////////////
+
+#include <TripleBuffer.hpp>
+#include <Errors/ApiErrors.hpp>
+#include <string.h>
+
+//--------//
+//
+// TripleBuffer
+//
+//--------//
+
+//--------//
+// TripleBuffer
+//
+// Constructor.
+//--------//
+//
+TripleBuffer::TripleBuffer(void)
+  : mBuffers{nullptr, nullptr, nullptr},
+    mSize(0),
+    mBack(0),
+    mFront(2),
+    mMiddle(1),
+    mPublished(0),
+    mDropped(0),
+    mRepeated(0)
+{
+}
+
+//--------//
+// ~TripleBuffer
+//
+// Destructor.
+//--------//
+//
+TripleBuffer::~TripleBuffer(void)
+{
+    Resize(0);
+}
+
+//--------//
+// Resize
+//
+// Allocates all three buffers, cleared to 0. Neither side may be using the buffers
+// while this runs.
+//
+// param[in]    lSize   Size of one buffer in bytes.
+// returns  If the buffers could be allocated.
+//--------//
+//
+bool TripleBuffer::Resize(size_t lSize)
+{
+    for (int lIndex = 0; lIndex < NUM_BUFFERS; ++lIndex)
+    {
+        if (mBuffers[lIndex])
+        {
+            delete [] mBuffers[lIndex];
+            mBuffers[lIndex] = nullptr;
+        }
+    }
+    mSize  = 0;
+    mBack  = 0;
+    mFront = 2;
+    mMiddle.store(1);
+
+    if (lSize == 0)
+    {
+        return true;
+    }
+
+    for (int lIndex = 0; lIndex < NUM_BUFFERS; ++lIndex)
+    {
+        mBuffers[lIndex] = new(std::nothrow) uint8_t[lSize];
+        if (nullptr == mBuffers[lIndex])
+        {
+            Resize(0);
+            gErrorManager.Post(ErrorCodes::OUT_OF_MEMORY);
+            return false;
+        }
+        memset(mBuffers[lIndex], 0, lSize);
+    }
+    mSize = lSize;
+    return true;
+}
+
+//--------//
+// Publish
+//
+// Hands the back buffer over as the newest frame and takes the middle one to draw into next.
+//--------//
+//
+void TripleBuffer::Publish(void)
+{
+    uint8_t lOld = mMiddle.exchange(mBack | FRESH, std::memory_order_acq_rel);
+
+    // The consumer never picked up the frame we just replaced.
+    if (lOld & FRESH)
+    {
+        mDropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    mBack = lOld & INDEX_MASK;
+    mPublished.fetch_add(1, std::memory_order_relaxed);
+}
+
+//--------//
+// Acquire
+//
+// Gets the newest published frame. If nothing new was published since the last call,
+// the same frame is returned again.
+//
+// param[out]   lNewFrame   Optional, set to whether the frame is new.
+// returns  The frame, valid until the next call to Acquire.
+//--------//
+//
+const void * TripleBuffer::Acquire(bool * lNewFrame)
+{
+    bool lFresh = (mMiddle.load(std::memory_order_relaxed) & FRESH) != 0;
+
+    if (lFresh)
+    {
+        mFront = mMiddle.exchange(mFront, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+    else
+    {
+        mRepeated.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (lNewFrame)
+    {
+        *lNewFrame = lFresh;
+    }
+    return mBuffers[mFront];
+}
@@ -58,6 +58,7 @@ class Window
 
         virtual bool    ShouldClose(void) = 0;
         virtual void    OnUpdate(void)    = 0;
+        virtual void    DrawFrame(const void * lPixels, int lWidth, int lHeight) = 0;
 
         int             GetStatus(void) {return mStatus;}
 
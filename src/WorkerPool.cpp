@@ -0,0 +1,190 @@
+/////////////////////////////////////////////////////////////////////
+//
+// WorkerPool.cpp
+//
+// Implementation file for the worker pool.
+//
+/////////////////////////////////////////////////////////////////////
+
+#include <WorkerPool.hpp>
+
+//--------//
+//
+// WorkerPool
+//
+//--------//
+
+//--------//
+// WorkerPool
+//
+// Constructor. Starts out with no extra threads, so Run does everything itself.
+//--------//
+//
+WorkerPool::WorkerPool(void)
+  : mNumWorkers(0),
+    mJobs(nullptr),
+    mNumJobs(0),
+    mNextJob(0),
+    mBusy(0),
+    mBatch(0),
+    mStopping(false)
+{
+}
+
+//--------//
+// ~WorkerPool
+//
+// Destructor.
+//--------//
+//
+WorkerPool::~WorkerPool(void)
+{
+    SetThreads(1);
+}
+
+//--------//
+// SetThreads
+//
+// Stops the current threads and starts a new set. Must not be called while Run is going.
+//
+// param[in]    lThreads    Total threads working on a batch, including the one calling Run.
+//                          Clamped to 1-MAX_THREADS.
+//--------//
+//
+void WorkerPool::SetThreads(int lThreads)
+{
+    if (lThreads < 1)
+    {
+        lThreads = 1;
+    }
+    if (lThreads > MAX_THREADS)
+    {
+        lThreads = MAX_THREADS;
+    }
+
+    Wait();
+    {
+        std::lock_guard<std::mutex> lLock(mMutex);
+        mStopping = true;
+    }
+    mWake.notify_all();
+    for (int lWorker = 0; lWorker < mNumWorkers; ++lWorker)
+    {
+        mWorkers[lWorker].join();
+    }
+
+    mStopping   = false;
+    mNumWorkers = lThreads - 1;
+    for (int lWorker = 0; lWorker < mNumWorkers; ++lWorker)
+    {
+        mWorkers[lWorker] = std::thread(&WorkerPool::WorkerLoop, this, mBatch);
+    }
+}
+
+//--------//
+// Run
+//
+// Runs a batch of jobs across every thread and waits for all of them to finish. Jobs
+// are handed out one at a time, in order, to whichever thread is free.
+//
+// param[in]    lJobs       The jobs.
+// param[in]    lNumJobs    Number of jobs.
+//--------//
+//
+void WorkerPool::Run(Functor * const * lJobs, int lNumJobs)
+{
+    Start(lJobs, lNumJobs);
+    RunJobs();
+    Wait();
+}
+
+//--------//
+// Start
+//
+// Hands a batch of jobs to the worker threads and returns right away. Waits for the last
+// batch first if it's still going. With no worker threads nothing would ever run them,
+// so they're run here instead.
+//
+// param[in]    lJobs       The jobs, must stay around until the batch is done.
+// param[in]    lNumJobs    Number of jobs.
+//--------//
+//
+void WorkerPool::Start(Functor * const * lJobs, int lNumJobs)
+{
+    Wait();
+    {
+        std::lock_guard<std::mutex> lLock(mMutex);
+        mJobs    = lJobs;
+        mNumJobs = lNumJobs;
+        mNextJob.store(0);
+        mBusy    = mNumWorkers;
+        ++mBatch;
+    }
+    mWake.notify_all();
+
+    if (mNumWorkers == 0)
+    {
+        RunJobs();
+    }
+}
+
+//--------//
+// Wait
+//
+// Waits for the worker threads to finish the current batch, if there is one.
+//--------//
+//
+void WorkerPool::Wait(void)
+{
+    std::unique_lock<std::mutex> lLock(mMutex);
+    mDone.wait(lLock, [this] {return mBusy == 0;});
+}
+
+//--------//
+// WorkerLoop
+//
+// What each worker thread runs, sleeping between batches until told to stop.
+//
+// param[in]    lSeen   Last batch when the thread was started. Handed over rather than read
+//                      by the thread, in case a batch shows up before the thread gets going.
+//--------//
+//
+void WorkerPool::WorkerLoop(uint64_t lSeen)
+{
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lLock(mMutex);
+            mWake.wait(lLock, [this, lSeen] {return mStopping || mBatch != lSeen;});
+            if (mStopping)
+            {
+                return;
+            }
+            lSeen = mBatch;
+        }
+
+        RunJobs();
+
+        std::lock_guard<std::mutex> lLock(mMutex);
+        if (--mBusy == 0)
+        {
+            mDone.notify_one();
+        }
+    }
+}
+
+//--------//
+// RunJobs
+//
+// Takes jobs from the current batch until there are none left.
+//--------//
+//
+void WorkerPool::RunJobs(void)
+{
+    int lJob;
+
+    while ((lJob = mNextJob.fetch_add(1)) < mNumJobs)
+    {
+        mJobs[lJob]->Execute();
+    }
+}